@@ -0,0 +1,60 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+
+#include "Types.h"
+
+namespace malcolm
+{
+	/// @brief Set of fields of 9x9 board stored as 128-bit mask. Field (x,y) is represented by bit 9 * y + x.
+	struct bitboard_t
+	{
+		/// fields 0...63
+		std::uint64_t low{ 0u };
+		/// fields 64...80
+		std::uint64_t high{ 0u };
+
+		/// @returns bit index of field at given position
+		static constexpr std::size_t indexOf(const pos_t& pos) { return 9u * pos.second + pos.first; }
+
+		/// @returns position of field with given bit index
+		static constexpr pos_t positionOf(std::size_t index) { return { static_cast<size_t>(index % 9u), static_cast<size_t>(index / 9u) }; }
+
+		constexpr void set(std::size_t index) { if (index < 64u) low |= 1ull << index; else high |= 1ull << (index - 64u); }
+		constexpr void reset(std::size_t index) { if (index < 64u) low &= ~(1ull << index); else high &= ~(1ull << (index - 64u)); }
+		constexpr bool test(std::size_t index) const { return index < 64u ? (low >> index) & 1u : (high >> (index - 64u)) & 1u; }
+		constexpr bool any() const { return (low | high) != 0u; }
+		constexpr int count() const { return std::popcount(low) + std::popcount(high); }
+
+		constexpr bitboard_t operator&(const bitboard_t& other) const { return { low & other.low, high & other.high }; }
+		constexpr bitboard_t operator|(const bitboard_t& other) const { return { low | other.low, high | other.high }; }
+		constexpr bitboard_t operator~() const { return { ~low, ~high & 0x1FFFFull }; }
+		constexpr bool operator==(const bitboard_t& other) const = default;
+
+		/// @returns index of the lowest set bit, board has to be non-empty
+		constexpr std::size_t first() const { return low != 0u ? std::countr_zero(low) : 64u + std::countr_zero(high); }
+
+		/// @brief removes the lowest set bit
+		constexpr void popFirst() { if (low != 0u) low &= low - 1u; else high &= high - 1u; }
+
+		/// @returns 9-bit mask of columns of given row which are in the set
+		constexpr std::uint32_t rowBits(std::size_t row) const
+		{
+			std::size_t start{ 9u * row };
+			if (start + 9u <= 64u)
+				return static_cast<std::uint32_t>(low >> start) & 0x1FFu;
+			if (start >= 64u)
+				return static_cast<std::uint32_t>(high >> (start - 64u)) & 0x1FFu;
+			return static_cast<std::uint32_t>((low >> start) | (high << (64u - start))) & 0x1FFu;
+		}
+
+		/// @returns 9-bit mask of rows of given column which are in the set
+		constexpr std::uint32_t columnBits(std::size_t column) const
+		{
+			std::uint32_t result{ 0u };
+			for (std::size_t row{ 0u }; row < 9u; row++)
+				result |= static_cast<std::uint32_t>(test(9u * row + column)) << row;
+			return result;
+		}
+	};
+}
@@ -1,10 +1,79 @@
 #pragma once
+#include <iterator>
 #include <map>
 #include <set>
 #include "Types.h"
 
 namespace malcolm
 {
+	/// Non-owning view of single row or column of `Board_t`. Columns are stored contiguously, rows are read with stride
+	/// of one column, but in both cases no values are copied.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class BoardLineView_t
+	{
+	protected:
+		/// Alias for type of data stored in matrix
+		using value_t = T;
+
+	private:
+		/// Board the view refers to
+		const board_t<value_t>* m_board;
+
+		/// Number of row or column
+		std::size_t m_index;
+
+		/// true for row, false for column
+		bool m_is_row;
+
+	public:
+		/// Forward iterator over values of the line
+		class iterator_t
+		{
+			const BoardLineView_t* m_view;
+			std::size_t m_position;
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = value_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_t*;
+			using reference = const value_t&;
+
+			iterator_t(const BoardLineView_t* view = nullptr, std::size_t position = 0u) : m_view{ view }, m_position{ position } {}
+			inline reference operator*() const { return (*m_view)[m_position]; }
+			inline iterator_t& operator++() { m_position++; return *this; }
+			inline iterator_t operator++(int) { auto copy{ *this }; m_position++; return copy; }
+			inline bool operator==(const iterator_t& other) const { return m_position == other.m_position; }
+			inline bool operator!=(const iterator_t& other) const { return m_position != other.m_position; }
+		};
+
+		/// @param board 2D table of values, has to outlive the view
+		/// @param index number of row or column
+		/// @param is_row true to view row, false to view column
+		BoardLineView_t(const board_t<value_t>& board, std::size_t index, bool is_row)
+			: m_board{ &board }, m_index{ index }, m_is_row{ is_row }
+		{
+		}
+
+		/// @returns number of values in the line
+		inline std::size_t size() const { return m_is_row ? m_board->size() : (*m_board)[m_index].size(); }
+
+		/// @returns i-th value of the line (x-th column for rows, y-th row for columns)
+		inline const value_t& operator[](std::size_t i) const { return m_is_row ? (*m_board)[i][m_index] : (*m_board)[m_index][i]; }
+
+		/// @returns true if line contains given value
+		inline bool contains(const value_t& value) const
+		{
+			for (std::size_t i{ 0u }; i < size(); i++)
+				if ((*this)[i] == value)
+					return true;
+			return false;
+		}
+
+		inline iterator_t begin() const { return iterator_t(this, 0u); }
+		inline iterator_t end() const { return iterator_t(this, size()); }
+	};
+
 	/// Represents 2D matrix of object of type T.
 	/// @tparam T type of data to be stored in matrix
 	template<typename T>
@@ -15,7 +84,7 @@ namespace malcolm
 		using value_t = T;
 
 		/// Alias for set of values stored in matrix
-		using value_container_t = value_container_t<value_t>;
+		using value_container_t = malcolm::value_container_t<value_t>;
 
 	private:
 		/// Object of type std::vector<std::vector<value_t>> containing 2D table of value_t-elements
@@ -72,7 +141,7 @@ namespace malcolm
 		/// Searches through whole board to find object for which predicate is satisfied
 		/// @param		predicate		function object used to filter interesting value_t objects from the board
 		/// @returns							position of first value_t met for which predicate is true, {-1,-1} if there is no such values in board
-		pos_t find(std::function<bool(value_t)> predicate) const
+		pos_t find(std::function<bool(const value_t&)> predicate) const
 		{
 			for (auto i{ 0u }; i < m_board.size(); i++)
 				for (auto j{ 0u }; j < m_board[i].size(); j++)
@@ -84,7 +153,7 @@ namespace malcolm
 		/// Searches through whole board to find all objects for which predicate is satisfied
 		/// @param		predicate		function object used to filter interesting value_t objects from the board
 		/// @returns					set of pos_t of fields for which predicate is true, {-1,-1} if there is no such values in board
-		std::set<pos_t> findAll(std::function<bool(value_t)> predicate) const
+		std::set<pos_t> findAll(std::function<bool(const value_t&)> predicate) const
 		{
 			std::set<pos_t> result;
 			for (auto i{ 0u }; i < m_board.size(); i++)
@@ -97,7 +166,7 @@ namespace malcolm
 		/// Searches through whole board to count all objects satysfying predicate
 		/// @param		predicate		function object used to filter interesting value_t objects from the board
 		/// @returns							number of elements in board for which predicate returns true
-		size_t count(std::function<bool(value_t)> predicate) const
+		size_t count(std::function<bool(const value_t&)> predicate) const
 		{
 			size_t result{ 0u };
 			for (const auto& x : m_board)
@@ -107,10 +176,10 @@ namespace malcolm
 		}
 
 		/// An overloaded version of find method, used to check if specific element is in board
-		inline pos_t find(const value_t& value) const { return find([&](value_t x) -> bool { return x == value; }); }
+		inline pos_t find(const value_t& value) const { return find([&](const value_t& x) -> bool { return x == value; }); }
 
 		/// An overloaded version of count method, used to count all occurencies of specific element
-		inline size_t count(const value_t& value) const { return count([&](value_t x) -> bool { return x == value; }); }
+		inline size_t count(const value_t& value) const { return count([&](const value_t& x) -> bool { return x == value; }); }
 
 		/// Initializes object with values given by std::vector<std::vector<value_t>> object
 		/// @param		board		initial state of board
@@ -119,6 +188,13 @@ namespace malcolm
 		{
 		}
 
+		/// Initializes object by taking over std::vector<std::vector<value_t>> object
+		/// @param		board		initial state of board
+		Board_t(board_t<value_t>&& board)
+			: m_board{ std::move(board) }
+		{
+		}
+
 		/// Initializes Board_t object to be board of size x times y with default value static_cast<value_t>(0u)
 		/// @param	x		width of board
 		/// @param	y		height of board
@@ -146,6 +222,14 @@ namespace malcolm
 			return result;
 		}
 
+		/// @param	row_number	number of row to view
+		/// @returns			view of the row, valid as long as board isn't resized
+		inline BoardLineView_t<value_t> getRow(size_t row_number) const { return BoardLineView_t<value_t>(m_board, row_number, true); }
+
+		/// @param	column_number	number of column to view
+		/// @returns				view of the column, valid as long as board isn't resized
+		inline BoardLineView_t<value_t> getColumn(size_t column_number) const { return BoardLineView_t<value_t>(m_board, column_number, false); }
+
 		/// @tparam	container_t		type of container to store values from specified column
 		/// @param	column_number	number of column to retrieve
 		/// @param	inserter		function object which takes container_t& and const value_t& and inserts the value into the container
@@ -200,13 +284,18 @@ namespace malcolm
 			return result;
 		}
 
-		/// @returns transposed Board_t object
+		/// @returns transposed Board_t object, i.e. result[{y, x}] == (*this)[{x, y}]
 		inline Board_t<value_t> transposed() const
 		{
-			Board_t<T> result;
-			for (auto i{ 0u }; i < m_board.size(); i++)
-				result.appendColumn(m_board[i]);
-			return result;
+			const std::size_t x_size{ m_board.size() }, y_size{ x_size == 0u ? 0u : m_board[0].size() };
+			board_t<value_t> result(y_size, column_t<value_t>(x_size));
+			for (std::size_t x{ 0u }; x < x_size; x++)
+			{
+				const auto& column{ m_board[x] };
+				for (std::size_t y{ 0u }; y < y_size; y++)
+					result[y][x] = column[y];
+			}
+			return Board_t<value_t>(std::move(result));
 		}
 
 		/// @tparam		container_t		type of container used to store values from the board
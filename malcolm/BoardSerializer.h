@@ -0,0 +1,492 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "Types.h"
+#include "Board.h"
+#include "Checksum.h"
+
+namespace malcolm
+{
+	/// @brief Encodings supported by `BoardWriter_t` and `BoardReader_t`
+	enum class board_encoding_t : std::uint8_t
+	{
+		/// 4 bits per field, row by row, empty field stored as 0. Suitable for puzzles and solutions with at most 15 values.
+		NIBBLE_PACKED = 1,
+		/// Full grids only: every field is stored as index of its value among values still allowed by row, column and subboard,
+		/// all indices are combined into single mixed-radix number (16 bytes for 9x9 board)
+		PERMUTATION_RANKED = 2
+	};
+
+	/// @brief Stateless encoder and decoder of single boards. Fields are always visited row by row, i.e. in the same order
+	/// as `operator<<(std::ostream&, const Board_t<T>&)` prints them.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class BoardCodec_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// @brief 128-bit unsigned integer used as accumulator of mixed-radix rank, kept portable (no compiler extensions)
+		struct rank_t
+		{
+			std::uint64_t low{ 0u };
+			std::uint64_t high{ 0u };
+
+			/// @brief *this = *this * multiplier + addend, both arguments are small (below 2^32)
+			inline void multiplyAdd(std::uint32_t multiplier, std::uint32_t addend)
+			{
+				std::uint64_t low_low{ (low & 0xFFFFFFFFu) * multiplier + addend };
+				std::uint64_t low_high{ (low >> 32) * multiplier + (low_low >> 32) };
+				low = (low_low & 0xFFFFFFFFu) | (low_high << 32);
+				high = high * multiplier + (low_high >> 32);
+			}
+
+			/// @brief *this = *this / divisor
+			/// @returns remainder of the division
+			inline std::uint32_t divide(std::uint32_t divisor)
+			{
+				std::uint64_t remainder{ 0u };
+				std::uint32_t limbs[4]{ static_cast<std::uint32_t>(high >> 32), static_cast<std::uint32_t>(high), static_cast<std::uint32_t>(low >> 32), static_cast<std::uint32_t>(low) };
+				for (auto& limb : limbs)
+				{
+					std::uint64_t current{ (remainder << 32) | limb };
+					limb = static_cast<std::uint32_t>(current / divisor);
+					remainder = current % divisor;
+				}
+				high = (static_cast<std::uint64_t>(limbs[0]) << 32) | limbs[1];
+				low = (static_cast<std::uint64_t>(limbs[2]) << 32) | limbs[3];
+				return static_cast<std::uint32_t>(remainder);
+			}
+		};
+
+		/// @returns side of subboard for board of given dimension, 0 if dimension isn't a square number
+		static constexpr std::size_t subboardSide(std::size_t dimension)
+		{
+			for (std::size_t side{ 1u }; side * side <= dimension; side++)
+				if (side * side == dimension)
+					return side;
+			return 0u;
+		}
+
+		/// @returns bitmask of values (bit v-1 for value v) which can't be placed at (x,y) because of already decoded fields
+		static std::uint32_t usedValuesMask(const std::vector<std::uint8_t>& cells, std::size_t dimension, std::size_t x, std::size_t y)
+		{
+			const std::size_t side{ subboardSide(dimension) };
+			std::uint32_t used{ 0u };
+			for (std::size_t i{ 0u }; i < x; i++)
+				used |= 1u << (cells[y * dimension + i] - 1u);
+			for (std::size_t j{ 0u }; j < y; j++)
+				used |= 1u << (cells[j * dimension + x] - 1u);
+			const std::size_t x0{ x - x % side }, y0{ y - y % side };
+			for (std::size_t j{ y0 }; j < y; j++)
+				for (std::size_t i{ x0 }; i < x0 + side; i++)
+					used |= 1u << (cells[j * dimension + i] - 1u);
+			return used;
+		}
+
+	public:
+		/// @returns number of bytes needed to store single board of given dimension with specified encoding
+		static constexpr std::size_t recordSize(board_encoding_t encoding, std::size_t dimension)
+		{
+			return encoding == board_encoding_t::NIBBLE_PACKED ? (dimension * dimension + 1u) / 2u : 16u;
+		}
+
+		/// @returns true if boards of given dimension can be stored with specified encoding, false for unknown encoding
+		static constexpr bool supports(board_encoding_t encoding, std::size_t dimension)
+		{
+			if (encoding == board_encoding_t::NIBBLE_PACKED)
+				return dimension > 0u && dimension <= 15u;
+			if (encoding == board_encoding_t::PERMUTATION_RANKED)
+				return dimension > 0u && dimension <= 9u && subboardSide(dimension) != 0u;
+			return false;
+		}
+
+		/// @brief Writes board as 4 bits per field, low nibble first
+		/// @param board board to encode
+		/// @param out buffer of at least `recordSize(NIBBLE_PACKED, dimension)` bytes
+		/// @returns false if board contains value outside of range 0...15, `out` is undefined then
+		static bool packNibbles(const Board_t<value_t>& board, std::uint8_t* out)
+		{
+			const auto& raw{ board.getRawBoardConstReference() };
+			const std::size_t dimension{ raw.size() };
+			std::memset(out, 0, recordSize(board_encoding_t::NIBBLE_PACKED, dimension));
+			std::size_t index{ 0u };
+			for (std::size_t y{ 0u }; y < dimension; y++)
+				for (std::size_t x{ 0u }; x < dimension; x++, index++)
+				{
+					if (raw[x][y] < static_cast<value_t>(0) || raw[x][y] > static_cast<value_t>(15))
+						return false;
+					out[index >> 1] |= static_cast<std::uint8_t>(static_cast<std::uint32_t>(raw[x][y]) << ((index & 1u) << 2));
+				}
+			return true;
+		}
+
+		/// @brief Reverse operation for `packNibbles()`
+		/// @param in buffer filled by `packNibbles()`
+		/// @param dimension size of encoded board
+		/// @returns decoded board
+		static Board_t<value_t> unpackNibbles(const std::uint8_t* in, std::size_t dimension)
+		{
+			Board_t<value_t> board(static_cast<size_t>(dimension), static_cast<size_t>(dimension));
+			auto& raw{ board.getRawBoardRef() };
+			std::size_t index{ 0u };
+			for (std::size_t y{ 0u }; y < dimension; y++)
+				for (std::size_t x{ 0u }; x < dimension; x++, index++)
+					raw[x][y] = static_cast<value_t>((in[index >> 1] >> ((index & 1u) << 2)) & 0x0Fu);
+			return board;
+		}
+
+		/// @brief Encodes completely filled, valid board as mixed-radix rank. For every field we store index of its value
+		/// among values not yet used by previous fields of the same row, column and subboard.
+		/// @param board filled board of dimension accepted by `supports(PERMUTATION_RANKED, dimension)`
+		/// @param out buffer of at least 16 bytes
+		/// @returns false if board has empty fields or isn't a valid solution
+		static bool rankGrid(const Board_t<value_t>& board, std::uint8_t* out)
+		{
+			const auto& raw{ board.getRawBoardConstReference() };
+			const std::size_t dimension{ raw.size() };
+			std::vector<std::uint8_t> cells(dimension * dimension);
+			std::vector<std::pair<std::uint8_t, std::uint8_t>> digits(dimension * dimension); // (index among allowed values, number of allowed values)
+			for (std::size_t y{ 0u }; y < dimension; y++)
+				for (std::size_t x{ 0u }; x < dimension; x++)
+				{
+					auto value{ static_cast<std::uint32_t>(raw[x][y]) };
+					if (value == 0u || value > dimension)
+						return false;
+					cells[y * dimension + x] = static_cast<std::uint8_t>(value);
+					std::uint32_t used{ usedValuesMask(cells, dimension, x, y) };
+					if (used & (1u << (value - 1u)))
+						return false;
+					std::uint8_t index{ 0u }, radix{ 0u };
+					for (std::uint32_t v{ 1u }; v <= dimension; v++)
+					{
+						if (used & (1u << (v - 1u)))
+							continue;
+						if (v < value)
+							index++;
+						radix++;
+					}
+					digits[y * dimension + x] = { index, radix };
+				}
+
+			rank_t rank;
+			for (auto it{ digits.rbegin() }; it != digits.rend(); it++)
+				rank.multiplyAdd(it->second, it->first);
+			for (auto i{ 0u }; i < 8u; i++)
+			{
+				out[i] = static_cast<std::uint8_t>(rank.low >> (8u * i));
+				out[8u + i] = static_cast<std::uint8_t>(rank.high >> (8u * i));
+			}
+			return true;
+		}
+
+		/// @brief Reverse operation for `rankGrid()`
+		/// @param in buffer filled by `rankGrid()`
+		/// @param dimension size of encoded board
+		/// @returns decoded board
+		static Board_t<value_t> unrankGrid(const std::uint8_t* in, std::size_t dimension)
+		{
+			rank_t rank;
+			for (auto i{ 0u }; i < 8u; i++)
+			{
+				rank.low |= static_cast<std::uint64_t>(in[i]) << (8u * i);
+				rank.high |= static_cast<std::uint64_t>(in[8u + i]) << (8u * i);
+			}
+
+			Board_t<value_t> board(static_cast<size_t>(dimension), static_cast<size_t>(dimension));
+			auto& raw{ board.getRawBoardRef() };
+			std::vector<std::uint8_t> cells(dimension * dimension);
+			for (std::size_t y{ 0u }; y < dimension; y++)
+				for (std::size_t x{ 0u }; x < dimension; x++)
+				{
+					std::uint32_t used{ usedValuesMask(cells, dimension, x, y) };
+					std::uint32_t radix{ 0u };
+					for (std::uint32_t v{ 1u }; v <= dimension; v++)
+						radix += !(used & (1u << (v - 1u)));
+					if (radix == 0u)
+						throw std::runtime_error("BoardCodec_t: corrupted permutation-ranked record");
+					std::uint32_t index{ rank.divide(radix) };
+					for (std::uint32_t v{ 1u }; v <= dimension; v++)
+					{
+						if (used & (1u << (v - 1u)))
+							continue;
+						if (index-- == 0u)
+						{
+							cells[y * dimension + x] = static_cast<std::uint8_t>(v);
+							raw[x][y] = static_cast<value_t>(v);
+							break;
+						}
+					}
+				}
+			return board;
+		}
+	};
+
+	/// @brief Header placed at the beginning of every binary board stream.
+	/// @li On disk: magic "MLCM", version, dimension, encoding, reserved byte, record size (u32 LE), CRC-32 of previous 12 bytes (u32 LE).
+	/// @li After the header there is a sequence of blocks, each block is: number of records (u32 LE, at most `max_block_records`),
+	/// CRC-32 of payload (u32 LE), payload.
+	struct board_stream_header_t
+	{
+		static constexpr std::uint8_t magic[4]{ 'M', 'L', 'C', 'M' };
+		static constexpr std::uint8_t current_version{ 1u };
+		static constexpr std::size_t serialized_size{ 16u };
+		/// number of records isn't covered by the checksum, so reader bounds it before allocating the payload
+		static constexpr std::size_t max_block_records{ 65536u };
+
+		std::uint8_t version{ current_version };
+		std::uint8_t dimension{ 9u };
+		board_encoding_t encoding{ board_encoding_t::NIBBLE_PACKED };
+		std::uint32_t record_size{ 0u };
+	};
+
+	namespace detail
+	{
+		/// @brief Stores 32-bit value as little endian bytes
+		inline void storeU32(std::uint8_t* out, std::uint32_t value)
+		{
+			for (auto i{ 0u }; i < 4u; i++)
+				out[i] = static_cast<std::uint8_t>(value >> (8u * i));
+		}
+
+		/// @brief Reads 32-bit little endian value
+		inline std::uint32_t loadU32(const std::uint8_t* in)
+		{
+			std::uint32_t value{ 0u };
+			for (auto i{ 0u }; i < 4u; i++)
+				value |= static_cast<std::uint32_t>(in[i]) << (8u * i);
+			return value;
+		}
+
+		/// @brief Stores 64-bit value as little endian bytes
+		inline void storeU64(std::uint8_t* out, std::uint64_t value)
+		{
+			for (auto i{ 0u }; i < 8u; i++)
+				out[i] = static_cast<std::uint8_t>(value >> (8u * i));
+		}
+
+		/// @brief Reads 64-bit little endian value
+		inline std::uint64_t loadU64(const std::uint8_t* in)
+		{
+			std::uint64_t value{ 0u };
+			for (auto i{ 0u }; i < 8u; i++)
+				value |= static_cast<std::uint64_t>(in[i]) << (8u * i);
+			return value;
+		}
+	}
+
+	/// @brief Streaming writer of boards in compact binary format. Boards are buffered and written in checksummed blocks,
+	/// so the cost of stream operations is paid once per block instead of once per field.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class BoardWriter_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Codec used to encode single records
+		using codec_t = BoardCodec_t<value_t>;
+
+	private:
+		/// @brief destination of encoded data
+		std::ostream& m_stream;
+
+		/// @brief header written at the beginning of the stream
+		board_stream_header_t m_header;
+
+		/// @brief maximal number of records in one block
+		std::size_t m_block_capacity;
+
+		/// @brief encoded records waiting to be written, prefixed with space reserved for block header
+		std::vector<std::uint8_t> m_block;
+
+		/// @brief number of records in `m_block`
+		std::size_t m_block_records{ 0u };
+
+		/// @brief number of records written since construction
+		std::size_t m_written{ 0u };
+
+	public:
+		/// @param stream output stream opened in binary mode
+		/// @param encoding format of single record
+		/// @param dimension size of every board which will be written
+		/// @param block_capacity number of records grouped under one checksum, clamped to [1, `board_stream_header_t::max_block_records`]
+		BoardWriter_t(std::ostream& stream, board_encoding_t encoding = board_encoding_t::NIBBLE_PACKED, std::size_t dimension = 9u, std::size_t block_capacity = 4096u)
+			: m_stream{ stream }, m_block_capacity{ std::clamp<std::size_t>(block_capacity, 1u, board_stream_header_t::max_block_records) }
+		{
+			if (!codec_t::supports(encoding, dimension))
+				throw std::invalid_argument("BoardWriter_t: encoding doesn't support boards of given dimension");
+			m_header.dimension = static_cast<std::uint8_t>(dimension);
+			m_header.encoding = encoding;
+			m_header.record_size = static_cast<std::uint32_t>(codec_t::recordSize(encoding, dimension));
+			m_block.reserve(8u + m_block_capacity * m_header.record_size);
+			m_block.resize(8u);
+
+			std::uint8_t raw_header[board_stream_header_t::serialized_size]{};
+			std::memcpy(raw_header, board_stream_header_t::magic, 4u);
+			raw_header[4] = m_header.version;
+			raw_header[5] = m_header.dimension;
+			raw_header[6] = static_cast<std::uint8_t>(m_header.encoding);
+			detail::storeU32(raw_header + 8, m_header.record_size);
+			detail::storeU32(raw_header + 12, utils::checksum::crc32(raw_header, 12u));
+			m_stream.write(reinterpret_cast<const char*>(raw_header), sizeof(raw_header));
+		}
+
+		BoardWriter_t(const BoardWriter_t&) = delete;
+
+		/// @brief flushes pending records
+		~BoardWriter_t()
+		{
+			flush();
+		}
+
+		/// @brief Encodes board and appends it to current block
+		/// @param board board of dimension given in constructor; values in range 0...15 for `NIBBLE_PACKED`,
+		/// for `PERMUTATION_RANKED` it has to be filled and valid
+		/// @throws std::invalid_argument if board can't be stored with encoding of the stream
+		void write(const Board_t<value_t>& board)
+		{
+			if (board.getSize().first != m_header.dimension || board.getSize().second != m_header.dimension)
+				throw std::invalid_argument("BoardWriter_t: board dimension doesn't match stream header");
+			const std::size_t offset{ m_block.size() };
+			m_block.resize(offset + m_header.record_size);
+			if (m_header.encoding == board_encoding_t::NIBBLE_PACKED)
+			{
+				if (!codec_t::packNibbles(board, m_block.data() + offset))
+				{
+					m_block.resize(offset);
+					throw std::invalid_argument("BoardWriter_t: only values 0-15 can be nibble-packed");
+				}
+			}
+			else if (!codec_t::rankGrid(board, m_block.data() + offset))
+			{
+				m_block.resize(offset);
+				throw std::invalid_argument("BoardWriter_t: only filled and valid boards can be permutation-ranked");
+			}
+			m_written++;
+			if (++m_block_records == m_block_capacity)
+				flush();
+		}
+
+		/// @brief Writes current block (if not empty) to the stream
+		void flush()
+		{
+			if (m_block_records == 0u)
+				return;
+			detail::storeU32(m_block.data(), static_cast<std::uint32_t>(m_block_records));
+			detail::storeU32(m_block.data() + 4, utils::checksum::crc32(m_block.data() + 8, m_block.size() - 8u));
+			m_stream.write(reinterpret_cast<const char*>(m_block.data()), m_block.size());
+			m_stream.flush();
+			m_block.resize(8u);
+			m_block_records = 0u;
+		}
+
+		/// @returns number of boards passed to `write()` so far
+		inline std::size_t getWrittenCount() const { return m_written; }
+	};
+
+	/// @brief Streaming reader of boards written by `BoardWriter_t`. Validates header and checksum of every block.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class BoardReader_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Codec used to decode single records
+		using codec_t = BoardCodec_t<value_t>;
+
+	private:
+		/// @brief source of encoded data
+		std::istream& m_stream;
+
+		/// @brief header read from the beginning of the stream
+		board_stream_header_t m_header;
+
+		/// @brief payload of current block
+		std::vector<std::uint8_t> m_block;
+
+		/// @brief number of records in `m_block`
+		std::size_t m_block_records{ 0u };
+
+		/// @brief index of next record to be decoded from `m_block`
+		std::size_t m_next_record{ 0u };
+
+		/// @brief Loads next block from the stream
+		/// @returns false at the end of the stream
+		bool readBlock()
+		{
+			std::uint8_t block_header[8];
+			if (!m_stream.read(reinterpret_cast<char*>(block_header), sizeof(block_header)))
+			{
+				if (m_stream.gcount() != 0)
+					throw std::runtime_error("BoardReader_t: truncated block header");
+				return false;
+			}
+			m_block_records = detail::loadU32(block_header);
+			m_next_record = 0u;
+			if (m_block_records > board_stream_header_t::max_block_records)
+			{
+				m_block_records = 0u;
+				throw std::runtime_error("BoardReader_t: invalid block header");
+			}
+			m_block.resize(m_block_records * m_header.record_size);
+			if (!m_stream.read(reinterpret_cast<char*>(m_block.data()), m_block.size()))
+				throw std::runtime_error("BoardReader_t: truncated block");
+			if (utils::checksum::crc32(m_block.data(), m_block.size()) != detail::loadU32(block_header + 4))
+				throw std::runtime_error("BoardReader_t: block checksum mismatch");
+			return true;
+		}
+
+	public:
+		/// @param stream input stream opened in binary mode, positioned at the header written by `BoardWriter_t`
+		BoardReader_t(std::istream& stream)
+			: m_stream{ stream }
+		{
+			std::uint8_t raw_header[board_stream_header_t::serialized_size];
+			if (!m_stream.read(reinterpret_cast<char*>(raw_header), sizeof(raw_header)))
+				throw std::runtime_error("BoardReader_t: missing stream header");
+			if (std::memcmp(raw_header, board_stream_header_t::magic, 4u) != 0)
+				throw std::runtime_error("BoardReader_t: invalid magic number");
+			if (utils::checksum::crc32(raw_header, 12u) != detail::loadU32(raw_header + 12))
+				throw std::runtime_error("BoardReader_t: header checksum mismatch");
+			m_header.version = raw_header[4];
+			m_header.dimension = raw_header[5];
+			m_header.encoding = static_cast<board_encoding_t>(raw_header[6]);
+			m_header.record_size = detail::loadU32(raw_header + 8);
+			if (m_header.version != board_stream_header_t::current_version)
+				throw std::runtime_error("BoardReader_t: unsupported version");
+			if (!codec_t::supports(m_header.encoding, m_header.dimension) || m_header.record_size != codec_t::recordSize(m_header.encoding, m_header.dimension))
+				throw std::runtime_error("BoardReader_t: inconsistent header");
+		}
+
+		/// @brief Decodes next board from the stream
+		/// @param board object to be overwritten by decoded board
+		/// @returns false if there are no more boards
+		bool read(Board_t<value_t>& board)
+		{
+			while (m_next_record == m_block_records)
+				if (!readBlock())
+					return false;
+			const std::uint8_t* record{ m_block.data() + m_next_record++ * m_header.record_size };
+			if (m_header.encoding == board_encoding_t::NIBBLE_PACKED)
+				board = codec_t::unpackNibbles(record, m_header.dimension);
+			else
+				board = codec_t::unrankGrid(record, m_header.dimension);
+			return true;
+		}
+
+		/// @returns header read from the stream
+		inline const board_stream_header_t& getHeader() const { return m_header; }
+	};
+}
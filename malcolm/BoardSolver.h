@@ -1,12 +1,15 @@
 #pragma once
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <algorithm>
+#include <array>
 #include <set>
+#include <string>
 #include <unordered_set>
 
 #include "Board.h"
-#include "Vector2DUtils.h"
 #include "TracingService.h"
 
 #include "SmartCleaner.h"
@@ -14,6 +17,16 @@
 #include "FillSubboardsStrategy.h"
 #include "TheOnlyPossibilityStrategy.h"
 #include "BruteforceStrategy.h"
+#include "FishStrategy.h"
+#include "ForcingChainStrategy.h"
+#include "DigitBitboards.h"
+#include "IncrementalValidator.h"
+#include "SolveBudget.h"
+#include "StrategyScheduler.h"
+#include "PerfCounters.h"
+#include "SearchProfiler.h"
+#include "KillerCages.h"
+#include "ConstraintGraph.h"
 
 namespace malcolm
 {
@@ -36,125 +49,356 @@ namespace malcolm
 		using SolvingStrategyCollection_t = std::vector<SolvingStrategyPtr_t>;
 
 		/// Alias for `Board_t` with specified data type for code simplification.
-		using Board_t = Board_t<value_t>;
+		using Board_t = malcolm::Board_t<value_t>;
 
 	private:
 		/// @brief Logging service instance for this class
 		FileTracingService_t m_trace;
 
+		/// @brief Units and peers of the board, shared with bruteforce scenarios (and other solvers if given in constructor)
+		std::shared_ptr<const ConstraintGraph_t> m_graph;
+
 		/// @brief All possible insertions we can do at the moment
 		PossibilitiesBoard_t<value_t> m_current_possibilities;
 
+		/// @brief The same possibilities as `m_current_possibilities` viewed per value, always kept in sync with it
+		DigitBitboards_t<value_t> m_bitboards;
+
+		/// @brief Set as soon as current state is known not to lead to a solution, solving stops then
+		bool m_contradiction{ false };
+
 		/// @brief Set of known strategies managed in constructor of `BoardSolver_t<T>`
 		SolvingStrategyCollection_t m_strategies;
 
 		/// @brief Constant reference to externally given board, set by constructor and not changed during lifetime of `BoardSolver_t<T>`
 		const Board_t& m_board;
 
+		/// @brief Follows every insertion done during solving, rejects illegal ones in constant time
+		IncrementalValidator_t<value_t> m_validator;
+
 		/// @brief object providing such functionalities as revalidanting boards of possible insertions
 		SmartCleaner_t<value_t> m_cleaner;
 
+		/// @brief Budget of current solve shared with bruteforce scenarios, nullptr if solving is unlimited
+		SolveBudgetTracker_t* m_budget{ nullptr };
+
+		/// @brief Names of strategies in order of registration, used by `m_scheduler` and in `utils::PerfProfile_t` reports.
+		/// The last one is smart cleaning, which is scheduled only as eliminating strategy.
+		static constexpr std::array<const char*, 7u> s_strategy_names{ "the_only_possibility", "fill_subboards", "x_wing", "swordfish", "jellyfish", "forcing_chain", "smart_clean" };
+
+		/// @brief Decides in which order strategies are asked, shared with bruteforce scenarios (and other solvers if given in constructor)
+		std::shared_ptr<StrategyScheduler_t> m_scheduler;
+
+		/// @brief Cages of killer sudoku, nullptr for classic puzzles
+		std::shared_ptr<const KillerCages_t> m_cages;
+
+		/// @brief Cages whose fields changed since they were last propagated, see `propagateCages()`
+		std::vector<std::uint16_t> m_dirty_cages;
+
+		/// @brief m_cage_dirty[i] is true if cage i is in `m_dirty_cages`
+		std::vector<std::uint8_t> m_cage_dirty;
+
+		/// @brief Assumption this solver propagates as bruteforce scenario, receives its work; nullptr if search isn't profiled
+		search_assumption_t* m_assumption{ nullptr };
+
+		/// @returns nanoseconds elapsed since given point in time
+		static std::uint64_t elapsedSince(std::chrono::steady_clock::time_point start)
+		{
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		/// @brief Counts next node of the solve
+		/// @returns false if budget is exhausted and solving should stop
+		inline bool withinBudget() { return m_budget == nullptr || m_budget->step(); }
+
 		/// @param _allow_recursive_usage special parameter which should be set to false if and only if class BoardSolver_t<>
 		/// refers to this method recursively. For most cases it shouldn't be even considered!
+		/// @li Techniques are used from the simplest one: filling strategies, eliminating strategies (smart cleaning included)
+		/// and bruteforce at the end. As soon as any of them makes progress, solving starts again from the simplest one.
+		/// @li Order of strategies within each group is decided by `m_scheduler`.
 		/// @returns object of type `Board_t` which is solved version of `m_board` field
 		inline Board_t solve(bool _allow_recursive_usage = true)
 		{
 			Board_t copy{ m_board };
 
-			if (_allow_recursive_usage) smartcleanPossibilitiesBoard(copy);
-			if (_allow_recursive_usage) bruteforceStrategyRunner(copy);
-			field_container_t queue{ getFieldsToBeFilled(copy) }; // Queue of fields to be filled
-			while (queue.size() > 0)
+			while (!m_contradiction && copy.count(static_cast<value_t>(0u)) > 0u && withinBudget())
 			{
-				while (queue.size() > 0)
+				if (m_cages && propagateCages(copy) > 0u)
+					continue;
+				field_container_t queue{ getFieldsToBeFilled(copy) }; // Queue of fields to be filled
+				if (queue.size() > 0)
 				{
-					while (queue.size() > 0) // Process next fields until queue is empty
+					auto [pos, value] = *queue.begin();
+					if (!m_validator.isLegal(pos, value))
 					{
-						auto [pos, value] = *queue.begin();
-						copy[pos] = value;
-						m_trace << "[0x10] Inserting value " << static_cast<std::int32_t>(value) << " at position <" << static_cast<std::int32_t>(pos.first) << ", " << static_cast<std::int32_t>(pos.second) << ">\n";
-						postprocessInsertion({ pos, value });
-						queue.erase(queue.begin());
-
-						// Try to obtain further moves
-						queue = getFieldsToBeFilled(copy);
+						m_trace << "[0x31] Illegal insertion of value " << static_cast<std::int32_t>(value) << " at position <" << static_cast<std::int32_t>(pos.first) << ", " << static_cast<std::int32_t>(pos.second) << ">\n";
+						m_contradiction = true;
+						break;
 					}
-					if (_allow_recursive_usage) smartcleanPossibilitiesBoard(copy);
-					queue = getFieldsToBeFilled(copy);
+					copy[pos] = value;
+					m_validator.set(pos, value);
+					if (m_assumption != nullptr)
+						m_assumption->insertions++;
+					m_trace << "[0x10] Inserting value " << static_cast<std::int32_t>(value) << " at position <" << static_cast<std::int32_t>(pos.first) << ", " << static_cast<std::int32_t>(pos.second) << ">\n";
+					postprocessInsertion({ pos, value });
+					continue;
 				}
-				if (_allow_recursive_usage) bruteforceStrategyRunner(copy);
-				smartcleanPossibilitiesBoard(copy);
-				queue = getFieldsToBeFilled(copy);
+				if (applyEliminations(copy, _allow_recursive_usage) > 0u) // filling strategies are stuck, reduce possibilities until they aren't
+					continue;
+				if (_allow_recursive_usage && bruteforceStrategyRunner(copy))
+					continue;
+				break;
+			}
+			if (m_cages && !m_contradiction && copy.count(static_cast<value_t>(0u)) == 0u && !m_cages->isSatisfiedBy(copy))
+			{
+				m_trace << "[0x32] Filled board breaks cage constraints\n";
+				m_contradiction = true;
 			}
 			return copy;
 		}
 
+		/// @brief Marks cages containing given field for `propagateCages()`
+		void markCagesOf(const pos_t& pos)
+		{
+			for (auto cage : m_cages->getCagesOf(bitboard_t::indexOf(pos)))
+				if (!m_cage_dirty[cage])
+				{
+					m_cage_dirty[cage] = 1u;
+					m_dirty_cages.push_back(cage);
+				}
+		}
+
+		/// @brief Applies killer cage constraints to every cage which changed since its last propagation, until nothing changes:
+		/// @li possibilities of empty fields are limited to digits of combinations fitting the remaining sum, see `KillerCages_t::allowedDigits()`;
+		/// @li digit required by the cage whose possible fields lie in single unit of the graph is erased from the rest of that unit.
+		/// Sets `m_contradiction` if a cage can't be completed.
+		/// @param board current state of game
+		/// @returns number of erased possibilities
+		std::size_t propagateCages(const Board_t& board)
+		{
+			std::size_t result{ 0u };
+			while (!m_dirty_cages.empty() && !m_contradiction)
+			{
+				const auto index{ m_dirty_cages.back() };
+				m_dirty_cages.pop_back();
+				m_cage_dirty[index] = 0u;
+				const cage_t& cage{ m_cages->getCages()[index] };
+
+				std::uint16_t placed{ 0u }, available{ 0u };
+				std::uint32_t placed_sum{ 0u };
+				std::size_t empty{ 0u };
+				bitboard_t fields;
+				for (auto field : cage.fields)
+				{
+					fields.set(field);
+					const auto value{ static_cast<std::uint32_t>(board[bitboard_t::positionOf(field)]) };
+					if (value == 0u)
+					{
+						empty++;
+						for (std::uint32_t digit{ 1u }; digit <= 9u; digit++)
+							if (m_bitboards[static_cast<value_t>(digit)].test(field))
+								available |= static_cast<std::uint16_t>(1u << (digit - 1u));
+						continue;
+					}
+					if (placed & (1u << (value - 1u)))
+						placed_sum = max_cage_sum + 1u; // repeated digit, cage is broken
+					placed |= static_cast<std::uint16_t>(1u << (value - 1u));
+					placed_sum += value;
+				}
+				const cage_digits_t digits{ placed_sum > cage.sum ? cage_digits_t{} : KillerCages_t::allowedDigits(empty, cage.sum - placed_sum, available & ~placed) };
+				if (empty == 0u ? placed_sum != cage.sum : digits.possible == 0u)
+				{
+					m_trace << "[0x32] Cage with sum " << cage.sum << " can't be completed\n";
+					m_contradiction = true;
+					break;
+				}
+				for (auto field : cage.fields)
+					for (std::uint32_t digit{ 1u }; digit <= 9u; digit++)
+						if (!(digits.possible & (1u << (digit - 1u))) && m_bitboards[static_cast<value_t>(digit)].test(field))
+						{
+							m_trace << "[0x21] Cage erases possibility " << digit << " at position <" << field % 9u << ", " << field / 9u << ">\n";
+							erasePossibility(bitboard_t::positionOf(field), static_cast<value_t>(digit));
+							result++;
+						}
+				for (std::uint32_t digit{ 1u }; digit <= 9u; digit++)
+				{
+					if (!(digits.required & (1u << (digit - 1u))))
+						continue;
+					const bitboard_t hosts{ fields & m_bitboards[static_cast<value_t>(digit)] };
+					for (std::size_t unit{ 0u }; unit < m_graph->getUnitCount() && hosts.any(); unit++)
+					{
+						const bitboard_t& unit_fields{ m_graph->getUnitMask(unit) };
+						if ((hosts & ~unit_fields).any())
+							continue;
+						for (bitboard_t outside{ unit_fields & ~fields & m_bitboards[static_cast<value_t>(digit)] }; outside.any(); outside.popFirst())
+						{
+							const std::size_t field{ outside.first() };
+							m_trace << "[0x21] Cage erases possibility " << digit << " at position <" << field % 9u << ", " << field / 9u << ">\n";
+							erasePossibility(bitboard_t::positionOf(field), static_cast<value_t>(digit));
+							result++;
+						}
+					}
+				}
+			}
+			if (result > 0u)
+				detectContradiction();
+			return result;
+		}
+
 		/// @brief Manages `BruteforceStrategy_t` solving strategy
 		/// @li Special handling for `BruteforceStrategy_t` is needed because of potential high resource load during bruteforce solving
+		/// @li Moves are tried in order given by the strategy and the first one which gives anything ends the run,
+		/// so cheaper strategies can continue from there
 		/// @see `BruteforceStrategy_t` for implementation details
 		/// @see `ISolvingStrategy_t` for strategy interface description
 		/// @param board Current state of game.
-		void bruteforceStrategyRunner(Board_t& board)
+		/// @returns true if any field was filled or any possibility erased
+		bool bruteforceStrategyRunner(Board_t& board)
 		{
+			utils::ScopedPerfPhase_t perf_phase{ "solver", "bruteforce" };
 			m_trace << "[0x5A] bruteforceStrategyRunner_in\n";
-			using scenario_t = Board_t;
-			using scenario_case_t = std::pair<scenario_t, field_t<value_t>>;
-			using scenario_collection_t = std::vector<scenario_case_t>;
-			scenario_collection_t scenario_collection;
-
+			search_branch_t* branch{ SearchProfiler_t::isEnabled() ? &SearchProfiler_t::openBranch(board.count(static_cast<value_t>(0u))) : nullptr };
+			ScopedSearchTimer_t branch_timer{ branch != nullptr ? &branch->ns : nullptr };
 			BruteforceStrategy_t<value_t> bs;
-			auto bruteforce_movements{ bs.retrieveNextMoves(m_current_possibilities, board) };
+			auto bruteforce_movements{ bs.retrieveNextMoves(m_current_possibilities, m_bitboards, board) };
 			if (bruteforce_movements.size() == 0u)
 			{
 				m_trace << "[0x5A] nothing to do\n";
-				return;
-			}
-			for (auto& [position, value] : bruteforce_movements)
-			{
-				scenario_t scenario{ board };
-				scenario[position] = value;
-				scenario_collection.push_back({ scenario, {position, value} });
+				return false;
 			}
 
-			for (const auto& [scenario, field] : scenario_collection)
+			for (const auto& field : bruteforce_movements)
 			{
-				BoardSolver_t<value_t> scenario_solver(scenario);
-				scenario_solver.postprocessInsertion(field);
-				Board_t scenario_solved{ scenario_solver.solve(false) };
-
-				auto& validator{ BoardValidator_t<value_t>::getInstance() };
+				search_assumption_t* assumption{ nullptr };
+				if (branch != nullptr)
+				{
+					assumption = &branch->assumptions.emplace_back();
+					assumption->field = static_cast<std::uint8_t>(bitboard_t::indexOf(field.first));
+					assumption->value = static_cast<std::uint8_t>(field.second);
+				}
+				Board_t scenario{ board };
+				bool contradiction{ false }, filled{ false };
+				{
+					ScopedSearchTimer_t assumption_timer{ assumption != nullptr ? &assumption->ns : nullptr };
+					scenario[field.first] = field.second;
+					BoardSolver_t<value_t> scenario_solver(scenario, m_scheduler, m_cages, m_graph);
+					scenario_solver.m_budget = m_budget;
+					scenario_solver.m_assumption = assumption;
+					scenario_solver.postprocessInsertion(field);
+					Board_t scenario_solved{ scenario_solver.solve(false) };
+					contradiction = scenario_solver.m_contradiction;
+					filled = scenario_solved.count(0u) == 0u;
+				}
 
-				if (scenario_solved.count(0u) > 0u && !validator.validateBoard(scenario_solved))
+				if (contradiction)
 				{
+					if (assumption != nullptr)
+						assumption->outcome = search_outcome_t::CONTRADICTION;
 					m_trace << "[0x52] Contradition obtained by inserting value " << static_cast<std::int32_t>(field.second) << " at position <" << static_cast<std::int32_t>(field.first.first) << ", " << static_cast<std::int32_t>(field.first.second) << ">\n";
-					m_current_possibilities[field.first].erase(field.second);
+					erasePossibility(field.first, field.second);
+					detectContradiction();
+					return true;
 				}
-				else if (scenario_solved.count(0u) == 0u && validator.validateBoard(scenario_solved))
+				else if (filled) // every insertion was taken from possibilities, so filled board is valid
 				{
+					if (assumption != nullptr)
+						assumption->outcome = search_outcome_t::SOLUTION;
 					m_trace << "[0x53] Solution obtained by inserting value " << static_cast<std::int32_t>(field.second) << " at position <" << static_cast<std::int32_t>(field.first.first) << ", " << static_cast<std::int32_t>(field.first.second) << ">\n";
 					board[field.first] = field.second;
-					return;
+					m_validator.set(field.first, field.second);
+					postprocessInsertion(field);
+					return true;
 				}
-				else
+				m_trace << "[0x54] Nothing obtained by inserting value " << static_cast<std::int32_t>(field.second) << " at position <" << static_cast<std::int32_t>(field.first.first) << ", " << static_cast<std::int32_t>(field.first.second) << ">\n";
+				if (m_budget != nullptr && m_budget->isExhausted())
 				{
-					m_trace << "[0x54] Nothing obtained by inserting value " << static_cast<std::int32_t>(field.second) << " at position <" << static_cast<std::int32_t>(field.first.first) << ", " << static_cast<std::int32_t>(field.first.second) << ">\n";
-					m_trace << "[*DEV] Consider building assumption-stack and providing bruteforce recursive solutions with stack unwinding and contradition detector with automatic corrections\n";
-					//scenario_solver.bruteforceStrategyRunner(scenario_solved);
- 				}
+					if (branch != nullptr)
+						branch->exhausted = true;
+					m_trace << "[0x5C] Budget exhausted\n";
+					return false;
+				}
 			}
 			m_trace << "[0x5B] bruteforceStrategyRunner_out\n";
+			return false;
 		}
 
 		// In general it should erase some elements from the possibilities board.
 		// After it works it should be moved into separate interface similar to ISolvingStrategy_t.
-		void smartcleanPossibilitiesBoard(Board_t& board)
+		/// @returns number of erased possibilities
+		std::size_t smartcleanPossibilitiesBoard(Board_t& board)
 		{
-			if (board.count(static_cast<value_t>(0u)) == 0u)
-			{
-				throw std::exception();
-			}
+			if (board.count(static_cast<value_t>(0u)) == 0u) // nothing left to clean - board is already filled
+				return 0u;
+			const std::size_t before{ m_bitboards.count() };
 			for(auto x : {1,2,3,4,5,6,7,8,9})
 				m_cleaner.smartclean(board, m_current_possibilities, x);
+			m_bitboards.rebuild(m_current_possibilities, board);
+			detectContradiction();
+			const std::size_t erased{ before - m_bitboards.count() };
+			if (m_cages && erased > 0u)
+				for (std::size_t index{ 0u }; index < 81u; index++)
+					markCagesOf(bitboard_t::positionOf(index));
+			return erased;
+		}
+
+		/// @brief Queries strategies about values which can't be inserted anymore and erases them from possibilities.
+		/// Strategies are asked in order given by `m_scheduler` and the first one which finds anything ends the round,
+		/// so expensive strategies run only when cheaper ones are stuck. Smart cleaning is registered last, so with
+		/// `scheduling_policy_t::FIXED` it's asked only when all other strategies fail; the adaptive policy orders it like any other strategy.
+		/// @param board current state of game
+		/// @param allow_smartclean false for bruteforce scenarios, which don't use smart cleaning
+		/// @returns number of erased possibilities
+		std::size_t applyEliminations(Board_t& board, bool allow_smartclean)
+		{
+			std::size_t result{ 0u };
+			for (auto index : m_scheduler->order(strategy_phase_t::ELIMINATING))
+			{
+				if (index == m_strategies.size() && !allow_smartclean)
+					continue;
+				utils::ScopedPerfPhase_t perf_phase{ "eliminating", s_strategy_names[index] };
+				const auto start{ std::chrono::steady_clock::now() };
+				if (index == m_strategies.size())
+					result = smartcleanPossibilitiesBoard(board);
+				else
+					for (const auto& [pos, value] : m_strategies[index]->retrieveEliminations(m_current_possibilities, m_bitboards, board))
+					{
+						m_trace << "[0x20] Erasing possibility " << static_cast<std::int32_t>(value) << " at position <" << static_cast<std::int32_t>(pos.first) << ", " << static_cast<std::int32_t>(pos.second) << ">\n";
+						erasePossibility(pos, value);
+						result++;
+					}
+				const std::uint64_t elapsed{ elapsedSince(start) };
+				m_scheduler->record(strategy_phase_t::ELIMINATING, index, elapsed, result);
+				if (m_assumption != nullptr)
+				{
+					m_assumption->addWork(s_strategy_names[index], elapsed);
+					m_assumption->eliminations += static_cast<std::uint32_t>(result);
+				}
+				if (result > 0u)
+					break;
+			}
+			if (result > 0u)
+				detectContradiction();
+			return result;
+		}
+
+		/// @brief Checks whether current state still can lead to a solution, see `DigitBitboards_t::hasContradiction()`
+		/// @returns true if contradiction was found now or before
+		bool detectContradiction()
+		{
+			if (!m_contradiction && m_bitboards.hasContradiction())
+			{
+				m_trace << "[0x30] Contradiction detected, solving stopped\n";
+				m_contradiction = true;
+			}
+			return m_contradiction;
+		}
+
+		/// @brief Erases single value from possibilities of given field, keeping `m_bitboards` in sync
+		inline void erasePossibility(const pos_t& pos, const value_t& value)
+		{
+			if (m_current_possibilities[pos].erase(value) > 0u && m_cages)
+				markCagesOf(pos);
+			m_bitboards.erase(pos, value);
 		}
 
 		/// @returns 2D board of all possible insertions which can be done at the moment
@@ -164,6 +408,8 @@ namespace malcolm
 			for (auto i{ 0u }; i < x_size; i++)
 				for (auto j{ 0u }; j < y_size; j++)
 					m_current_possibilities[{i, j}] = getPossibleValues({ i,j });
+			m_bitboards.rebuild(m_current_possibilities, m_board);
+			detectContradiction();
 			return m_current_possibilities;
 		}
 
@@ -171,20 +417,15 @@ namespace malcolm
 		/// @param		field			pair<position, value> of last move in the game
 		void postprocessInsertion(const field_t<value_t>& field)
 		{
-			auto eraseFrompossibilities_board = [&](pos_t coords, const T& value) { m_current_possibilities[coords].erase(value); };
+			utils::ScopedPerfPhase_t perf_phase{ "solver", "postprocess_insertion" };
 			auto [pos, value] = field;
-			for (auto i{ 0u }; i < 9u; i++)
-			{
-				eraseFrompossibilities_board({ pos.first, i }, value);
-				eraseFrompossibilities_board({ i, pos.second }, value);
-			}
-			auto local_center_position{ utils::vector2d::getLocalCenter(pos) };
-			for (auto i{ -1 }; i < 2; i++)
-				for (auto j{ -1 }; j < 2; j++)
-				{
-					eraseFrompossibilities_board({ local_center_position.first + j, local_center_position.second + i }, value);
-				}
+			for (auto peer : m_graph->getPeers(bitboard_t::indexOf(pos)))
+				erasePossibility(bitboard_t::positionOf(peer), value);
 			m_current_possibilities[pos] = value_container_t<T>();
+			m_bitboards.place(pos, value);
+			if (m_cages)
+				markCagesOf(pos);
+			detectContradiction();
 		}
 
 		/// Finds all values that can be written in field at given coords
@@ -192,18 +433,14 @@ namespace malcolm
 		/// @returns						set of all values which can be stored at given position
 		value_container_t<value_t> getPossibleValues(pos_t coords) const
 		{
-			using value_container_t = value_container_t<T>;
+			using value_container_t = malcolm::value_container_t<T>;
 
 			if (m_board[coords] != 0u)
 				return value_container_t();
 
 			value_container_t found_values;
-			value_container_t column = m_board.getColumn<value_container_t>(coords.first, [](auto& v, const auto& val) { v.insert(val); });
-			value_container_t row = m_board.getRow<value_container_t>(coords.second, [](auto& v, const auto& val) { v.insert(val); });
-			value_container_t neighborhood = m_board.getNeighborhood(coords);
-			found_values.insert(neighborhood.begin(), neighborhood.end());
-			found_values.insert(column.begin(), column.end());
-			found_values.insert(row.begin(), row.end());
+			for (auto peer : m_graph->getPeers(bitboard_t::indexOf(coords)))
+				found_values.insert(m_board[bitboard_t::positionOf(peer)]);
 
 			value_container_t result;
 			value_container_t target{ 1,2,3,4,5,6,7,8,9 };
@@ -211,26 +448,50 @@ namespace malcolm
 			return result;
 		}
 
-		/// Gets state of game and queries every filling strategy about next field
+		/// Gets state of game and queries strategies about next field, in order given by `m_scheduler`, until any of them finds one
 		/// @param		board		current state of game
 		/// @returns				set of fields (positions and values) that are 100% correct and can be filled
 		field_container_t getFieldsToBeFilled(const Board_t& board) const
 		{
 			field_container_t result;
-			for (const auto& strategy : m_strategies)
+			for (auto index : m_scheduler->order(strategy_phase_t::FILLING))
 			{
-				auto field{ strategy->retrieveNextMove(m_current_possibilities, board) };
-				if (field.second != static_cast<T>(0u))
+				utils::ScopedPerfPhase_t perf_phase{ "filling", s_strategy_names[index] };
+				const auto start{ std::chrono::steady_clock::now() };
+				auto field{ m_strategies[index]->retrieveNextMove(m_current_possibilities, board) };
+				const bool found{ field.second != static_cast<T>(0u) };
+				const std::uint64_t elapsed{ elapsedSince(start) };
+				m_scheduler->record(strategy_phase_t::FILLING, index, elapsed, found ? 1u : 0u);
+				if (m_assumption != nullptr)
+					m_assumption->addWork(s_strategy_names[index], elapsed);
+				if (found)
+				{
 					result.insert(field);
+					break;
+				}
 			}
 			return result;
 		}
 	public:
 		/// Creates solver object for given Board_t. Prepares possibilities board and strategies vector
 		/// @param	current_board		board which will be solved using BoardSolver_t
-		BoardSolver_t(const Board_t& current_board)
-			: m_board{ current_board }, m_current_possibilities{}, m_trace{ "board_solver" }
+		/// @param	scheduler			scheduler shared with other solvers (e.g. all solvers of single thread in batch mode),
+		///								nullptr to use a fresh one with default settings
+		/// @param	cages				cages of killer sudoku, nullptr for classic puzzle
+		/// @param	graph				units and peers of the board, nullptr for classic sudoku
+		/// @throws	std::invalid_argument if board isn't 9x9 or contains value outside of range 0-9, see `IncrementalValidator_t`
+		BoardSolver_t(const Board_t& current_board, std::shared_ptr<StrategyScheduler_t> scheduler = nullptr, std::shared_ptr<const KillerCages_t> cages = nullptr,
+			std::shared_ptr<const ConstraintGraph_t> graph = nullptr)
+			: m_trace{ "board_solver" }, m_graph{ graph != nullptr ? std::move(graph) : ConstraintGraph_t::classic() }, m_current_possibilities{}, m_bitboards{ *m_graph },
+			m_board{ current_board }, m_validator{ current_board, *m_graph }, m_cleaner{ *m_graph },
+			m_scheduler{ scheduler != nullptr ? std::move(scheduler) : std::make_shared<StrategyScheduler_t>() }, m_cages{ std::move(cages) }
 		{
+			if (m_cages)
+			{
+				m_cage_dirty.assign(m_cages->getCages().size(), 1u);
+				for (std::size_t i{ 0u }; i < m_cages->getCages().size(); i++)
+					m_dirty_cages.push_back(static_cast<std::uint16_t>(i));
+			}
 			auto size_of_board{ m_board.getSize() };
 			auto append_possibilities_to_last_column = [&](const value_container_t<value_t>& v) {
 				m_current_possibilities[m_current_possibilities.getSize().first - 1].push_back(v);
@@ -247,8 +508,21 @@ namespace malcolm
 				}
 			}
 			retrievePossibilitiesBoard();
+			if (!m_validator.isConsistent())
+			{
+				m_trace << "[0x31] Given board contains duplicates\n";
+				m_contradiction = true;
+			}
 			m_strategies.push_back(std::make_unique<TheOnlyPossibilityStrategy_t<value_t>>());
-			m_strategies.push_back(std::make_unique<FillSubboardsStrategy_t<value_t>>());
+			m_strategies.push_back(std::make_unique<FillSubboardsStrategy_t<value_t>>(*m_graph));
+			m_strategies.push_back(std::make_unique<XWingStrategy_t<value_t>>());
+			m_strategies.push_back(std::make_unique<SwordfishStrategy_t<value_t>>());
+			m_strategies.push_back(std::make_unique<JellyfishStrategy_t<value_t>>());
+			m_strategies.push_back(std::make_unique<ForcingChainStrategy_t<value_t>>(*m_graph));
+			std::vector<std::string> names(s_strategy_names.begin(), s_strategy_names.begin() + m_strategies.size());
+			m_scheduler->registerStrategies(strategy_phase_t::FILLING, names);
+			names.push_back(s_strategy_names.back());
+			m_scheduler->registerStrategies(strategy_phase_t::ELIMINATING, names);
 
 			m_trace << "[9xXX] New BoardSolver_t<> instance for the following problem...\n";
 			for (auto i{ 0u }; i < 9u; i++)
@@ -273,6 +547,48 @@ namespace malcolm
 		/// board given as a parameter of BoardSolver_t<T> constructor, referenced by m_board variable
 		/// @returns object representing filled board
 		inline Board_t getSolved() { return solve(true); }
+
+		/// Fills everything deduction strategies can fill, without smart cleaning and bruteforce, e.g. as preprocessing for other solvers
+		/// @returns deduced board and possibilities of all its fields, std::nullopt if contradiction was found
+		std::optional<std::pair<Board_t, PossibilitiesBoard_t<value_t>>> getDeduced()
+		{
+			Board_t deduced{ solve(false) };
+			if (m_contradiction)
+				return std::nullopt;
+			return std::make_pair(std::move(deduced), m_current_possibilities);
+		}
+
+		/// Solves board given as a parameter of BoardSolver_t<T> constructor within given limits.
+		/// @param budget deadline, node limit and cancel token of the solve
+		/// @returns status of the solve, solved board (or the most filled one reached) and number of visited nodes
+		solve_result_t<value_t> getSolved(const solve_budget_t& budget)
+		{
+			SolveBudgetTracker_t tracker{ budget };
+			m_budget = &tracker;
+			Board_t solved{ solve(true) };
+			m_budget = nullptr;
+
+			solve_status_t status{ solve_status_t::UNSOLVED };
+			if (m_contradiction)
+				status = solve_status_t::UNSAT;
+			else if (solved.count(static_cast<value_t>(0u)) == 0u)
+				status = solve_status_t::SOLVED;
+			else if (tracker.isExhausted())
+				status = tracker.getStopReason();
+			return { status, std::move(solved), tracker.getNodes() };
+		}
 	};
+
+	/// @brief Solves board within given limits, see `BoardSolver_t::getSolved(const solve_budget_t&)`
+	/// @tparam T type of data stored in board
+	/// @param scheduler scheduler shared with other solves, nullptr to use a fresh one
+	/// @param cages cages of killer sudoku, nullptr for classic puzzle
+	/// @param graph units and peers of the board, nullptr for classic sudoku
+	template<typename T>
+	solve_result_t<T> solve(const Board_t<T>& board, const solve_budget_t& budget, std::shared_ptr<StrategyScheduler_t> scheduler = nullptr, std::shared_ptr<const KillerCages_t> cages = nullptr,
+		std::shared_ptr<const ConstraintGraph_t> graph = nullptr)
+	{
+		return BoardSolver_t<T>(board, std::move(scheduler), std::move(cages), std::move(graph)).getSolved(budget);
+	}
 }
 
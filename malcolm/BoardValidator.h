@@ -34,8 +34,8 @@ namespace malcolm
 		bool validateBoard(const Board_t<value_t>& board, std::function<bool(const Board_t<value_t>&)> additional_checks = [](const Board_t<value_t>& board) { return true; }) const
 		{
 			using namespace utils::vector;
-			using row_t = row_t<value_t>;
-			using column_t = column_t<value_t>;
+			using row_t = malcolm::row_t<value_t>;
+			using column_t = malcolm::column_t<value_t>;
 
 			auto vector_inserter = [](std::vector<value_t>& v, const value_t& val) -> void { v.push_back(val); };
 			auto rawBoard{ board.getRawBoardConstReference() };
@@ -43,19 +43,19 @@ namespace malcolm
 			bool is_correct{ true };
 			for (auto i{ 0u }; i < x; i++) // search for duplicates row-by-row
 			{
-				auto row = board.getRow<row_t>(i, vector_inserter);
+				auto row = board.template getRow<row_t>(i, vector_inserter);
 				if (hasDuplicates<value_t>(row))
 					return false;
 			}
 			for (auto i{ 0u }; i < y; i++) // search for duplicates column-by-column
 			{
-				auto column = board.getColumn<column_t>(i, vector_inserter);
+				auto column = board.template getColumn<column_t>(i, vector_inserter);
 				if (hasDuplicates<value_t>(column))
 					return false;
 			}
 			for (const auto& pos : Board_t<value_t>::centersFor9x9Board()) // retrieve all 3x3 subboards and verify if there is no duplicates in any of subboards
 			{
-				auto neighborhood = board.copyNeighborhood(pos).toContainer<column_t>([](auto& v, const field_t<value_t>& field) { v.push_back(field.second); });
+				auto neighborhood = board.copyNeighborhood(pos).template toContainer<column_t>([](auto& v, const field_t<value_t>& field) { v.push_back(field.second); });
 				if (hasDuplicates<value_t>(neighborhood))
 					return false;
 			}
@@ -1,93 +1,98 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <tuple>
+#include <vector>
+
 #include "Types.h"
 #include "ISolvingStrategy.h"
 #include "Board.h"
-
-#include "VectorUtils.h"
-#include "Vector2DUtils.h"
+#include "DigitBitboards.h"
 
 namespace malcolm
 {
 	/// @brief Strategy implementation - bruteforce
 	/// @tparam T type of data stored in board
 	/// @see ISolvingStrategy_t for interface description
-	/// @li Strategy steps: look at every 3x3 subboard and find values that aren't filled into the 3x3 subboard yet.
-	/// For every such value we retrieve number of fields where it's possible to insert the value.
-	/// If number of fields is exactly 1 then we are 100% sure that this is the right place for the value (this is 
-	/// so called TheOnlyPossibilityStrategy_t). In BruteforceStrategy_t we retrieve more than 1 possible field,
-	/// and we do as follows: for every possibility we create copy of game and input value into field.
-	/// Then we try to process copy-board as it was the regular one, which can lead us to contradition or to
-	/// the solution
+	/// @li Strategy steps: find places where exactly one of two alternatives holds - fields with two possible values
+	/// and values which have only two possible fields in subboard (or jigsaw region or diagonal of the graph). For every alternative
+	/// we create copy of game and input value into field. Then we try to process copy-board as it was the regular one, which can lead us to
+	/// contradition or to the solution.
+	/// @li Alternatives are ordered so the most promising are tried first: fields with fewer possible values first
+	/// (minimum remaining values), then fields with more empty neighbours (degree), then insertions erasing more
+	/// possibilities from neighbours (one-step probe).
 	template<typename T>
 	class BruteforceStrategy_t
 	{
 		using value_t = T;
-		using field_t = field_t<value_t>;
-		using field_container_t = value_container_t<field_t>;
-		using value_container_t = value_container_t<value_t>;
+		using field_t = malcolm::field_t<value_t>;
+		using field_container_t = std::vector<field_t>;
+
+		/// @brief true if insertions are scored by number of possibilities they erase
+		bool m_use_probe;
 
 	public:
-		/// @brief gets state of game and tries to find optimal bruteforce movements
-		/// @param possibilities
-		/// @param board 
-		/// @returns list of all moves that have some sense for bruteforce processing
-		inline virtual field_container_t retrieveNextMoves(const PossibilitiesBoard_t<value_t>& possibilities, const Board_t<value_t>& board) const // override
+		/// @param use_probe if true, insertions with the same number of remaining values and degree are ordered
+		/// by number of possibilities they erase from neighbours
+		BruteforceStrategy_t(bool use_probe = true)
+			: m_use_probe{ use_probe }
 		{
-			static constexpr size_t max_threeshold_count{ 2 };
-			static const value_container_t target{ 1,2,3,4,5,6,7,8,9 };
+		}
 
-			field_container_t result;
+		/// @brief gets state of game and tries to find optimal bruteforce movements
+		/// @param possibilities matrix of input possibilities
+		/// @param bitboards the same possibilities viewed per value
+		/// @param board current state of game
+		/// @returns list of all moves that have some sense for bruteforce processing, the most promising first
+		inline field_container_t retrieveNextMoves([[maybe_unused]] const PossibilitiesBoard_t<value_t>& possibilities, const DigitBitboards_t<value_t>& bitboards, [[maybe_unused]] const Board_t<value_t>& board) const
+		{
+			std::array<std::uint16_t, 81> masks{};
+			bitboard_t empty{};
+			for (value_t value{ 1 }; value <= static_cast<value_t>(9); value++)
+				for (bitboard_t fields{ bitboards[value] }; fields.any(); fields.popFirst())
+				{
+					masks[fields.first()] |= static_cast<std::uint16_t>(1u << (static_cast<std::size_t>(value) - 1u));
+					empty.set(fields.first());
+				}
 
-			/// @brief Counts how many possibilities do we have to put 'goal' by searching whole possibilities board for fields with 'goal' value present
-			/// @remark It's used both for 3x3 and 9x9 boards
-			/// @param goal value for which we search for
-			/// @param possibilities matrix of input possibilities
-			/// @returns number of ways to insert goal into the board
-			auto possibilities_for_goal = 
-				[&](const value_t& goal, const PossibilitiesBoard_t<value_t>& possibilities) 
-					-> size_t
-				{ 
-					return possibilities.count(
-						[&](value_container_t container)
-							-> bool
-						{
-							return container.contains(goal);
-						}
-					);
-				};
-			
-			for (auto& pos : Board_t<value_t>::centersFor9x9Board())
+			std::bitset<81 * 9> chosen;
+			for (bitboard_t fields{ empty }; fields.any(); fields.popFirst()) // fields with two possible values
 			{
-				for (auto& val : target)
+				const std::size_t index{ fields.first() };
+				if (std::popcount(masks[index]) == 2)
+					for (std::uint16_t values = masks[index]; values != 0u; values &= values - 1u)
+						chosen.set(index * 9u + std::countr_zero(values));
+			}
+			const ConstraintGraph_t& graph{ bitboards.getGraph() };
+			for (std::size_t unit{ 18u }; unit < graph.getUnitCount(); unit++) // values with two possible fields in subboard, region or diagonal
+				for (value_t value{ 1 }; value <= static_cast<value_t>(9); value++)
 				{
-					value_container_t neighborhood{ board.getNeighborhood(pos) };
-					PossibilitiesBoard_t<value_t> neighborhood_possibilities{ possibilities.copyNeighborhood(pos) };
-					if (neighborhood.contains(val))
-						continue;
-
-					size_t possibilities_count{ possibilities_for_goal(val, neighborhood_possibilities) };
-					if (possibilities_count <= max_threeshold_count && possibilities_count > 1)
-					{
-						//std::vector<Board_t<value_t>> scenario_collection;
-						for (auto& possibility : possibilities.findAll([&](value_container_t value_container)
-							{
-								return value_container.contains(val);
-							}
-						))
-						{
-							if (utils::vector2d::getLocalCenter(possibility).first == pos.first && utils::vector2d::getLocalCenter(possibility).second == pos.second)
-							{
-								//auto& scenario{ scenario_collection.emplace_back(Board_t<value_t>(board)) };
-								//scenario[possibility] = val;
-								result.insert({ possibility,val });
-							}
-						}
-
-					}
+					bitboard_t fields{ bitboards[value] & graph.getUnitMask(unit) };
+					if (fields.count() == 2)
+						for (; fields.any(); fields.popFirst())
+							chosen.set(fields.first() * 9u + static_cast<std::size_t>(value) - 1u);
 				}
+
+			// (remaining values, -degree, -erased possibilities, index, value)
+			std::vector<std::tuple<int, int, int, std::size_t, std::size_t>> scored;
+			for (std::size_t move{ 0u }; move < chosen.size(); move++)
+			{
+				if (!chosen.test(move))
+					continue;
+				const std::size_t index{ move / 9u }, value_index{ move % 9u };
+				const bitboard_t& peers{ graph.getPeerMask(index) };
+				const int erased{ m_use_probe ? (peers & bitboards[static_cast<value_t>(value_index + 1u)]).count() : 0 };
+				scored.emplace_back(std::popcount(masks[index]), -(peers & empty).count(), -erased, index, value_index);
 			}
+			std::sort(scored.begin(), scored.end());
 
+			field_container_t result;
+			result.reserve(scored.size());
+			for (const auto& [remaining, degree, erased, index, value_index] : scored)
+				result.push_back({ bitboard_t::positionOf(index), static_cast<value_t>(value_index + 1u) });
 			return result;
 		}
 	};
-}
\ No newline at end of file
+}
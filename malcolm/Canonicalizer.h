@@ -0,0 +1,196 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "SolutionCounter.h"
+
+namespace malcolm
+{
+	/// @brief Maps 9x9 boards to canonical representative of their symmetry class.
+	/// @li Considered symmetries: transposition, permutations of bands (groups of 3 rows) and of rows inside bands,
+	/// permutations of stacks (groups of 3 columns) and of columns inside stacks, relabelling of values.
+	/// @li Canonical form is lexicographically minimal board (row by row, empty field = 0) reachable with these symmetries.
+	/// For fixed placement of fields the minimal relabelling is numbering values in order of their first occurrence,
+	/// so the search only has to go through placements, pruned as soon as partial result is greater than the best one.
+	class Canonicalizer_t
+	{
+	public:
+		/// Flat representation of board, see `SolutionCounter_t`
+		using cells_t = SolutionCounter_t::cells_t;
+
+		/// @brief Symmetry mapping board `b` into `apply(b)`
+		struct transform_t
+		{
+			/// board is transposed before rows and columns are permuted
+			bool transpose{ false };
+			/// row `r` of result is row `rows[r]` of (transposed) input
+			std::array<std::uint8_t, 9> rows{ 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+			/// column `c` of result is column `columns[c]` of (transposed) input
+			std::array<std::uint8_t, 9> columns{ 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+			/// value `v` of input becomes `values[v]`, `values[0]` is always 0
+			std::array<std::uint8_t, 10> values{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+			/// @returns board transformed by this symmetry
+			cells_t apply(const cells_t& cells) const
+			{
+				cells_t result;
+				for (std::size_t r{ 0u }; r < 9u; r++)
+					for (std::size_t c{ 0u }; c < 9u; c++)
+					{
+						std::size_t row{ rows[r] }, column{ columns[c] };
+						result[r * 9u + c] = values[transpose ? cells[column * 9u + row] : cells[row * 9u + column]];
+					}
+				return result;
+			}
+
+			/// @returns board `b` such that `apply(b) == cells`
+			cells_t invert(const cells_t& cells) const
+			{
+				std::array<std::uint8_t, 10> inverse_values{};
+				for (std::size_t v{ 0u }; v < 10u; v++)
+					inverse_values[values[v]] = static_cast<std::uint8_t>(v);
+				cells_t result;
+				for (std::size_t r{ 0u }; r < 9u; r++)
+					for (std::size_t c{ 0u }; c < 9u; c++)
+					{
+						std::size_t row{ rows[r] }, column{ columns[c] };
+						(transpose ? result[column * 9u + row] : result[row * 9u + column]) = inverse_values[cells[r * 9u + c]];
+					}
+				return result;
+			}
+		};
+
+	private:
+		/// @brief all permutations of three elements
+		static constexpr std::uint8_t permutations[6][3]{ { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+
+		/// @brief board after transposition (if any) and column permutation, row by row
+		cells_t m_source{};
+
+		/// @brief best board found so far
+		cells_t m_best{};
+
+		/// @brief transform producing `m_best`
+		transform_t m_best_transform;
+
+		/// @brief true if `m_best` holds any result
+		bool m_has_best{ false };
+
+		/// @brief transform currently being built
+		transform_t m_current;
+
+		/// @brief board currently being built
+		cells_t m_candidate{};
+
+		/// @brief Emits row `source_row` of `m_source` as row `level` of candidate, relabelling values on first occurrence
+		/// @param values relabelling built so far, updated in place
+		/// @param next_label first unused label, updated in place
+		/// @param better true if candidate is already known to be smaller than `m_best`, updated in place
+		/// @returns false if candidate became greater than `m_best` (branch can be pruned)
+		bool emitRow(std::size_t level, std::size_t source_row, std::array<std::uint8_t, 10>& values, std::uint8_t& next_label, bool& better)
+		{
+			for (std::size_t c{ 0u }; c < 9u; c++)
+			{
+				std::uint8_t value{ m_source[source_row * 9u + c] };
+				if (value != 0u && values[value] == 0u)
+					values[value] = next_label++;
+				std::uint8_t label{ values[value] };
+				m_candidate[level * 9u + c] = label;
+				if (!better && m_has_best)
+				{
+					std::uint8_t best{ m_best[level * 9u + c] };
+					if (label > best)
+						return false;
+					if (label < best)
+						better = true;
+				}
+			}
+			return true;
+		}
+
+		/// @brief Chooses rows of candidate from `level` on
+		/// @param used_bands bitmask of bands already placed
+		/// @param band band currently being placed
+		/// @param used_rows bitmask of rows of current band already placed
+		/// @returns true if `m_best` was replaced, i.e. current prefix of candidate is now equal to prefix of `m_best`
+		bool searchRows(std::size_t level, std::uint32_t used_bands, std::size_t band, std::uint32_t used_rows, std::array<std::uint8_t, 10> values, std::uint8_t next_label, bool better)
+		{
+			if (level == 9u)
+			{
+				m_best = m_candidate;
+				m_current.values = values;
+				m_best_transform = m_current;
+				m_has_best = true;
+				return true;
+			}
+			bool replaced{ false };
+			const bool band_start{ level % 3u == 0u };
+			for (std::size_t b{ 0u }; b < 3u; b++)
+			{
+				if (band_start ? (used_bands & (1u << b)) != 0u : b != band)
+					continue;
+				for (std::size_t r{ 0u }; r < 3u; r++)
+				{
+					if (!band_start && (used_rows & (1u << r)))
+						continue;
+					std::size_t source_row{ b * 3u + r };
+					auto branch_values{ values };
+					std::uint8_t branch_label{ next_label };
+					bool branch_better{ better };
+					if (!emitRow(level, source_row, branch_values, branch_label, branch_better))
+						continue;
+					m_current.rows[level] = static_cast<std::uint8_t>(source_row);
+					if (searchRows(level + 1u, used_bands | (1u << b), b, band_start ? (1u << r) : used_rows | (1u << r), branch_values, branch_label, branch_better))
+					{
+						// remaining branches share prefix with the new best, so they have to be compared again
+						better = false;
+						replaced = true;
+					}
+				}
+			}
+			return replaced;
+		}
+
+	public:
+		/// @brief Finds canonical form of given board
+		/// @param cells board to be canonicalized
+		/// @param transform receives symmetry mapping `cells` to result
+		/// @returns canonical representative
+		cells_t canonicalize(const cells_t& cells, transform_t& transform)
+		{
+			m_has_best = false;
+			for (auto transpose : { false, true })
+			{
+				m_current.transpose = transpose;
+				for (const auto& stacks : permutations)
+					for (const auto& first : permutations)
+						for (const auto& second : permutations)
+							for (const auto& third : permutations)
+							{
+								const std::uint8_t* inside[3]{ first, second, third };
+								for (std::size_t s{ 0u }; s < 3u; s++)
+									for (std::size_t c{ 0u }; c < 3u; c++)
+										m_current.columns[s * 3u + c] = static_cast<std::uint8_t>(stacks[s] * 3u + inside[s][c]);
+								for (std::size_t r{ 0u }; r < 9u; r++)
+									for (std::size_t c{ 0u }; c < 9u; c++)
+									{
+										std::size_t column{ m_current.columns[c] };
+										m_source[r * 9u + c] = transpose ? cells[column * 9u + r] : cells[r * 9u + column];
+									}
+								searchRows(0u, 0u, 0u, 0u, {}, 1u, false);
+							}
+			}
+
+			// values which don't occur on the board get remaining labels, so the transform stays a bijection
+			std::uint8_t next_label{ 1u };
+			for (std::size_t v{ 1u }; v < 10u; v++)
+				if (m_best_transform.values[v] >= next_label)
+					next_label = m_best_transform.values[v] + 1u;
+			for (std::size_t v{ 1u }; v < 10u; v++)
+				if (m_best_transform.values[v] == 0u)
+					m_best_transform.values[v] = next_label++;
+			transform = m_best_transform;
+			return m_best;
+		}
+	};
+}
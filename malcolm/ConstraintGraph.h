@@ -0,0 +1,236 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Bitboard.h"
+
+namespace malcolm
+{
+	/// @brief Geometry of 9x9 board - units and peers of every field - compiled into flat index arrays and bitboards,
+	/// so strategies and validators work the same way (and equally fast) for classic sudoku and its variants.
+	/// @li Unit is a set of 9 fields which has to contain every value exactly once. Rows (units 0-8) and columns (units 9-17)
+	/// are always present, followed by subboards or jigsaw regions (units 18-26) and diagonals if requested.
+	/// @li Peers of a field are fields which can't hold the same value: fields sharing any unit with it and fields given by
+	/// rules which don't form units (anti-knight, anti-king), called extra peers.
+	/// @li Description is a list of parts joined with '+': `classic`, `jigsaw:<81 region digits 1-9 row by row>` (replaces subboards),
+	/// `diagonal`, `anti-knight` and `anti-king`. Whitespace inside region digits is ignored, so layouts can be read from files.
+	class ConstraintGraph_t
+	{
+	public:
+		/// @brief number of fields of the board
+		static constexpr std::size_t field_count{ 81u };
+
+		/// @brief number of fields of every unit
+		static constexpr std::size_t unit_size{ 9u };
+
+	private:
+		/// @brief description given to `parse()`
+		std::string m_description;
+
+		/// @brief true if graph describes classic sudoku
+		bool m_classic{ true };
+
+		/// @brief fields of every unit, unit i occupies indices [9 * i, 9 * i + 9)
+		std::vector<std::uint8_t> m_unit_fields;
+
+		/// @brief fields of every unit as bitboards
+		std::vector<bitboard_t> m_unit_masks;
+
+		/// @brief units containing every field, those of field i occupy [m_unit_offsets[i], m_unit_offsets[i + 1])
+		std::vector<std::uint16_t> m_units_of_field;
+		std::array<std::uint16_t, field_count + 1u> m_unit_offsets{};
+
+		/// @brief peers of every field, those of field i occupy [m_peer_offsets[i], m_peer_offsets[i + 1])
+		std::vector<std::uint8_t> m_peer_fields;
+		std::array<std::uint16_t, field_count + 1u> m_peer_offsets{};
+
+		/// @brief peers sharing no unit with the field, laid out as `m_peer_fields`
+		std::vector<std::uint8_t> m_extra_peer_fields;
+		std::array<std::uint16_t, field_count + 1u> m_extra_peer_offsets{};
+
+		/// @brief peers of every field as bitboards
+		std::array<bitboard_t, field_count> m_peer_masks{};
+
+		/// @brief Adds unit with given fields
+		/// @throws std::invalid_argument if unit doesn't have exactly 9 fields
+		void addUnit(const bitboard_t& fields, const std::string& name)
+		{
+			if (fields.count() != static_cast<int>(unit_size))
+				throw std::invalid_argument(name + " has " + std::to_string(fields.count()) + " fields instead of 9");
+			m_unit_masks.push_back(fields);
+			for (bitboard_t rest{ fields }; rest.any(); rest.popFirst())
+				m_unit_fields.push_back(static_cast<std::uint8_t>(rest.first()));
+		}
+
+		/// @brief Makes fields at given relative positions peers of each other
+		template<std::size_t N>
+		void addPeerRule(const std::array<std::pair<int, int>, N>& offsets)
+		{
+			for (std::size_t index{ 0u }; index < field_count; index++)
+				for (const auto& [dx, dy] : offsets)
+				{
+					const int x{ static_cast<int>(index % 9u) + dx }, y{ static_cast<int>(index / 9u) + dy };
+					if (x >= 0 && x < 9 && y >= 0 && y < 9)
+						m_peer_masks[index].set(static_cast<std::size_t>(9 * y + x));
+				}
+		}
+
+		/// @brief Fills flat arrays from units and extra peers collected in `m_peer_masks`
+		void compile()
+		{
+			std::array<bitboard_t, field_count> unit_peers{};
+			for (std::size_t index{ 0u }; index < field_count; index++)
+			{
+				m_unit_offsets[index] = static_cast<std::uint16_t>(m_units_of_field.size());
+				for (std::size_t unit{ 0u }; unit < m_unit_masks.size(); unit++)
+					if (m_unit_masks[unit].test(index))
+					{
+						m_units_of_field.push_back(static_cast<std::uint16_t>(unit));
+						unit_peers[index] = unit_peers[index] | m_unit_masks[unit];
+					}
+				unit_peers[index].reset(index);
+			}
+			m_unit_offsets[field_count] = static_cast<std::uint16_t>(m_units_of_field.size());
+
+			for (std::size_t index{ 0u }; index < field_count; index++)
+			{
+				const bitboard_t extra{ m_peer_masks[index] & ~unit_peers[index] };
+				m_peer_masks[index] = unit_peers[index] | extra;
+				m_peer_offsets[index] = static_cast<std::uint16_t>(m_peer_fields.size());
+				for (bitboard_t rest{ m_peer_masks[index] }; rest.any(); rest.popFirst())
+					m_peer_fields.push_back(static_cast<std::uint8_t>(rest.first()));
+				m_extra_peer_offsets[index] = static_cast<std::uint16_t>(m_extra_peer_fields.size());
+				for (bitboard_t rest{ extra }; rest.any(); rest.popFirst())
+					m_extra_peer_fields.push_back(static_cast<std::uint8_t>(rest.first()));
+			}
+			m_peer_offsets[field_count] = static_cast<std::uint16_t>(m_peer_fields.size());
+			m_extra_peer_offsets[field_count] = static_cast<std::uint16_t>(m_extra_peer_fields.size());
+		}
+
+	public:
+		/// @brief Builds graph of classic sudoku
+		ConstraintGraph_t()
+			: ConstraintGraph_t{ parse("classic") }
+		{
+		}
+
+		/// @brief Builds graph from description, see class documentation for the format
+		/// @throws std::invalid_argument if description is malformed or jigsaw region doesn't have 9 fields
+		static ConstraintGraph_t parse(const std::string& description)
+		{
+			std::string regions;
+			bool diagonal{ false }, anti_knight{ false }, anti_king{ false };
+			std::size_t position{ 0u };
+			while (position <= description.size())
+			{
+				std::size_t end{ description.find('+', position) };
+				if (end == std::string::npos)
+					end = description.size();
+				std::string part{ description.substr(position, end - position) };
+				position = end + 1u;
+				const std::size_t first{ part.find_first_not_of(" \t\r\n") };
+				part = first == std::string::npos ? std::string{} : part.substr(first, part.find_last_not_of(" \t\r\n") - first + 1u);
+
+				if (part.empty() || part == "classic")
+					continue;
+				if (part == "diagonal")
+					diagonal = true;
+				else if (part == "anti-knight")
+					anti_knight = true;
+				else if (part == "anti-king")
+					anti_king = true;
+				else if (part.rfind("jigsaw:", 0u) == 0u)
+				{
+					if (!regions.empty())
+						throw std::invalid_argument("jigsaw regions given twice");
+					for (std::size_t i{ 7u }; i < part.size(); i++)
+						if (part[i] >= '1' && part[i] <= '9')
+							regions.push_back(part[i]);
+						else if (part[i] != ' ' && part[i] != '\t' && part[i] != '\r' && part[i] != '\n')
+							throw std::invalid_argument(std::string("unexpected character '") + part[i] + "' in jigsaw regions");
+					if (regions.size() != field_count)
+						throw std::invalid_argument("jigsaw needs 81 region digits, got " + std::to_string(regions.size()));
+				}
+				else
+					throw std::invalid_argument("unknown variant '" + part + "'");
+			}
+
+			ConstraintGraph_t result{ std::in_place };
+			result.m_description = description;
+			result.m_classic = regions.empty() && !diagonal && !anti_knight && !anti_king;
+			std::array<bitboard_t, 27> lines{};
+			for (std::size_t index{ 0u }; index < field_count; index++)
+			{
+				const std::size_t row{ index / 9u }, column{ index % 9u };
+				lines[row].set(index);
+				lines[9u + column].set(index);
+				lines[18u + (regions.empty() ? (row / 3u) * 3u + column / 3u : static_cast<std::size_t>(regions[index] - '1'))].set(index);
+			}
+			for (std::size_t unit{ 0u }; unit < lines.size(); unit++)
+				result.addUnit(lines[unit], unit < 9u ? "row" : unit < 18u ? "column" : regions.empty() ? "subboard" : "jigsaw region " + std::to_string(unit - 17u));
+			if (diagonal)
+			{
+				bitboard_t main_diagonal, anti_diagonal;
+				for (std::size_t i{ 0u }; i < 9u; i++)
+				{
+					main_diagonal.set(9u * i + i);
+					anti_diagonal.set(9u * i + 8u - i);
+				}
+				result.addUnit(main_diagonal, "diagonal");
+				result.addUnit(anti_diagonal, "diagonal");
+			}
+			if (anti_knight)
+				result.addPeerRule(std::array<std::pair<int, int>, 8>{ { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } } });
+			if (anti_king)
+				result.addPeerRule(std::array<std::pair<int, int>, 4>{ { { 1, 1 }, { 1, -1 }, { -1, -1 }, { -1, 1 } } });
+			result.compile();
+			return result;
+		}
+
+		/// @returns graph of classic sudoku shared by all solvers which aren't given any other
+		static const std::shared_ptr<const ConstraintGraph_t>& classic()
+		{
+			static const std::shared_ptr<const ConstraintGraph_t> s_classic{ std::make_shared<const ConstraintGraph_t>() };
+			return s_classic;
+		}
+
+		/// @returns description given to `parse()`
+		inline const std::string& getDescription() const { return m_description; }
+
+		/// @returns true if graph describes classic sudoku (e.g. its symmetries can be used)
+		inline bool isClassic() const { return m_classic; }
+
+		/// @returns number of units
+		inline std::size_t getUnitCount() const { return m_unit_masks.size(); }
+
+		/// @returns bit indices of fields of given unit
+		inline std::span<const std::uint8_t> getUnit(std::size_t unit) const { return { m_unit_fields.data() + unit * unit_size, unit_size }; }
+
+		/// @returns fields of given unit as bitboard
+		inline const bitboard_t& getUnitMask(std::size_t unit) const { return m_unit_masks[unit]; }
+
+		/// @returns indices of units containing field with given bit index
+		inline std::span<const std::uint16_t> getUnitsOf(std::size_t field) const { return { m_units_of_field.data() + m_unit_offsets[field], m_units_of_field.data() + m_unit_offsets[field + 1u] }; }
+
+		/// @returns bit indices of peers of given field
+		inline std::span<const std::uint8_t> getPeers(std::size_t field) const { return { m_peer_fields.data() + m_peer_offsets[field], m_peer_fields.data() + m_peer_offsets[field + 1u] }; }
+
+		/// @returns peers of given field as bitboard
+		inline const bitboard_t& getPeerMask(std::size_t field) const { return m_peer_masks[field]; }
+
+		/// @returns bit indices of peers sharing no unit with given field
+		inline std::span<const std::uint8_t> getExtraPeers(std::size_t field) const { return { m_extra_peer_fields.data() + m_extra_peer_offsets[field], m_extra_peer_fields.data() + m_extra_peer_offsets[field + 1u] }; }
+
+	private:
+		/// @brief Empty graph filled by `parse()`
+		explicit ConstraintGraph_t(std::in_place_t)
+		{
+		}
+	};
+}
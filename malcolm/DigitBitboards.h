@@ -0,0 +1,108 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "Types.h"
+#include "Board.h"
+#include "Bitboard.h"
+#include "ConstraintGraph.h"
+
+namespace malcolm
+{
+	/// @brief Per-value view of possibilities board: for every value from 1 to 9 set of fields where it can still be inserted.
+	/// Kept next to `PossibilitiesBoard_t` and updated together with it, so strategies working on whole rows and columns
+	/// (see `FishStrategy_t`) can use bit operations and population counts instead of walking through sets.
+	/// @li Fields where value was already inserted are stored too, what allows to check in constant time whether
+	/// current state still can lead to a solution (see `hasContradiction()`).
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class DigitBitboards_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+	private:
+		/// @brief m_candidates[v - 1] is set of fields where value v is still possible
+		std::array<bitboard_t, 9> m_candidates{};
+
+		/// @brief m_placed[v - 1] is set of fields where value v was inserted
+		std::array<bitboard_t, 9> m_placed{};
+
+		/// @brief units and peers of the board, owned by the solver
+		const ConstraintGraph_t* m_graph;
+
+	public:
+		/// @param graph units and peers of the board, has to outlive this object
+		explicit DigitBitboards_t(const ConstraintGraph_t& graph = *ConstraintGraph_t::classic())
+			: m_graph{ &graph }
+		{
+		}
+
+		/// @brief Recomputes all sets from possibilities board
+		/// @param possibilities 9x9 board of possible insertions
+		/// @param board current state of game
+		void rebuild(const PossibilitiesBoard_t<value_t>& possibilities, const Board_t<value_t>& board)
+		{
+			m_candidates.fill({});
+			m_placed.fill({});
+			for (std::size_t index{ 0u }; index < 81u; index++)
+			{
+				const pos_t pos{ bitboard_t::positionOf(index) };
+				for (const auto& value : possibilities[pos])
+					m_candidates[static_cast<std::size_t>(value) - 1u].set(index);
+				if (board[pos] != static_cast<value_t>(0u))
+					m_placed[static_cast<std::size_t>(board[pos]) - 1u].set(index);
+			}
+		}
+
+		/// @brief Marks that value was inserted at given position, so no value can be inserted there anymore
+		inline void place(const pos_t& pos, const value_t& value)
+		{
+			clear(pos);
+			m_placed[static_cast<std::size_t>(value) - 1u].set(bitboard_t::indexOf(pos));
+		}
+
+		/// @returns true if current state can't lead to a solution: some empty field has no possible value
+		/// or some value has no place left in unit of the graph which doesn't contain it yet
+		bool hasContradiction() const
+		{
+			bitboard_t covered{};
+			for (std::size_t v{ 0u }; v < 9u; v++)
+			{
+				const bitboard_t available{ m_candidates[v] | m_placed[v] };
+				covered = covered | available;
+				for (std::size_t unit{ 0u }; unit < m_graph->getUnitCount(); unit++)
+					if (!(available & m_graph->getUnitMask(unit)).any())
+						return true;
+			}
+			return covered != ~bitboard_t{};
+		}
+
+		/// @brief Marks that value can't be inserted at given position anymore
+		inline void erase(const pos_t& pos, const value_t& value) { m_candidates[static_cast<std::size_t>(value) - 1u].reset(bitboard_t::indexOf(pos)); }
+
+		/// @brief Marks that no value can be inserted at given position (e.g. field was filled)
+		inline void clear(const pos_t& pos)
+		{
+			for (auto& candidates : m_candidates)
+				candidates.reset(bitboard_t::indexOf(pos));
+		}
+
+		/// @returns number of all possible insertions
+		std::size_t count() const
+		{
+			std::size_t result{ 0u };
+			for (const auto& candidates : m_candidates)
+				result += candidates.count();
+			return result;
+		}
+
+		/// @returns units and peers of the board
+		inline const ConstraintGraph_t& getGraph() const { return *m_graph; }
+
+		/// @returns set of fields where given value is still possible
+		inline const bitboard_t& operator[](const value_t& value) const { return m_candidates[static_cast<std::size_t>(value) - 1u]; }
+	};
+}
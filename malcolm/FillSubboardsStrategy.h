@@ -1,12 +1,17 @@
 #pragma once
+#include <bit>
+#include <cstdint>
+
 #include "Types.h"
 #include "ISolvingStrategy.h"
 #include "Board.h"
+#include "ConstraintGraph.h"
 
 namespace malcolm
 {
 	/// Strategy implementation.
-	/// Strategy steps: for each 3x3 subboard and for every value from range 1 to 9 check if the value is already in the subboard.
+	/// Strategy steps: for each subboard (jigsaw region or diagonal - every unit of the graph besides rows and columns) and for every value
+	/// from range 1 to 9 check if the value is already in the subboard.
 	/// If value isn't already in subboard then check how many fields in the subboard can be filled with the value without immediate error.
 	/// If number of such fields is equal to 1, then we have next move found.
 	/// @see ISolvingStrategy_t
@@ -14,32 +19,45 @@ namespace malcolm
 	class FillSubboardsStrategy_t : public ISolvingStrategy_t<T>
 	{
 		using value_t = T;
-		using field_t = field_t<value_t>;
-		using value_container_t = value_container_t<value_t>;
+		using field_t = malcolm::field_t<value_t>;
+		using value_container_t = malcolm::value_container_t<value_t>;
+
+		/// @brief units and peers of the board, owned by the solver
+		const ConstraintGraph_t* m_graph;
 
 	public:
+		/// @param graph units and peers of the board, has to outlive the strategy
+		explicit FillSubboardsStrategy_t(const ConstraintGraph_t& graph = *ConstraintGraph_t::classic())
+			: m_graph{ &graph }
+		{
+		}
+
 		inline virtual field_t retrieveNextMove(const PossibilitiesBoard_t<value_t>& possibilities, const Board_t<value_t>& board) const override
 		{
-			value_container_t target{ 1,2,3,4,5,6,7,8,9 };
-			for (const auto& pos : Board_t<size_t>::centersFor9x9Board())
+			for (std::size_t unit{ 18u }; unit < m_graph->getUnitCount(); unit++)
 			{
-				auto neighborhood{ possibilities.copyNeighborhood(pos) };
-				auto local_neighborhood{ board.getNeighborhood(pos) };
-				for (const auto& goal : target)
+				std::uint16_t seen_once{ 0u }, seen_twice{ 0u }, placed{ 0u };
+				for (auto field : m_graph->getUnit(unit))
 				{
-					if (local_neighborhood.contains(goal))
-						continue;
-					auto has_goal = [goal](const value_container_t& container) { return container.contains(goal); };
-					auto count = neighborhood.count(has_goal);
-					if (count == 1u)
+					const pos_t pos{ bitboard_t::positionOf(field) };
+					if (board[pos] != static_cast<value_t>(0u))
+						placed |= static_cast<std::uint16_t>(1u << (static_cast<std::size_t>(board[pos]) - 1u));
+					for (const auto& value : possibilities[pos])
 					{
-						auto relative_position{ neighborhood.find(has_goal) };
-						pos_t valid_position{ relative_position.first + pos.first - 1, relative_position.second + pos.second - 1 };
-						return { valid_position, goal };
+						const std::uint16_t bit{ static_cast<std::uint16_t>(1u << (static_cast<std::size_t>(value) - 1u)) };
+						seen_twice |= seen_once & bit;
+						seen_once |= bit;
 					}
 				}
+				const std::uint16_t singles{ static_cast<std::uint16_t>(seen_once & ~seen_twice & ~placed) };
+				if (singles == 0u)
+					continue;
+				const value_t goal{ static_cast<value_t>(std::countr_zero(singles) + 1) };
+				for (auto field : m_graph->getUnit(unit))
+					if (possibilities[bitboard_t::positionOf(field)].contains(goal))
+						return { bitboard_t::positionOf(field), goal };
 			}
 			return { {0,0},0 };
 		}
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <array>
+#include <bit>
+#include "Types.h"
+#include "ISolvingStrategy.h"
+#include "Board.h"
+#include "DigitBitboards.h"
+
+namespace malcolm
+{
+	/// Strategy implementation - basic fish of given size (X-Wing for 2, Swordfish for 3, Jellyfish for 4).
+	/// Strategy steps: for every value find `size` rows where the value can be placed only in the same `size` columns.
+	/// As every row has to contain the value exactly once, these rows occupy all `size` places of the value in those columns,
+	/// so the value can be erased from the columns in all other rows. The same is done with rows and columns swapped.
+	/// @li Fish doesn't fill any field directly, it only reduces possibilities, see `retrieveEliminations()`.
+	/// @see ISolvingStrategy_t
+	/// @tparam T type of data stored in board
+	/// @tparam size number of rows (or columns) building the fish
+	template<typename T, std::size_t size>
+	class FishStrategy_t : public ISolvingStrategy_t<T>
+	{
+		using value_t = T;
+		using field_t = malcolm::field_t<value_t>;
+		using field_container_t = malcolm::value_container_t<field_t>;
+
+		/// @brief Searches for fish with given base lines
+		/// @param lines lines[i] is 9-bit mask of positions in i-th base line where value is possible
+		/// @param cover receives mask of cover lines
+		/// @param base receives mask of base lines
+		/// @returns true if fish was found
+		static bool findFish(const std::array<std::uint32_t, 9>& lines, std::uint32_t& base, std::uint32_t& cover)
+		{
+			std::array<std::size_t, 9> candidates{};
+			std::size_t candidates_count{ 0u };
+			for (std::size_t i{ 0u }; i < 9u; i++)
+			{
+				auto count{ std::popcount(lines[i]) };
+				if (count >= 2 && count <= static_cast<int>(size))
+					candidates[candidates_count++] = i;
+			}
+			if (candidates_count < size)
+				return false;
+
+			std::array<std::size_t, size> chosen{};
+			for (std::size_t i{ 0u }; i < size; i++)
+				chosen[i] = i;
+			for (;;)
+			{
+				std::uint32_t union_mask{ 0u }, base_mask{ 0u };
+				for (auto index : chosen)
+				{
+					union_mask |= lines[candidates[index]];
+					base_mask |= 1u << candidates[index];
+				}
+				if (std::popcount(union_mask) == static_cast<int>(size))
+				{
+					// the fish is useful only if it removes something from cover lines
+					for (std::size_t i{ 0u }; i < 9u; i++)
+						if (!(base_mask & (1u << i)) && (lines[i] & union_mask))
+						{
+							base = base_mask;
+							cover = union_mask;
+							return true;
+						}
+				}
+
+				// next combination of `size` elements out of `candidates_count`
+				std::size_t k{ size };
+				while (k > 0u && chosen[k - 1u] == candidates_count - size + k - 1u)
+					k--;
+				if (k == 0u)
+					return false;
+				chosen[k - 1u]++;
+				for (std::size_t i{ k }; i < size; i++)
+					chosen[i] = chosen[i - 1u] + 1u;
+			}
+		}
+
+	public:
+		/// Fish never fills fields directly
+		inline virtual field_t retrieveNextMove([[maybe_unused]] const PossibilitiesBoard_t<value_t>& possibilities, [[maybe_unused]] const Board_t<value_t>& board) const override
+		{
+			return { {0,0},0 };
+		}
+
+		inline virtual field_container_t retrieveEliminations([[maybe_unused]] const PossibilitiesBoard_t<value_t>& possibilities, const DigitBitboards_t<value_t>& bitboards, [[maybe_unused]] const Board_t<value_t>& board) const override
+		{
+			field_container_t result;
+			for (value_t value{ 1 }; value <= static_cast<value_t>(9); value++)
+			{
+				const bitboard_t& candidates{ bitboards[value] };
+				if (candidates.count() < static_cast<int>(2u * size))
+					continue;
+				std::array<std::uint32_t, 9> rows{}, columns{};
+				for (std::size_t i{ 0u }; i < 9u; i++)
+				{
+					rows[i] = candidates.rowBits(i);
+					columns[i] = candidates.columnBits(i);
+				}
+
+				std::uint32_t base{ 0u }, cover{ 0u };
+				if (findFish(rows, base, cover)) // base lines are rows, cover lines are columns
+				{
+					for (std::size_t y{ 0u }; y < 9u; y++)
+						if (!(base & (1u << y)))
+							for (std::uint32_t x_mask{ rows[y] & cover }; x_mask != 0u; x_mask &= x_mask - 1u)
+								result.insert({ { static_cast<size_t>(std::countr_zero(x_mask)), static_cast<size_t>(y) }, value });
+				}
+				if (findFish(columns, base, cover)) // base lines are columns, cover lines are rows
+				{
+					for (std::size_t x{ 0u }; x < 9u; x++)
+						if (!(base & (1u << x)))
+							for (std::uint32_t y_mask{ columns[x] & cover }; y_mask != 0u; y_mask &= y_mask - 1u)
+								result.insert({ { static_cast<size_t>(x), static_cast<size_t>(std::countr_zero(y_mask)) }, value });
+				}
+			}
+			return result;
+		}
+	};
+
+	/// Fish of size 2
+	template<typename T>
+	using XWingStrategy_t = FishStrategy_t<T, 2u>;
+
+	/// Fish of size 3
+	template<typename T>
+	using SwordfishStrategy_t = FishStrategy_t<T, 3u>;
+
+	/// Fish of size 4
+	template<typename T>
+	using JellyfishStrategy_t = FishStrategy_t<T, 4u>;
+}
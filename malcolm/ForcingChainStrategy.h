@@ -0,0 +1,198 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "Types.h"
+#include "ISolvingStrategy.h"
+#include "Board.h"
+#include "DigitBitboards.h"
+#include "ConstraintGraph.h"
+
+namespace malcolm
+{
+	/// Strategy implementation - forcing chains with limited lookahead (Nishio).
+	/// Strategy steps: take a field with two possible values (or a value with only two places in a unit of the graph),
+	/// assume each of the two alternatives in turn and propagate naked and hidden singles for a limited number of rounds.
+	/// @li If an alternative leads to contradiction, everything deduced from the other one holds.
+	/// @li Otherwise possibilities erased in both alternatives can be erased from the board.
+	/// @li Propagation works on small copies of the candidates kept on the stack, the board itself is never copied.
+	/// @li Number of examined pairs of alternatives and depth of propagation are limited, so cost of a single call stays predictable.
+	/// @see ISolvingStrategy_t
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class ForcingChainStrategy_t : public ISolvingStrategy_t<T>
+	{
+		using value_t = T;
+		using field_t = malcolm::field_t<value_t>;
+		using field_container_t = malcolm::value_container_t<field_t>;
+
+		/// @brief State of the board during propagation, fields are stored row by row
+		struct snapshot_t
+		{
+			/// bit v - 1 is set if value v is still possible in the field, 0 for filled fields
+			std::array<std::uint16_t, 81> candidates;
+			/// value of the field, 0 for empty field
+			std::array<std::uint8_t, 81> cells;
+
+			/// @returns mask of values which are still possible or inserted in given field
+			inline std::uint16_t alive(std::size_t index) const { return cells[index] != 0u ? static_cast<std::uint16_t>(1u << (cells[index] - 1u)) : candidates[index]; }
+		};
+
+		/// @brief units and peers of the board, owned by the solver
+		const ConstraintGraph_t* m_graph;
+
+		/// @brief maximal number of pairs of alternatives examined in single call
+		std::size_t m_max_pairs;
+
+		/// @brief maximal number of propagation rounds for single alternative
+		std::size_t m_max_depth;
+
+		/// @brief Inserts value into snapshot and erases it from peers
+		/// @returns false if some empty peer was left without possible values
+		bool place(snapshot_t& snapshot, std::size_t index, std::uint8_t value) const
+		{
+			const std::uint16_t bit{ static_cast<std::uint16_t>(1u << (value - 1u)) };
+			if (!(snapshot.candidates[index] & bit))
+				return false;
+			snapshot.cells[index] = value;
+			snapshot.candidates[index] = 0u;
+			for (auto peer : m_graph->getPeers(index))
+			{
+				snapshot.candidates[peer] &= static_cast<std::uint16_t>(~bit);
+				if (snapshot.cells[peer] == 0u && snapshot.candidates[peer] == 0u)
+					return false;
+			}
+			return true;
+		}
+
+		/// @brief Assumes value at given field and propagates singles for at most `m_max_depth` rounds
+		/// @returns false if contradiction was found
+		bool propagate(snapshot_t& snapshot, std::size_t index, std::uint8_t value) const
+		{
+			if (!place(snapshot, index, value))
+				return false;
+			for (std::size_t round{ 0u }; round < m_max_depth; round++)
+			{
+				bool progress{ false };
+				for (std::size_t i{ 0u }; i < 81u; i++) // naked singles
+					if (snapshot.cells[i] == 0u && std::popcount(snapshot.candidates[i]) == 1)
+					{
+						if (!place(snapshot, i, static_cast<std::uint8_t>(std::countr_zero(snapshot.candidates[i]) + 1)))
+							return false;
+						progress = true;
+					}
+				for (std::size_t u{ 0u }; u < m_graph->getUnitCount(); u++) // hidden singles
+				{
+					const auto unit{ m_graph->getUnit(u) };
+					std::uint16_t seen_once{ 0u }, seen_twice{ 0u }, placed{ 0u };
+					for (auto i : unit)
+					{
+						seen_twice |= seen_once & snapshot.candidates[i];
+						seen_once |= snapshot.candidates[i];
+						if (snapshot.cells[i] != 0u)
+							placed |= static_cast<std::uint16_t>(1u << (snapshot.cells[i] - 1u));
+					}
+					if ((seen_once | placed) != 0x1FFu)
+						return false;
+					for (std::uint16_t singles = seen_once & ~seen_twice & ~placed; singles != 0u; singles &= singles - 1u)
+					{
+						const std::uint16_t bit{ static_cast<std::uint16_t>(singles & -singles) };
+						for (auto i : unit)
+							if (snapshot.candidates[i] & bit)
+							{
+								if (!place(snapshot, i, static_cast<std::uint8_t>(std::countr_zero(bit) + 1)))
+									return false;
+								progress = true;
+								break;
+							}
+					}
+				}
+				if (!progress)
+					break;
+			}
+			return true;
+		}
+
+		/// @brief Examines two alternatives of which exactly one holds
+		/// @param result receives possibilities erased by the pair
+		/// @returns true if anything was erased
+		bool examine(const snapshot_t& origin, std::size_t first_index, std::uint8_t first_value, std::size_t second_index, std::uint8_t second_value, field_container_t& result) const
+		{
+			snapshot_t first{ origin }, second{ origin };
+			const bool first_holds{ propagate(first, first_index, first_value) };
+			const bool second_holds{ propagate(second, second_index, second_value) };
+			if (!first_holds && !second_holds) // board is already inconsistent, it's up to the solver to notice it
+				return false;
+			for (std::size_t i{ 0u }; i < 81u; i++)
+			{
+				if (origin.cells[i] != 0u)
+					continue;
+				std::uint16_t alive{ 0u };
+				if (first_holds) alive |= first.alive(i);
+				if (second_holds) alive |= second.alive(i);
+				for (std::uint16_t erased = origin.candidates[i] & ~alive; erased != 0u; erased &= erased - 1u)
+					result.insert({ bitboard_t::positionOf(i), static_cast<value_t>(std::countr_zero(erased) + 1) });
+			}
+			return !result.empty();
+		}
+
+	public:
+		/// @param graph units and peers of the board, has to outlive the strategy
+		/// @param max_pairs maximal number of pairs of alternatives examined in single call
+		/// @param max_depth maximal number of propagation rounds for single alternative
+		ForcingChainStrategy_t(const ConstraintGraph_t& graph = *ConstraintGraph_t::classic(), std::size_t max_pairs = 48u, std::size_t max_depth = 4u)
+			: m_graph{ &graph }, m_max_pairs{ max_pairs }, m_max_depth{ max_depth }
+		{
+		}
+
+		/// Forcing chains never fill fields directly
+		inline virtual field_t retrieveNextMove([[maybe_unused]] const PossibilitiesBoard_t<value_t>& possibilities, [[maybe_unused]] const Board_t<value_t>& board) const override
+		{
+			return { {0,0},0 };
+		}
+
+		virtual field_container_t retrieveEliminations([[maybe_unused]] const PossibilitiesBoard_t<value_t>& possibilities, const DigitBitboards_t<value_t>& bitboards, const Board_t<value_t>& board) const override
+		{
+			snapshot_t origin{};
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				origin.cells[i] = static_cast<std::uint8_t>(board[bitboard_t::positionOf(i)]);
+			for (value_t value{ 1 }; value <= static_cast<value_t>(9); value++)
+				for (bitboard_t fields{ bitboards[value] }; fields.any(); fields.popFirst())
+					origin.candidates[fields.first()] |= static_cast<std::uint16_t>(1u << (static_cast<std::size_t>(value) - 1u));
+
+			field_container_t result;
+			std::size_t pairs{ 0u };
+			for (std::size_t i{ 0u }; i < 81u && pairs < m_max_pairs; i++) // fields with two possible values
+			{
+				if (origin.cells[i] != 0u || std::popcount(origin.candidates[i]) != 2)
+					continue;
+				const std::uint8_t first_value{ static_cast<std::uint8_t>(std::countr_zero(origin.candidates[i]) + 1) };
+				const std::uint8_t second_value{ static_cast<std::uint8_t>(16 - std::countl_zero(origin.candidates[i])) };
+				pairs++;
+				if (examine(origin, i, first_value, i, second_value, result))
+					return result;
+			}
+			for (std::size_t u{ 0u }; u < m_graph->getUnitCount(); u++) // values with two possible places in any unit
+				for (std::uint8_t value{ 1u }; value <= 9u && pairs < m_max_pairs; value++)
+				{
+					const std::uint16_t bit{ static_cast<std::uint16_t>(1u << (value - 1u)) };
+					std::array<std::size_t, 2> places{};
+					std::size_t count{ 0u };
+					for (auto i : m_graph->getUnit(u))
+						if (origin.candidates[i] & bit)
+						{
+							if (count < 2u)
+								places[count] = i;
+							count++;
+						}
+					if (count != 2u)
+						continue;
+					pairs++;
+					if (examine(origin, places[0], value, places[1], value, result))
+						return result;
+				}
+			return result;
+		}
+	};
+}
@@ -0,0 +1,310 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "Types.h"
+#include "Board.h"
+#include "Bitboard.h"
+#include "ConstraintGraph.h"
+#include "IncrementalValidator.h"
+#include "SolutionEnumerator.h"
+
+namespace malcolm
+{
+	/// @brief Kind of hint given by `HintSession_t`, from the most urgent one
+	enum class hint_strategy_t : std::uint8_t
+	{
+		/// nothing to say: board is solved or givens have no solution
+		NONE,
+		/// entered value conflicts with a peer holding the same value
+		CONFLICT,
+		/// entered value differs from the solution
+		MISTAKE,
+		/// field has only one candidate
+		NAKED_SINGLE,
+		/// value has only one place in a unit
+		HIDDEN_SINGLE,
+		/// every place of value in a unit sees some other fields, value is eliminated from them (pointing and claiming on classic board)
+		LOCKED_CANDIDATES,
+		/// no deduction found, value taken from the solution
+		REVEAL
+	};
+
+	/// @returns name of hint strategy
+	inline const char* toString(hint_strategy_t strategy)
+	{
+		switch (strategy)
+		{
+		case hint_strategy_t::CONFLICT: return "conflict";
+		case hint_strategy_t::MISTAKE: return "mistake";
+		case hint_strategy_t::NAKED_SINGLE: return "naked_single";
+		case hint_strategy_t::HIDDEN_SINGLE: return "hidden_single";
+		case hint_strategy_t::LOCKED_CANDIDATES: return "locked_candidates";
+		case hint_strategy_t::REVEAL: return "reveal";
+		default: return "none";
+		}
+	}
+
+	/// @brief Single hint of `HintSession_t`
+	/// @tparam T type of data stored in board
+	template<typename T>
+	struct hint_t
+	{
+		/// kind of the hint
+		hint_strategy_t strategy{ hint_strategy_t::NONE };
+		/// field to be filled (singles, reveal), wrong field (conflict, mistake) or the first field losing candidate (locked candidates)
+		pos_t pos{ 0u, 0u };
+		/// value to be written, wrong value or eliminated value
+		T value{};
+		/// unit of hidden single or locked candidates, index of `ConstraintGraph_t` unit
+		std::size_t unit{ 0u };
+		/// fields losing `value` from candidates (locked candidates only)
+		bitboard_t eliminated{};
+	};
+
+	/// @brief Long-lived state of a puzzle being solved by a player, answering "what's the next step" after every move.
+	/// @li Player's edits (set, clear, undo) are applied as deltas: only the edited field and its peers get their candidates
+	/// recomputed, so cost of an edit and of a hint doesn't depend on how far into the puzzle the player is.
+	/// @li Candidates follow from placed values; eliminations found by deductions (locked candidates) are kept on top of them
+	/// and stay valid while values are only added. Clearing a field (or undoing any edit) drops them, which restores every
+	/// candidate the removed value was blocking.
+	/// @li Hints go from the simplest deduction: conflicts and mistakes first, then naked and hidden singles, locked candidates
+	/// and finally value revealed from the solution, which is found once when the session starts.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class HintSession_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+	private:
+		/// @brief units and peers of the board
+		std::shared_ptr<const ConstraintGraph_t> m_graph;
+
+		/// @brief current values, counters of units and history of edits
+		IncrementalValidator_t<value_t> m_validator;
+
+		/// @brief fields given by the puzzle, they can't be edited
+		bitboard_t m_givens;
+
+		/// @brief bit v - 1 set if value v isn't blocked by any placed peer, 0 for filled fields
+		std::array<std::uint16_t, ConstraintGraph_t::field_count> m_candidates{};
+
+		/// @brief candidates erased by deductions, valid until a value is removed from the board
+		std::array<std::uint16_t, ConstraintGraph_t::field_count> m_eliminated{};
+
+		/// @brief fields of edits done so far, the last one on top, used by `undo()`
+		std::vector<std::uint8_t> m_edits;
+
+		/// @brief solution of the givens, std::nullopt if they have none
+		std::optional<Board_t> m_solution;
+
+		/// @returns candidates of field left after deductions
+		inline std::uint16_t available(std::size_t index) const { return static_cast<std::uint16_t>(m_candidates[index] & ~m_eliminated[index]); }
+
+		/// @brief Recomputes candidates of given field from values of its peers
+		void refresh(std::size_t index)
+		{
+			const pos_t pos{ bitboard_t::positionOf(index) };
+			m_candidates[index] = 0u;
+			for (std::size_t value{ 1u }; value <= 9u; value++)
+				if (m_validator.isLegal(pos, static_cast<value_t>(value)))
+					m_candidates[index] |= static_cast<std::uint16_t>(1u << (value - 1u));
+		}
+
+		/// @brief Updates candidates after value of given field changed
+		/// @param removed true if a value was removed from the field, so eliminations may not hold anymore
+		void update(std::size_t index, bool removed)
+		{
+			if (removed)
+				m_eliminated.fill(0u);
+			refresh(index);
+			for (auto peer : m_graph->getPeers(index))
+				refresh(peer);
+		}
+
+		/// @returns value at field with given bit index
+		inline std::uint8_t cellAt(std::size_t index) const { return static_cast<std::uint8_t>(m_validator[bitboard_t::positionOf(index)]); }
+
+		/// @returns hint for value entered by player which conflicts with a peer or differs from the solution
+		std::optional<hint_t<value_t>> findMistake() const
+		{
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+			{
+				const std::uint8_t value{ cellAt(index) };
+				if (value == 0u || m_givens.test(index))
+					continue;
+				for (auto peer : m_graph->getPeers(index))
+					if (cellAt(peer) == value)
+						return hint_t<value_t>{ hint_strategy_t::CONFLICT, bitboard_t::positionOf(index), static_cast<value_t>(value) };
+				if (m_solution && (*m_solution)[bitboard_t::positionOf(index)] != static_cast<value_t>(value))
+					return hint_t<value_t>{ hint_strategy_t::MISTAKE, bitboard_t::positionOf(index), static_cast<value_t>(value) };
+			}
+			return std::nullopt;
+		}
+
+		/// @returns the first field with single candidate
+		std::optional<hint_t<value_t>> findNakedSingle() const
+		{
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+				if (std::popcount(available(index)) == 1)
+					return hint_t<value_t>{ hint_strategy_t::NAKED_SINGLE, bitboard_t::positionOf(index), static_cast<value_t>(std::countr_zero(available(index)) + 1) };
+			return std::nullopt;
+		}
+
+		/// @returns the first value with single place in a unit
+		std::optional<hint_t<value_t>> findHiddenSingle() const
+		{
+			for (std::size_t unit{ 0u }; unit < m_graph->getUnitCount(); unit++)
+			{
+				std::uint16_t seen_once{ 0u }, seen_twice{ 0u }, placed{ 0u };
+				for (auto index : m_graph->getUnit(unit))
+				{
+					seen_twice |= seen_once & available(index);
+					seen_once |= available(index);
+					if (cellAt(index) != 0u)
+						placed |= static_cast<std::uint16_t>(1u << (cellAt(index) - 1u));
+				}
+				const std::uint16_t singles{ static_cast<std::uint16_t>(seen_once & ~seen_twice & ~placed) };
+				if (singles == 0u)
+					continue;
+				const std::uint16_t bit{ static_cast<std::uint16_t>(singles & -singles) };
+				for (auto index : m_graph->getUnit(unit))
+					if (available(index) & bit)
+						return hint_t<value_t>{ hint_strategy_t::HIDDEN_SINGLE, bitboard_t::positionOf(index), static_cast<value_t>(std::countr_zero(bit) + 1), unit };
+			}
+			return std::nullopt;
+		}
+
+		/// @returns the first elimination of locked candidates, see `SmartCleaner_t` for the rule
+		std::optional<hint_t<value_t>> findLockedCandidates() const
+		{
+			std::array<bitboard_t, 9> fields{};
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+				for (std::uint16_t values = available(index); values != 0u; values &= values - 1u)
+					fields[std::countr_zero(values)].set(index);
+			for (std::size_t unit{ 0u }; unit < m_graph->getUnitCount(); unit++)
+				for (std::size_t value{ 0u }; value < 9u; value++)
+				{
+					bitboard_t hosts{ fields[value] & m_graph->getUnitMask(unit) };
+					if (!hosts.any())
+						continue;
+					bitboard_t seeing{ ~bitboard_t{} };
+					for (; hosts.any() && seeing.any(); hosts.popFirst())
+						seeing = seeing & m_graph->getPeerMask(hosts.first());
+					const bitboard_t eliminated{ seeing & fields[value] };
+					if (eliminated.any())
+						return hint_t<value_t>{ hint_strategy_t::LOCKED_CANDIDATES, bitboard_t::positionOf(eliminated.first()), static_cast<value_t>(value + 1u), unit, eliminated };
+				}
+			return std::nullopt;
+		}
+
+	public:
+		/// @param puzzle 9x9 board with givens
+		/// @param graph units and peers of the board, nullptr for classic sudoku
+		/// @throws std::invalid_argument if puzzle isn't 9x9 or contains value outside of range 0-9
+		explicit HintSession_t(const Board_t& puzzle, std::shared_ptr<const ConstraintGraph_t> graph = nullptr)
+			: m_graph{ graph != nullptr ? std::move(graph) : ConstraintGraph_t::classic() }, m_validator{ puzzle, *m_graph }
+		{
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+			{
+				if (cellAt(index) != 0u)
+					m_givens.set(index);
+				refresh(index);
+			}
+			for (auto& solution : enumerateSolutions(puzzle, m_graph))
+			{
+				m_solution = std::move(solution);
+				break;
+			}
+		}
+
+		/// @brief Writes value entered by player (0 clears the field)
+		/// @returns false if field is given or value is out of range, nothing changes then
+		bool set(const pos_t& pos, const value_t& value)
+		{
+			const std::size_t index{ bitboard_t::indexOf(pos) };
+			if (index >= ConstraintGraph_t::field_count || m_givens.test(index) || value < static_cast<value_t>(0) || value > static_cast<value_t>(9))
+				return false;
+			const bool removed{ cellAt(index) != 0u };
+			m_validator.set(pos, value);
+			m_edits.push_back(static_cast<std::uint8_t>(index));
+			update(index, removed);
+			return true;
+		}
+
+		/// @brief Clears field entered by player
+		/// @returns false if field is given
+		inline bool clear(const pos_t& pos) { return set(pos, static_cast<value_t>(0)); }
+
+		/// @brief Reverts the last edit
+		/// @returns false if there is nothing to revert
+		bool undo()
+		{
+			if (m_edits.empty() || !m_validator.undo())
+				return false;
+			const std::size_t index{ m_edits.back() };
+			m_edits.pop_back();
+			update(index, true);
+			return true;
+		}
+
+		/// @brief Finds the simplest next step. Eliminations of returned locked candidates hint are applied to the session,
+		/// so the next call continues from there.
+		/// @returns the hint, `hint_strategy_t::NONE` if board is solved or givens have no solution
+		hint_t<value_t> hint()
+		{
+			if (auto mistake{ findMistake() })
+				return *mistake;
+			if (auto single{ findNakedSingle() })
+				return *single;
+			if (auto single{ findHiddenSingle() })
+				return *single;
+			if (auto locked{ findLockedCandidates() })
+			{
+				for (bitboard_t fields{ locked->eliminated }; fields.any(); fields.popFirst())
+					m_eliminated[fields.first()] |= static_cast<std::uint16_t>(1u << (static_cast<std::size_t>(locked->value) - 1u));
+				return *locked;
+			}
+			if (!m_solution)
+				return {};
+			std::size_t best_index{ ConstraintGraph_t::field_count };
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+				if (cellAt(index) == 0u && (best_index == ConstraintGraph_t::field_count || std::popcount(available(index)) < std::popcount(available(best_index))))
+					best_index = index;
+			if (best_index == ConstraintGraph_t::field_count)
+				return {};
+			const pos_t pos{ bitboard_t::positionOf(best_index) };
+			return { hint_strategy_t::REVEAL, pos, (*m_solution)[pos] };
+		}
+
+		/// @returns true if givens have a solution
+		inline bool isSolvable() const { return m_solution.has_value(); }
+
+		/// @returns true if every field is filled and no value conflicts with its peers
+		inline bool isSolved() const
+		{
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+				if (cellAt(index) == 0u)
+					return false;
+			return m_validator.isConsistent();
+		}
+
+		/// @returns number of edits which can be reverted
+		inline std::size_t getHistorySize() const { return m_edits.size(); }
+
+		/// @returns candidates of field left after deductions, bit v - 1 for value v
+		inline std::uint16_t getCandidates(const pos_t& pos) const { return available(bitboard_t::indexOf(pos)); }
+
+		/// @returns value at given position
+		inline value_t operator[](const pos_t& pos) const { return m_validator[pos]; }
+	};
+}
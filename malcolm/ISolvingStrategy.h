@@ -1,6 +1,7 @@
 #pragma once
 #include "Types.h"
 #include "Board.h"
+#include "DigitBitboards.h"
 
 namespace malcolm
 {
@@ -19,5 +20,18 @@ namespace malcolm
 		/// @param board current state of game
 		/// @returns next move obtained by the strategy
 		virtual field_t<value_t> retrieveNextMove(const PossibilitiesBoard_t<value_t>& possibilities, const Board_t<value_t>& board) const = 0;
+
+		/// For given state of game search for values which can be erased from possibilities board. Strategies which only fill fields
+		/// don't need to override it.
+		/// @param possibilities object representing possibilities of filling empty fields that we have at the moment
+		/// @param bitboards the same possibilities viewed per value, see `DigitBitboards_t`
+		/// @param board current state of game
+		/// @returns set of pairs (position, value) - value can't be inserted at position
+		virtual value_container_t<field_t<value_t>> retrieveEliminations([[maybe_unused]] const PossibilitiesBoard_t<value_t>& possibilities, [[maybe_unused]] const DigitBitboards_t<value_t>& bitboards, [[maybe_unused]] const Board_t<value_t>& board) const
+		{
+			return {};
+		}
+
+		virtual ~ISolvingStrategy_t() = default;
 	};
 }
\ No newline at end of file
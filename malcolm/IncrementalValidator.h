@@ -0,0 +1,158 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Types.h"
+#include "Board.h"
+#include "ConstraintGraph.h"
+
+namespace malcolm
+{
+	/// Validator following the board move by move. Keeps for every unit of `ConstraintGraph_t` (row, column, 3x3 subboard, ...) number
+	/// of occurrences of each value, so legality of a move and consistency of the whole board are answered in constant time.
+	/// @li Peers which share no unit (e.g. anti-knight) are checked field by field, every pair of equal values counts as a duplicate.
+	/// @li Every change is recorded and can be reverted with `undo()`.
+	/// @li Values have to be in range 0-9 (0 - empty field), others are rejected with `std::invalid_argument` by the constructor
+	/// and by `set()`, so callers don't need to filter their input first.
+	/// @li `BoardValidator_t` stays the reference implementation, checking the whole board at once.
+	/// @tparam T type of data contained in board (in classic sudoku it is number from range 1-9 or empty field)
+	template<typename T>
+	class IncrementalValidator_t
+	{
+	protected:
+		/// Represents type of data stored in fields of the board. Given by template parameter
+		using value_t = T;
+
+		/// @brief Single change of the board, enough to revert it
+		struct change_t
+		{
+			std::uint8_t index;
+			std::uint8_t previous;
+		};
+
+	private:
+		/// @brief values of fields, row by row (0 - empty field)
+		std::array<std::uint8_t, 81> m_cells{};
+
+		/// @brief units and peers of the board
+		const ConstraintGraph_t& m_graph;
+
+		/// @brief m_counts[u][v] is number of occurrences of value v in unit u
+		std::vector<std::array<std::uint8_t, 10>> m_counts;
+
+		/// @brief m_masks[u] has bit v - 1 set if value v occurs in unit u
+		std::vector<std::uint16_t> m_masks;
+
+		/// @brief number of superfluous occurrences summed over all units and values, plus pairs of extra peers with equal values
+		std::size_t m_duplicates{ 0u };
+
+		/// @brief changes done so far, the last one on top
+		std::vector<change_t> m_history;
+
+		/// @returns index of field at given position
+		static constexpr std::size_t indexOf(const pos_t& pos) { return 9u * pos.second + pos.first; }
+
+		/// @returns value as stored in `m_cells`
+		/// @throws std::invalid_argument if value is outside of range 0-9
+		static std::uint8_t toCell(const value_t& value)
+		{
+			if (value < static_cast<value_t>(0) || value > static_cast<value_t>(9))
+				throw std::invalid_argument("IncrementalValidator_t: value out of range 0-9");
+			return static_cast<std::uint8_t>(value);
+		}
+
+		/// @brief Writes value into the field updating counters, without recording history
+		void write(std::size_t index, std::uint8_t value)
+		{
+			const std::uint8_t previous{ m_cells[index] };
+			for (auto unit : m_graph.getUnitsOf(index))
+			{
+				if (previous != 0u)
+				{
+					if (--m_counts[unit][previous] > 0u)
+						m_duplicates--;
+					else
+						m_masks[unit] &= static_cast<std::uint16_t>(~(1u << (previous - 1u)));
+				}
+				if (value != 0u)
+				{
+					if (m_counts[unit][value]++ > 0u)
+						m_duplicates++;
+					else
+						m_masks[unit] |= static_cast<std::uint16_t>(1u << (value - 1u));
+				}
+			}
+			for (auto peer : m_graph.getExtraPeers(index))
+			{
+				if (previous != 0u && m_cells[peer] == previous)
+					m_duplicates--;
+				if (value != 0u && m_cells[peer] == value)
+					m_duplicates++;
+			}
+			m_cells[index] = value;
+		}
+
+	public:
+		/// @param board initial 9x9 state of the board, it may already contain duplicates
+		/// @param graph units and peers of the board, has to outlive the validator
+		/// @throws std::invalid_argument if board isn't 9x9 or contains value outside of range 0-9
+		explicit IncrementalValidator_t(const Board_t<value_t>& board, const ConstraintGraph_t& graph = *ConstraintGraph_t::classic())
+			: m_graph{ graph }, m_counts(graph.getUnitCount()), m_masks(graph.getUnitCount())
+		{
+			if (board.getSize() != std::pair<size_t, size_t>{ 9u, 9u })
+				throw std::invalid_argument("IncrementalValidator_t: board has to be 9x9");
+			for (std::size_t index{ 0u }; index < 81u; index++)
+				write(index, toCell(board[{ static_cast<size_t>(index % 9u), static_cast<size_t>(index / 9u) }]));
+		}
+
+		/// @returns true if value can be written at given position: value is in range 1-9, field is empty and value doesn't occur
+		/// in any of its units nor in its extra peers
+		bool isLegal(const pos_t& pos, const value_t& value) const
+		{
+			const std::size_t index{ indexOf(pos) };
+			if (m_cells[index] != 0u || value < static_cast<value_t>(1) || value > static_cast<value_t>(9))
+				return false;
+			std::uint16_t used{ 0u };
+			for (auto unit : m_graph.getUnitsOf(index))
+				used |= m_masks[unit];
+			if (used & (1u << (static_cast<std::size_t>(value) - 1u)))
+				return false;
+			for (auto peer : m_graph.getExtraPeers(index))
+				if (m_cells[peer] == static_cast<std::uint8_t>(value))
+					return false;
+			return true;
+		}
+
+		/// @returns true if no unit contains any value twice and no extra peers hold equal values
+		inline bool isConsistent() const { return m_duplicates == 0u; }
+
+		/// @brief Writes value at given position (0 clears the field) and records the change
+		/// @throws std::invalid_argument if value is outside of range 0-9, nothing changes then
+		void set(const pos_t& pos, const value_t& value)
+		{
+			const std::size_t index{ indexOf(pos) };
+			const std::uint8_t cell{ toCell(value) };
+			m_history.push_back({ static_cast<std::uint8_t>(index), m_cells[index] });
+			write(index, cell);
+		}
+
+		/// @brief Reverts the last change recorded by `set()`
+		/// @returns false if there is nothing to revert
+		bool undo()
+		{
+			if (m_history.empty())
+				return false;
+			write(m_history.back().index, m_history.back().previous);
+			m_history.pop_back();
+			return true;
+		}
+
+		/// @returns number of changes which can be reverted
+		inline std::size_t getHistorySize() const { return m_history.size(); }
+
+		/// @returns value at given position
+		inline value_t operator[](const pos_t& pos) const { return static_cast<value_t>(m_cells[indexOf(pos)]); }
+	};
+}
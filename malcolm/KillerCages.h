@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "DigitBitboards.h"
+
+namespace malcolm
+{
+	/// @brief Cage of killer sudoku: fields (bit indices 9 * y + x) whose distinct values sum up to `sum`
+	struct cage_t
+	{
+		/// fields of the cage
+		std::vector<std::uint8_t> fields;
+		/// required sum of values
+		std::uint32_t sum{ 0u };
+	};
+
+	/// @brief Digits allowed in cage, see `KillerCages_t::allowedDigits()`. Digit d is bit d - 1.
+	struct cage_digits_t
+	{
+		/// digits present in at least one fitting combination
+		std::uint16_t possible{ 0u };
+		/// digits present in every fitting combination, the cage has to contain them
+		std::uint16_t required{ 0u };
+	};
+
+	/// @brief largest possible sum of distinct digits
+	inline constexpr std::size_t max_cage_sum{ 45u };
+
+	/// @brief All 511 non-empty sets of digits (digit d is bit d - 1) sorted by (size, sum), with start of every (size, sum) group
+	struct cage_combination_table_t
+	{
+		std::array<std::uint16_t, 511> masks{};
+		std::array<std::array<std::uint16_t, max_cage_sum + 2u>, 10> starts{};
+	};
+
+	/// @returns table of digit combinations, built at compile time
+	constexpr cage_combination_table_t makeCageCombinationTable()
+	{
+		cage_combination_table_t table{};
+		auto sumOf = [](std::uint32_t mask)
+			{
+				std::size_t sum{ 0u };
+				for (std::size_t digit{ 1u }; digit <= 9u; digit++)
+					if (mask & (1u << (digit - 1u)))
+						sum += digit;
+				return sum;
+			};
+		std::size_t next{ 0u };
+		for (std::size_t size{ 0u }; size < 10u; size++)
+			for (std::size_t sum{ 0u }; sum <= max_cage_sum + 1u; sum++)
+			{
+				table.starts[size][sum] = static_cast<std::uint16_t>(next);
+				if (sum <= max_cage_sum)
+					for (std::uint32_t mask{ 1u }; mask < 512u; mask++)
+						if (static_cast<std::size_t>(std::popcount(mask)) == size && sumOf(mask) == sum)
+							table.masks[next++] = static_cast<std::uint16_t>(mask);
+			}
+		return table;
+	}
+
+	/// @brief Cages of killer sudoku together with compile-time table of digit combinations.
+	/// @li Combinations of distinct digits are grouped by (number of digits, sum), every group has at most 12 of them,
+	/// so digits allowed by cage under current possibilities are found by filtering single small group.
+	/// @li Input format: cages separated by ';', each written as `sum:field,field,...` with fields given as 9 * y + x.
+	class KillerCages_t
+	{
+	private:
+		/// @brief combinations of digits grouped by size and sum
+		static constexpr cage_combination_table_t s_combinations{ makeCageCombinationTable() };
+
+		/// @brief cages given in constructor
+		std::vector<cage_t> m_cages;
+
+		/// @brief indices of cages containing every field
+		std::array<std::vector<std::uint16_t>, 81> m_cages_of_field;
+
+	public:
+		/// @param cages cages of the puzzle
+		/// @throws std::invalid_argument if field index is out of board or field is repeated within cage
+		explicit KillerCages_t(std::vector<cage_t> cages)
+			: m_cages{ std::move(cages) }
+		{
+			for (std::size_t i{ 0u }; i < m_cages.size(); i++)
+			{
+				bitboard_t seen;
+				for (auto field : m_cages[i].fields)
+				{
+					if (field >= 81u || seen.test(field))
+						throw std::invalid_argument("cage " + std::to_string(i) + " has invalid or repeated field");
+					seen.set(field);
+					m_cages_of_field[field].push_back(static_cast<std::uint16_t>(i));
+				}
+			}
+		}
+
+		/// @brief Reads cages written as `sum:field,field,...;sum:...`
+		/// @throws std::invalid_argument if text doesn't follow the format
+		static KillerCages_t parse(const std::string& text)
+		{
+			std::vector<cage_t> cages;
+			std::size_t position{ 0u };
+			while (position < text.size())
+			{
+				std::size_t end{ text.find(';', position) };
+				if (end == std::string::npos)
+					end = text.size();
+				const std::string cage_text{ text.substr(position, end - position) };
+				position = end + 1u;
+				if (cage_text.find_first_not_of(" \t\r") == std::string::npos)
+					continue;
+				const std::size_t colon{ cage_text.find(':') };
+				if (colon == std::string::npos)
+					throw std::invalid_argument("missing ':' in cage '" + cage_text + "'");
+				cage_t cage;
+				cage.sum = static_cast<std::uint32_t>(std::stoul(cage_text.substr(0u, colon)));
+				for (std::size_t start{ colon + 1u }; start < cage_text.size();)
+				{
+					std::size_t comma{ cage_text.find(',', start) };
+					if (comma == std::string::npos)
+						comma = cage_text.size();
+					cage.fields.push_back(static_cast<std::uint8_t>(std::min<unsigned long>(std::stoul(cage_text.substr(start, comma - start)), 255u)));
+					start = comma + 1u;
+				}
+				cages.push_back(std::move(cage));
+			}
+			return KillerCages_t{ std::move(cages) };
+		}
+
+		/// @param size number of digits
+		/// @param sum required sum
+		/// @param available digits which can still be used
+		/// @returns digits of all combinations of `size` distinct available digits summing up to `sum`
+		static cage_digits_t allowedDigits(std::size_t size, std::size_t sum, std::uint16_t available)
+		{
+			cage_digits_t result{ 0u, 0x1FFu };
+			if (size > 9u || sum > max_cage_sum)
+				return { 0u, 0u };
+			for (std::size_t i{ s_combinations.starts[size][sum] }; i < s_combinations.starts[size][sum + 1u]; i++)
+			{
+				const std::uint16_t mask{ s_combinations.masks[i] };
+				if ((mask & ~available) != 0u)
+					continue;
+				result.possible |= mask;
+				result.required &= mask;
+			}
+			if (result.possible == 0u)
+				result.required = 0u;
+			return result;
+		}
+
+		/// @returns all cages
+		inline const std::vector<cage_t>& getCages() const { return m_cages; }
+
+		/// @returns indices of cages containing field with given bit index
+		inline const std::vector<std::uint16_t>& getCagesOf(std::size_t field) const { return m_cages_of_field[field]; }
+
+		/// @returns true if every cage of filled board has distinct values with required sum
+		template<typename T>
+		bool isSatisfiedBy(const Board_t<T>& board) const
+		{
+			for (const auto& cage : m_cages)
+			{
+				std::uint32_t sum{ 0u }, used{ 0u };
+				for (auto field : cage.fields)
+				{
+					const auto value{ static_cast<std::uint32_t>(board[bitboard_t::positionOf(field)]) };
+					if (value < 1u || value > 9u || (used & (1u << value)))
+						return false;
+					used |= 1u << value;
+					sum += value;
+				}
+				if (sum != cage.sum)
+					return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "BoardSerializer.h"
+#include "SolveBudget.h"
+#include "SolverServer.h"
+#include "LatencyHistogram.h"
+
+namespace malcolm
+{
+#ifndef _WIN32
+	/// @brief Settings of `LoadGenerator_t`
+	struct load_config_t
+	{
+		/// number of concurrent connections
+		std::size_t connections{ 1u };
+		/// number of requests sent ahead of responses on single connection
+		std::size_t depth{ 8u };
+		/// number of times every puzzle is sent
+		std::size_t repeat{ 1u };
+	};
+
+	/// @brief Client of `SolverServer_t` sending given puzzles as fast as the server answers them, used for end to end benchmarks.
+	/// @li Puzzles are spread over connections round robin, every connection keeps `depth` requests in flight.
+	/// @li Latency is measured on client side, from sending request to receiving its response.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class LoadGenerator_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+	private:
+		/// @brief path of server socket
+		std::string m_path;
+
+		/// @brief settings given in constructor
+		load_config_t m_config;
+
+		/// @brief client side latency of requests in nanoseconds, one histogram per connection
+		std::vector<std::unique_ptr<utils::LatencyHistogram_t>> m_latencies;
+
+		/// @brief status of every response, indexed by request id
+		std::vector<std::uint8_t> m_statuses;
+
+		/// @brief wall time of the last `run()` call
+		std::chrono::nanoseconds m_wall_time{ 0 };
+
+		/// @brief Sends requests with ids `first`, `first + step`, ... below `count` over single connection
+		void runConnection(const std::vector<std::array<std::uint8_t, solver_protocol_t::board_size>>& packed, std::size_t first, std::size_t step, std::size_t count, std::vector<Board_t>* solutions, utils::LatencyHistogram_t& latencies)
+		{
+			int fd{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+			sockaddr_un address{ detail::makeAddress(m_path) };
+			if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+			{
+				if (fd >= 0)
+					::close(fd);
+				throw std::runtime_error("can't connect to " + m_path);
+			}
+
+			std::vector<std::chrono::steady_clock::time_point> sent(count);
+			std::array<std::uint8_t, solver_protocol_t::request_size> request{};
+			std::array<std::uint8_t, solver_protocol_t::response_size> response{};
+			std::size_t next{ first }, in_flight{ 0u };
+			auto send = [&]() -> bool
+				{
+					detail::storeU32(request.data(), static_cast<std::uint32_t>(next));
+					std::copy(packed[next % packed.size()].begin(), packed[next % packed.size()].end(), request.begin() + 4);
+					sent[next] = std::chrono::steady_clock::now();
+					next += step;
+					in_flight++;
+					return detail::writeFully(fd, request.data(), request.size());
+				};
+			bool connected{ true };
+			while (connected && next < count && in_flight < m_config.depth)
+				connected = send();
+			while (connected && in_flight > 0u)
+			{
+				if (!detail::readFully(fd, response.data(), response.size()))
+					break;
+				const auto now{ std::chrono::steady_clock::now() };
+				const std::uint32_t id{ detail::loadU32(response.data()) };
+				if (id >= count)
+					break;
+				in_flight--;
+				latencies.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent[id]).count()));
+				m_statuses[id] = response[4];
+				if (solutions != nullptr && id < solutions->size())
+					(*solutions)[id] = BoardCodec_t<value_t>::unpackNibbles(response.data() + 5u, 9u);
+				if (next < count)
+					connected = send();
+			}
+			::close(fd);
+		}
+
+	public:
+		/// @param path path of server socket
+		/// @param config settings of the client
+		LoadGenerator_t(const std::string& path, const load_config_t& config)
+			: m_path{ path }, m_config{ config }
+		{
+			m_config.connections = std::max<std::size_t>(1u, m_config.connections);
+			m_config.depth = std::max<std::size_t>(1u, m_config.depth);
+			m_config.repeat = std::max<std::size_t>(1u, m_config.repeat);
+		}
+
+		/// @brief Sends all puzzles `repeat` times and waits for all responses
+		/// @param puzzles 9x9 boards to be solved
+		/// @returns responses to the first copy of every puzzle, in input order
+		/// @throws std::invalid_argument if a puzzle has value outside of range 0-15 (nothing is sent then) or socket path is too long,
+		/// std::runtime_error if a connection to the server can't be made; connection errors are thrown after all connections finished
+		std::vector<Board_t> run(const std::vector<Board_t>& puzzles)
+		{
+			std::vector<Board_t> solutions(puzzles.size(), Board_t(9u, 9u));
+			if (puzzles.empty())
+				return solutions;
+			std::vector<std::array<std::uint8_t, solver_protocol_t::board_size>> packed(puzzles.size());
+			for (std::size_t i{ 0u }; i < puzzles.size(); i++)
+				if (!BoardCodec_t<value_t>::packNibbles(puzzles[i], packed[i].data()))
+					throw std::invalid_argument("LoadGenerator_t: puzzle " + std::to_string(i) + " has value which can't be nibble-packed");
+
+			const std::size_t count{ puzzles.size() * m_config.repeat };
+			m_latencies.clear();
+			for (std::size_t i{ 0u }; i < m_config.connections; i++)
+				m_latencies.push_back(std::make_unique<utils::LatencyHistogram_t>());
+			m_statuses.assign(count, solver_protocol_t::malformed_status);
+			const auto start{ std::chrono::steady_clock::now() };
+			std::vector<std::thread> connections;
+			std::vector<std::exception_ptr> errors(m_config.connections); // exception can't leave thread, it's rethrown after join
+			for (std::size_t i{ 0u }; i < m_config.connections; i++)
+				connections.emplace_back([&, i]()
+					{
+						try
+						{
+							runConnection(packed, i, m_config.connections, count, &solutions, *m_latencies[i]);
+						}
+						catch (...)
+						{
+							errors[i] = std::current_exception();
+						}
+					});
+			for (auto& connection : connections)
+				connection.join();
+			m_wall_time = std::chrono::steady_clock::now() - start;
+			for (const auto& error : errors)
+				if (error)
+					std::rethrow_exception(error);
+			return solutions;
+		}
+
+		/// @brief Prints number of requests, throughput, latency percentiles and statuses of the last `run()` call
+		void printStatistics(std::ostream& out) const
+		{
+			utils::LatencyHistogram_t merged;
+			for (const auto& latencies : m_latencies)
+				merged.merge(*latencies);
+			const double seconds{ std::chrono::duration<double>(m_wall_time).count() };
+			out << std::fixed << std::setprecision(1)
+				<< "requests " << merged.count() << "  wall " << seconds * 1000.0 << "ms"
+				<< "  throughput " << (seconds > 0.0 ? merged.count() / seconds : 0.0) << "/s  ";
+			merged.printSummary(out, 1e3, "us");
+			out << "\n";
+			for (auto status : { solve_status_t::SOLVED, solve_status_t::UNSAT, solve_status_t::TIMED_OUT, solve_status_t::CANCELLED, solve_status_t::UNSOLVED })
+			{
+				auto count{ std::count(m_statuses.begin(), m_statuses.end(), static_cast<std::uint8_t>(status)) };
+				if (count > 0)
+					out << "  " << toString(status) << " " << count << "\n";
+			}
+			auto malformed{ std::count(m_statuses.begin(), m_statuses.end(), solver_protocol_t::malformed_status) };
+			if (malformed > 0)
+				out << "  malformed or unanswered " << malformed << "\n";
+		}
+	};
+#endif
+}
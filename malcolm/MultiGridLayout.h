@@ -0,0 +1,147 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace malcolm
+{
+	/// @brief Placement of overlapping 9x9 grids on a common canvas (samurai and other gattai puzzles), compiled into global cells.
+	/// @li Every position of the canvas covered by at least one grid is a cell. Cells are numbered row by row over the canvas,
+	/// so a cell covered by more grids (e.g. fields of shared boxes) exists only once and its grids see the same state.
+	/// @li Field of a grid is indexed row by row (9 * y + x) as in `ConstraintGraph_t`, every grid has rows, columns and boxes of classic sudoku.
+	/// @li Description is a name of layout - `samurai` (5 grids sharing corner boxes of the middle one), `twodoku` (2 grids sharing
+	/// single box) or `butterfly` (4 grids on 12x12 canvas) - or `grids:x,y;x,y;...` giving top left corner of every grid.
+	class MultiGridLayout_t
+	{
+	public:
+		/// @brief number of fields of every grid
+		static constexpr std::size_t grid_fields{ 81u };
+
+	private:
+		/// @brief description given to `parse()`
+		std::string m_description;
+
+		/// @brief top left corner of every grid on the canvas
+		std::vector<std::pair<std::size_t, std::size_t>> m_origins;
+
+		/// @brief size of the canvas
+		std::size_t m_width{ 0u }, m_height{ 0u };
+
+		/// @brief cell of every field of every grid, those of grid g occupy [81 * g, 81 * g + 81)
+		std::vector<std::uint16_t> m_cells;
+
+		/// @brief occurrences (81 * grid + field) of every cell, those of cell c occupy [m_occurrence_offsets[c], m_occurrence_offsets[c + 1])
+		std::vector<std::uint16_t> m_occurrences;
+		std::vector<std::uint32_t> m_occurrence_offsets;
+
+		/// @brief position of every cell on the canvas
+		std::vector<std::pair<std::size_t, std::size_t>> m_positions;
+
+		/// @brief Fills cells and occurrences from `m_origins`
+		void compile()
+		{
+			for (const auto& [x, y] : m_origins)
+			{
+				m_width = std::max(m_width, x + 9u);
+				m_height = std::max(m_height, y + 9u);
+			}
+			std::vector<std::vector<std::uint16_t>> covering(m_width * m_height);
+			for (std::size_t grid{ 0u }; grid < m_origins.size(); grid++)
+				for (std::size_t field{ 0u }; field < grid_fields; field++)
+					covering[(m_origins[grid].second + field / 9u) * m_width + m_origins[grid].first + field % 9u].push_back(static_cast<std::uint16_t>(grid * grid_fields + field));
+
+			m_cells.resize(m_origins.size() * grid_fields);
+			for (std::size_t position{ 0u }; position < covering.size(); position++)
+			{
+				if (covering[position].empty())
+					continue;
+				m_occurrence_offsets.push_back(static_cast<std::uint32_t>(m_occurrences.size()));
+				for (auto occurrence : covering[position])
+				{
+					m_cells[occurrence] = static_cast<std::uint16_t>(m_positions.size());
+					m_occurrences.push_back(occurrence);
+				}
+				m_positions.emplace_back(position % m_width, position / m_width);
+			}
+			m_occurrence_offsets.push_back(static_cast<std::uint32_t>(m_occurrences.size()));
+		}
+
+	public:
+		/// @brief Builds layout from description, see class documentation for the format
+		/// @throws std::invalid_argument if description is malformed
+		static MultiGridLayout_t parse(const std::string& description)
+		{
+			MultiGridLayout_t result;
+			result.m_description = description;
+			if (description == "samurai")
+				result.m_origins = { { 0u, 0u }, { 12u, 0u }, { 6u, 6u }, { 0u, 12u }, { 12u, 12u } };
+			else if (description == "twodoku")
+				result.m_origins = { { 0u, 0u }, { 6u, 6u } };
+			else if (description == "butterfly")
+				result.m_origins = { { 0u, 0u }, { 3u, 0u }, { 0u, 3u }, { 3u, 3u } };
+			else if (description.rfind("grids:", 0u) == 0u)
+			{
+				for (std::size_t position{ 6u }; position <= description.size();)
+				{
+					std::size_t end{ description.find(';', position) };
+					if (end == std::string::npos)
+						end = description.size();
+					const std::string corner{ description.substr(position, end - position) };
+					position = end + 1u;
+					const std::size_t comma{ corner.find(',') };
+					if (comma == std::string::npos || comma == 0u || comma + 1u == corner.size() || corner.find_first_not_of("0123456789,") != std::string::npos)
+						throw std::invalid_argument("expected x,y instead of '" + corner + "'");
+					const std::size_t x{ std::stoul(corner.substr(0u, comma)) }, y{ std::stoul(corner.substr(comma + 1u)) };
+					if (x > 255u || y > 255u)
+						throw std::invalid_argument("grid corner " + corner + " is too far");
+					result.m_origins.emplace_back(x, y);
+				}
+				if (result.m_origins.size() > 64u)
+					throw std::invalid_argument("at most 64 grids are supported");
+				std::vector<std::pair<std::size_t, std::size_t>> sorted{ result.m_origins };
+				std::sort(sorted.begin(), sorted.end());
+				if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+					throw std::invalid_argument("two grids have the same corner");
+			}
+			else
+				throw std::invalid_argument("unknown layout '" + description + "'");
+			result.compile();
+			return result;
+		}
+
+		/// @returns description given to `parse()`
+		inline const std::string& getDescription() const { return m_description; }
+
+		/// @returns number of grids
+		inline std::size_t getGridCount() const { return m_origins.size(); }
+
+		/// @returns number of distinct cells
+		inline std::size_t getCellCount() const { return m_positions.size(); }
+
+		/// @returns width of the canvas
+		inline std::size_t getWidth() const { return m_width; }
+
+		/// @returns height of the canvas
+		inline std::size_t getHeight() const { return m_height; }
+
+		/// @returns top left corner of given grid on the canvas
+		inline const std::pair<std::size_t, std::size_t>& getOrigin(std::size_t grid) const { return m_origins[grid]; }
+
+		/// @returns cells of all 81 fields of given grid
+		inline std::span<const std::uint16_t> getCellsOf(std::size_t grid) const { return { m_cells.data() + grid * grid_fields, grid_fields }; }
+
+		/// @returns occurrences of given cell in grids, every one is `81 * grid + field`
+		inline std::span<const std::uint16_t> getOccurrences(std::size_t cell) const { return { m_occurrences.data() + m_occurrence_offsets[cell], m_occurrences.data() + m_occurrence_offsets[cell + 1u] }; }
+
+		/// @returns position of given cell on the canvas
+		inline const std::pair<std::size_t, std::size_t>& getPosition(std::size_t cell) const { return m_positions[cell]; }
+
+	private:
+		/// @brief Empty layout filled by `parse()`
+		MultiGridLayout_t() = default;
+	};
+}
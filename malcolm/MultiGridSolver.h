@@ -0,0 +1,412 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Bitboard.h"
+#include "ConstraintGraph.h"
+#include "MultiGridLayout.h"
+#include "SolveBudget.h"
+
+namespace malcolm
+{
+	/// @brief Result of `MultiGridSolver_t::getSolved()`
+	/// @tparam T type of data stored in board
+	template<typename T>
+	struct multigrid_result_t
+	{
+		/// how solving ended
+		solve_status_t status;
+		/// every grid of the layout, solved or filled as far as propagation of the givens got
+		std::vector<Board_t<T>> grids;
+		/// number of nodes visited
+		std::size_t nodes;
+	};
+
+	/// @brief Counters of single `MultiGridSolver_t`
+	struct multigrid_statistics_t
+	{
+		/// search nodes (guesses)
+		std::size_t nodes{ 0u };
+		/// runs of propagation of single grid
+		std::size_t grid_propagations{ 0u };
+		/// candidates erased by propagation
+		std::size_t eliminations{ 0u };
+	};
+
+	/// @brief Solver of overlapping 9x9 grids (samurai and other gattai puzzles, see `MultiGridLayout_t`).
+	/// @li Every cell of the layout keeps one candidate mask (bit v-1 for value v) shared by all grids covering it,
+	/// so a deduction made in one grid is immediately seen by the others through shared boxes.
+	/// @li Propagation is incremental and works per grid: a changed cell marks its field dirty in every grid covering it,
+	/// and grids with dirty fields wait in a worklist. Propagation of a grid looks only at its dirty fields (naked singles
+	/// are erased from peers) and at units containing them (hidden singles), then at intersections of its boxes with rows
+	/// and columns, until none of its fields is dirty. Grids which nothing reached aren't touched at all, so solving a samurai
+	/// costs about as much as solving its grids separately.
+	/// @li When propagation gets stuck, search continues in the cell with minimal number of candidates (over all grids),
+	/// preferring cells shared by more grids, whose guesses propagate into all of them.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class MultiGridSolver_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+		/// Candidates of all cells
+		using candidates_t = std::vector<std::uint16_t>;
+
+	private:
+		/// @brief placement of the grids
+		std::shared_ptr<const MultiGridLayout_t> m_layout;
+
+		/// @brief units and peers of single grid
+		const ConstraintGraph_t& m_graph;
+
+		/// @brief candidates of every cell, state shared by all grids
+		candidates_t m_candidates;
+
+		/// @brief candidates after propagation of the givens, empty if the givens contradict each other
+		std::optional<candidates_t> m_initial;
+
+		/// @brief fields of every grid changed since the grid was propagated
+		std::vector<bitboard_t> m_dirty;
+
+		/// @brief grids waiting for propagation
+		std::deque<std::size_t> m_worklist;
+
+		/// @brief flags of grids which are in `m_worklist` or being propagated
+		std::vector<std::uint8_t> m_queued;
+
+		/// @brief candidates saved before guesses, one per search depth
+		std::vector<candidates_t> m_saved;
+
+		/// @brief first solution found by search
+		candidates_t m_solution;
+
+		/// @brief number of solutions found by search
+		std::size_t m_found{ 0u };
+
+		/// @brief search stops when `m_found` reaches this value
+		std::size_t m_limit{ 1u };
+
+		/// @brief budget of current search, nullptr outside of it
+		SolveBudgetTracker_t* m_tracker{ nullptr };
+
+		/// @brief counters since construction
+		multigrid_statistics_t m_statistics;
+
+		/// @brief Marks cell dirty in all grids covering it
+		void changed(std::size_t cell)
+		{
+			for (auto occurrence : m_layout->getOccurrences(cell))
+			{
+				const std::size_t grid{ occurrence / MultiGridLayout_t::grid_fields };
+				m_dirty[grid].set(occurrence % MultiGridLayout_t::grid_fields);
+				if (!m_queued[grid])
+				{
+					m_queued[grid] = 1u;
+					m_worklist.push_back(grid);
+				}
+			}
+		}
+
+		/// @brief Leaves single candidate in cell
+		/// @returns false if the candidate isn't possible there
+		bool assign(std::size_t cell, std::uint16_t bit)
+		{
+			if ((m_candidates[cell] & bit) == 0u)
+				return false;
+			if (m_candidates[cell] != bit)
+			{
+				m_statistics.eliminations += std::popcount(m_candidates[cell]) - 1u;
+				m_candidates[cell] = bit;
+				changed(cell);
+			}
+			return true;
+		}
+
+		/// @brief Erases candidates from cell
+		/// @returns false if no candidate is left
+		bool eliminate(std::size_t cell, std::uint16_t bits)
+		{
+			std::uint16_t& candidates{ m_candidates[cell] };
+			if ((candidates & bits) == 0u)
+				return true;
+			candidates &= static_cast<std::uint16_t>(~bits);
+			if (candidates == 0u)
+				return false;
+			m_statistics.eliminations++;
+			changed(cell);
+			return true;
+		}
+
+		/// @brief Erases candidates locked in intersection of box and row or column from the rest of the row or column (pointing)
+		/// and from the rest of the box (claiming)
+		/// @returns false if contradiction was found
+		bool propagateIntersections(std::size_t grid)
+		{
+			const auto cells{ m_layout->getCellsOf(grid) };
+			for (std::size_t orientation{ 0u }; orientation < 2u; orientation++)
+			{
+				auto fieldOf = [orientation](std::size_t line, std::size_t position) { return orientation == 0u ? 9u * line + position : 9u * position + line; };
+				std::array<std::array<std::uint16_t, 3>, 9> segments{}, placed{}; // candidates and placed values of every line within every box it crosses
+				for (std::size_t line{ 0u }; line < 9u; line++)
+					for (std::size_t position{ 0u }; position < 9u; position++)
+					{
+						const std::uint16_t candidates{ m_candidates[cells[fieldOf(line, position)]] };
+						segments[line][position / 3u] |= candidates;
+						placed[line][position / 3u] |= std::has_single_bit(candidates) ? candidates : 0u;
+					}
+
+				for (std::size_t line{ 0u }; line < 9u; line++)
+					for (std::size_t segment{ 0u }; segment < 3u; segment++)
+					{
+						const std::size_t first_line{ line / 3u * 3u }, other_line{ first_line + (line + 1u) % 3u }, last_line{ first_line + (line + 2u) % 3u };
+						const std::uint16_t candidates{ static_cast<std::uint16_t>(segments[line][segment] & ~placed[line][segment]) }; // placed values are erased by singles
+						const std::uint16_t pointing{ static_cast<std::uint16_t>(candidates & ~(segments[other_line][segment] | segments[last_line][segment])) };
+						const std::uint16_t claiming{ static_cast<std::uint16_t>(candidates & ~(segments[line][(segment + 1u) % 3u] | segments[line][(segment + 2u) % 3u])) };
+						if (pointing != 0u)
+							for (std::size_t position{ 0u }; position < 9u; position++)
+								if (position / 3u != segment && !eliminate(cells[fieldOf(line, position)], pointing))
+									return false;
+						if (claiming != 0u)
+							for (auto box_line : { other_line, last_line })
+								for (std::size_t position{ segment * 3u }; position < segment * 3u + 3u; position++)
+									if (!eliminate(cells[fieldOf(box_line, position)], claiming))
+										return false;
+					}
+			}
+			return true;
+		}
+
+		/// @brief Propagates dirty fields of single grid until none is left
+		/// @returns false if contradiction was found
+		bool propagateGrid(std::size_t grid)
+		{
+			const auto cells{ m_layout->getCellsOf(grid) };
+			while (m_dirty[grid].any())
+			{
+				const bitboard_t fields{ m_dirty[grid] };
+				m_dirty[grid] = {};
+				std::uint32_t units{ 0u };
+				for (bitboard_t rest{ fields }; rest.any(); rest.popFirst())
+				{
+					const std::size_t field{ rest.first() };
+					for (auto unit : m_graph.getUnitsOf(field))
+						units |= 1u << unit;
+					const std::uint16_t candidates{ m_candidates[cells[field]] };
+					if (std::has_single_bit(candidates))
+						for (auto peer : m_graph.getPeers(field))
+							if (!eliminate(cells[peer], candidates))
+								return false;
+				}
+				for (; units != 0u; units &= units - 1u)
+				{
+					const auto unit{ m_graph.getUnit(static_cast<std::size_t>(std::countr_zero(units))) };
+					std::uint16_t once{ 0u }, twice{ 0u }, placed{ 0u };
+					for (auto field : unit)
+					{
+						const std::uint16_t candidates{ m_candidates[cells[field]] };
+						twice |= once & candidates;
+						once |= candidates;
+						placed |= std::has_single_bit(candidates) ? candidates : 0u;
+					}
+					if (once != 0x1FFu)
+						return false;
+					const std::uint16_t hidden{ static_cast<std::uint16_t>(once & ~twice & ~placed) };
+					if (hidden != 0u)
+						for (auto field : unit)
+						{
+							const std::uint16_t found{ static_cast<std::uint16_t>(m_candidates[cells[field]] & hidden) };
+							if (found != 0u && (!std::has_single_bit(found) || !assign(cells[field], found)))
+								return false;
+						}
+				}
+				if (!m_dirty[grid].any() && !propagateIntersections(grid))
+					return false;
+			}
+			return true;
+		}
+
+		/// @brief Propagates grids from the worklist until it's empty
+		/// @returns false if contradiction was found, the worklist is cleared then
+		bool propagate()
+		{
+			while (!m_worklist.empty())
+			{
+				const std::size_t grid{ m_worklist.front() };
+				m_worklist.pop_front();
+				m_statistics.grid_propagations++;
+				const bool consistent{ propagateGrid(grid) };
+				m_queued[grid] = 0u;
+				if (!consistent)
+				{
+					for (auto waiting : m_worklist)
+						m_queued[waiting] = 0u;
+					m_worklist.clear();
+					for (auto& dirty : m_dirty)
+						dirty = {};
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/// @brief Recursive part of the search, `m_candidates` is propagated when called
+		void search(std::size_t depth)
+		{
+			if (!m_tracker->step())
+				return;
+			m_statistics.nodes++;
+			std::size_t best_cell{ m_candidates.size() };
+			int best_count{ 10 };
+			for (std::size_t cell{ 0u }; cell < m_candidates.size(); cell++)
+			{
+				const int count{ std::popcount(m_candidates[cell]) };
+				if (count > 1 && (count < best_count || (count == best_count && m_layout->getOccurrences(cell).size() > m_layout->getOccurrences(best_cell).size())))
+				{
+					best_cell = cell;
+					best_count = count;
+				}
+			}
+			if (best_cell == m_candidates.size())
+			{
+				if (m_found++ == 0u)
+					m_solution = m_candidates;
+				return;
+			}
+
+			if (m_saved.size() <= depth)
+				m_saved.emplace_back();
+			m_saved[depth] = m_candidates;
+			for (std::uint16_t remaining{ m_candidates[best_cell] }; remaining != 0u && m_found < m_limit && !m_tracker->isExhausted(); remaining &= remaining - 1u)
+			{
+				if (assign(best_cell, static_cast<std::uint16_t>(remaining & -remaining)) && propagate())
+					search(depth + 1u);
+				m_candidates = m_saved[depth];
+			}
+		}
+
+		/// @brief Runs search from propagated givens
+		/// @returns reason of stop of the search
+		solve_status_t run(const solve_budget_t& budget, std::size_t limit)
+		{
+			m_found = 0u;
+			if (!m_initial)
+				return solve_status_t::UNSAT;
+			SolveBudgetTracker_t tracker{ budget };
+			m_tracker = &tracker;
+			m_limit = limit;
+			m_candidates = *m_initial;
+			search(0u);
+			m_tracker = nullptr;
+			return m_found > 0u ? solve_status_t::SOLVED : tracker.isExhausted() ? tracker.getStopReason() : solve_status_t::UNSAT;
+		}
+
+		/// @returns grids with values of cells which have single candidate
+		std::vector<Board_t> toGrids(const candidates_t& candidates) const
+		{
+			std::vector<Board_t> grids;
+			for (std::size_t grid{ 0u }; grid < m_layout->getGridCount(); grid++)
+			{
+				const auto cells{ m_layout->getCellsOf(grid) };
+				grids.emplace_back(9u, 9u);
+				for (std::size_t field{ 0u }; field < MultiGridLayout_t::grid_fields; field++)
+				{
+					const std::uint16_t bits{ candidates[cells[field]] };
+					grids.back()[bitboard_t::positionOf(field)] = std::has_single_bit(bits) ? static_cast<value_t>(std::countr_zero(bits) + 1) : static_cast<value_t>(0u);
+				}
+			}
+			return grids;
+		}
+
+	public:
+		/// @brief Converts line of text into grids: 81 fields of every grid one after another, as in `SolvingPipeline_t::parseLine()`.
+		/// Fields shared by grids appear in every one of them.
+		/// @param line input line
+		/// @param layout placement of the grids
+		/// @returns grids, empty if line doesn't contain exactly 81 fields per grid
+		static std::vector<Board_t> parseLine(const std::string& line, const MultiGridLayout_t& layout)
+		{
+			std::vector<Board_t> grids(layout.getGridCount(), Board_t(9u, 9u));
+			std::size_t index{ 0u };
+			for (char c : line)
+			{
+				if (c == ' ' || c == '\t' || c == '\r')
+					continue;
+				if (index == grids.size() * MultiGridLayout_t::grid_fields || !((c >= '0' && c <= '9') || c == '.'))
+					return {};
+				grids[index / MultiGridLayout_t::grid_fields][bitboard_t::positionOf(index % MultiGridLayout_t::grid_fields)] = c == '.' ? static_cast<value_t>(0u) : static_cast<value_t>(c - '0');
+				index++;
+			}
+			if (index != grids.size() * MultiGridLayout_t::grid_fields)
+				return {};
+			return grids;
+		}
+
+		/// @param layout placement of the grids
+		/// @param grids givens of every grid (0 for empty field), shared fields given differently by two grids make the puzzle unsolvable
+		/// @throws std::invalid_argument if number of grids doesn't match the layout or a grid isn't 9x9
+		MultiGridSolver_t(std::shared_ptr<const MultiGridLayout_t> layout, const std::vector<Board_t>& grids)
+			: m_layout{ std::move(layout) }, m_graph{ *ConstraintGraph_t::classic() }, m_candidates(m_layout->getCellCount(), 0x1FFu),
+			m_dirty(m_layout->getGridCount()), m_queued(m_layout->getGridCount(), 0u)
+		{
+			if (grids.size() != m_layout->getGridCount())
+				throw std::invalid_argument("layout has " + std::to_string(m_layout->getGridCount()) + " grids, got " + std::to_string(grids.size()));
+			bool consistent{ true };
+			for (std::size_t grid{ 0u }; grid < grids.size(); grid++)
+			{
+				if (grids[grid].getSize() != size_2d_t{ 9u, 9u })
+					throw std::invalid_argument("every grid has to be 9x9");
+				const auto cells{ m_layout->getCellsOf(grid) };
+				for (std::size_t field{ 0u }; field < MultiGridLayout_t::grid_fields; field++)
+				{
+					const auto value{ grids[grid][bitboard_t::positionOf(field)] };
+					if (value == static_cast<value_t>(0u))
+						continue;
+					consistent = consistent && value > static_cast<value_t>(0u) && value <= static_cast<value_t>(9u) && assign(cells[field], static_cast<std::uint16_t>(1u << (value - 1)));
+				}
+			}
+			for (std::size_t grid{ 0u }; grid < grids.size(); grid++) // rows, columns and boxes without givens still need hidden singles
+				if (!m_queued[grid])
+				{
+					m_queued[grid] = 1u;
+					m_worklist.push_back(grid);
+				}
+			m_dirty.assign(m_layout->getGridCount(), ~bitboard_t{});
+			if (consistent && propagate())
+				m_initial = m_candidates;
+		}
+
+		/// @brief Solves the puzzle
+		/// @param budget limits of the search
+		/// @returns status, grids (solution, or propagated givens if no solution was found) and number of visited nodes
+		multigrid_result_t<value_t> getSolved(const solve_budget_t& budget = {})
+		{
+			const std::size_t nodes{ m_statistics.nodes };
+			const solve_status_t status{ run(budget, 1u) };
+			return { status, status == solve_status_t::SOLVED ? toGrids(m_solution) : toGrids(m_initial ? *m_initial : m_candidates), m_statistics.nodes - nodes };
+		}
+
+		/// @brief Counts solutions, stopping as soon as `limit` solutions were found
+		/// @param limit maximal number of solutions to look for, 2 is enough to check uniqueness
+		/// @returns number of found solutions (at most `limit`), 0 if the puzzle is contradictory
+		std::size_t countSolutions(std::size_t limit = 2u)
+		{
+			run({}, limit);
+			return m_found;
+		}
+
+		/// @returns counters since construction
+		inline const multigrid_statistics_t& getStatistics() const { return m_statistics; }
+	};
+}
@@ -0,0 +1,276 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Types.h"
+#include "Board.h"
+#include "SolutionCounter.h"
+#include "SmartCleaner.h"
+#include "FillSubboardsStrategy.h"
+#include "TheOnlyPossibilityStrategy.h"
+#include "Vector2DUtils.h"
+
+namespace malcolm
+{
+	/// @brief Difficulty of puzzle, given by the hardest deduction needed to solve it
+	enum class difficulty_t : std::uint8_t
+	{
+		/// solvable with `TheOnlyPossibilityStrategy_t` only
+		NAKED_SINGLE,
+		/// needs `FillSubboardsStrategy_t`
+		HIDDEN_SINGLE,
+		/// needs eliminations done by `SmartCleaner_t`
+		LOCKED_CANDIDATES,
+		/// can't be solved without guessing
+		GUESSING
+	};
+
+	/// @returns name of difficulty level as used on command line
+	inline const char* toString(difficulty_t difficulty)
+	{
+		switch (difficulty)
+		{
+		case difficulty_t::NAKED_SINGLE: return "naked";
+		case difficulty_t::HIDDEN_SINGLE: return "hidden";
+		case difficulty_t::LOCKED_CANDIDATES: return "locked";
+		default: return "guess";
+		}
+	}
+
+	/// @brief Grades puzzles by solving them with deduction strategies only, always preferring the simplest strategy that makes progress
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class DifficultyGrader_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+	private:
+		/// @brief strategies in order of increasing difficulty
+		TheOnlyPossibilityStrategy_t<value_t> m_naked_single;
+		FillSubboardsStrategy_t<value_t> m_hidden_single;
+		SmartCleaner_t<value_t> m_cleaner;
+
+		/// @brief erases value from possibilities of all fields sharing row, column or subboard with inserted field
+		static void postprocessInsertion(PossibilitiesBoard_t<value_t>& possibilities, const field_t<value_t>& field)
+		{
+			auto [pos, value] = field;
+			for (auto i{ 0u }; i < 9u; i++)
+			{
+				possibilities[{ pos.first, static_cast<size_t>(i) }].erase(value);
+				possibilities[{ static_cast<size_t>(i), pos.second }].erase(value);
+			}
+			auto local_center_position{ utils::vector2d::getLocalCenter(pos) };
+			for (auto i{ -1 }; i < 2; i++)
+				for (auto j{ -1 }; j < 2; j++)
+					possibilities[{ static_cast<size_t>(local_center_position.first + j), static_cast<size_t>(local_center_position.second + i) }].erase(value);
+			possibilities[pos].clear();
+		}
+
+		/// @returns number of all candidates left in possibilities board
+		static std::size_t candidatesCount(const PossibilitiesBoard_t<value_t>& possibilities)
+		{
+			std::size_t result{ 0u };
+			for (const auto& column : possibilities.getRawBoardConstReference())
+				for (const auto& candidates : column)
+					result += candidates.size();
+			return result;
+		}
+
+	public:
+		/// @param board puzzle to be graded, expected to have unique solution
+		/// @param limit grading stops as soon as it's known that puzzle is harder than `limit`
+		/// @returns the hardest strategy needed to fill the board (or any level above `limit`)
+		difficulty_t grade(Board_t<value_t> board, difficulty_t limit = difficulty_t::GUESSING)
+		{
+			PossibilitiesBoard_t<value_t> possibilities(board_t<value_container_t<value_t>>(9u, column_t<value_container_t<value_t>>(9u)));
+			for (auto x{ 0u }; x < 9u; x++)
+				for (auto y{ 0u }; y < 9u; y++)
+					if (board[{ static_cast<size_t>(x), static_cast<size_t>(y) }] == static_cast<value_t>(0u))
+						possibilities[{ static_cast<size_t>(x), static_cast<size_t>(y) }] = { 1,2,3,4,5,6,7,8,9 };
+			for (auto x{ 0u }; x < 9u; x++)
+				for (auto y{ 0u }; y < 9u; y++)
+				{
+					value_t value{ board[{ static_cast<size_t>(x), static_cast<size_t>(y) }] };
+					if (value != static_cast<value_t>(0u))
+						postprocessInsertion(possibilities, { { static_cast<size_t>(x), static_cast<size_t>(y) }, value });
+				}
+
+			difficulty_t hardest{ difficulty_t::NAKED_SINGLE };
+			std::size_t empty_fields{ board.count(static_cast<value_t>(0u)) };
+			while (empty_fields > 0u)
+			{
+				field_t<value_t> field{ m_naked_single.retrieveNextMove(possibilities, board) };
+				if (field.second == static_cast<value_t>(0u) && limit >= difficulty_t::HIDDEN_SINGLE)
+				{
+					field = m_hidden_single.retrieveNextMove(possibilities, board);
+					if (field.second != static_cast<value_t>(0u))
+						hardest = std::max(hardest, difficulty_t::HIDDEN_SINGLE);
+				}
+				if (field.second != static_cast<value_t>(0u))
+				{
+					board[field.first] = field.second;
+					postprocessInsertion(possibilities, field);
+					empty_fields--;
+					continue;
+				}
+
+				if (limit < difficulty_t::LOCKED_CANDIDATES)
+					return difficulty_t::GUESSING;
+				std::size_t before{ candidatesCount(possibilities) };
+				for (value_t goal{ 1 }; goal <= static_cast<value_t>(9); goal++)
+					m_cleaner.smartclean(board, possibilities, goal);
+				if (candidatesCount(possibilities) == before)
+					return difficulty_t::GUESSING;
+				hardest = std::max(hardest, difficulty_t::LOCKED_CANDIDATES);
+			}
+			return hardest;
+		}
+	};
+
+	/// @brief Generates random puzzles with unique solution and requested difficulty.
+	/// @li Output depends only on seed and index of puzzle, so results are the same for any number of threads.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class PuzzleGenerator_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Flat representation of board, see `SolutionCounter_t`
+		using cells_t = SolutionCounter_t::cells_t;
+
+	public:
+		/// @brief Generated puzzle together with its grade
+		struct puzzle_t
+		{
+			Board_t<value_t> puzzle;
+			Board_t<value_t> solution;
+			difficulty_t difficulty;
+		};
+
+	private:
+		/// @brief seed given in constructor
+		std::uint64_t m_seed;
+
+		/// @brief Mixes seed with puzzle index (splitmix64 finalizer)
+		static std::uint64_t mix(std::uint64_t value)
+		{
+			value += 0x9E3779B97F4A7C15ull;
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+			return value ^ (value >> 31);
+		}
+
+		/// @brief Fills board with random valid grid using randomised backtracking
+		static bool fill(cells_t& cells, std::array<std::uint16_t, 27>& used, std::size_t index, std::mt19937_64& random)
+		{
+			if (index == 81u)
+				return true;
+			const std::size_t row{ index / 9u }, column{ 9u + index % 9u }, subboard{ 18u + (index / 27u) * 3u + (index % 9u) / 3u };
+			std::array<std::uint8_t, 9> values{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+			std::shuffle(values.begin(), values.end(), random);
+			for (auto value : values)
+			{
+				std::uint16_t bit{ static_cast<std::uint16_t>(1u << (value - 1u)) };
+				if ((used[row] | used[column] | used[subboard]) & bit)
+					continue;
+				cells[index] = value;
+				used[row] ^= bit; used[column] ^= bit; used[subboard] ^= bit;
+				if (fill(cells, used, index + 1u, random))
+					return true;
+				used[row] ^= bit; used[column] ^= bit; used[subboard] ^= bit;
+			}
+			cells[index] = 0u;
+			return false;
+		}
+
+	public:
+		/// @param seed base seed, every puzzle is generated from its own generator seeded with (seed, index)
+		explicit PuzzleGenerator_t(std::uint64_t seed)
+			: m_seed{ seed }
+		{
+		}
+
+		/// @brief Generates single puzzle
+		/// @param index number of puzzle in sequence generated from the seed
+		/// @param target requested difficulty
+		/// @param max_attempts number of random grids tried before returning the closest result
+		/// @returns puzzle with unique solution; its difficulty is equal to `target` unless all attempts failed
+		puzzle_t generate(std::size_t index, difficulty_t target, std::size_t max_attempts = 64u) const
+		{
+			std::mt19937_64 random{ mix(m_seed ^ mix(index)) };
+			SolutionCounter_t counter;
+			DifficultyGrader_t<value_t> grader;
+			puzzle_t result{ Board_t<value_t>(), Board_t<value_t>(), difficulty_t::GUESSING };
+			for (std::size_t attempt{ 0u }; attempt < max_attempts; attempt++)
+			{
+				cells_t solution{};
+				std::array<std::uint16_t, 27> used{};
+				fill(solution, used, 0u, random);
+
+				// remove clues in random order as long as solution stays unique and puzzle isn't harder than requested
+				cells_t puzzle{ solution };
+				std::array<std::uint8_t, 81> order;
+				std::iota(order.begin(), order.end(), std::uint8_t{ 0u });
+				std::shuffle(order.begin(), order.end(), random);
+				difficulty_t difficulty{ difficulty_t::NAKED_SINGLE };
+				for (auto index_to_clear : order)
+				{
+					std::uint8_t clue{ puzzle[index_to_clear] };
+					puzzle[index_to_clear] = 0u;
+					if (counter.count(puzzle, 2u) != 1u)
+					{
+						puzzle[index_to_clear] = clue;
+						continue;
+					}
+					if (target == difficulty_t::GUESSING)
+						continue;
+					difficulty_t candidate{ grader.grade(SolutionCounter_t::toBoard<value_t>(puzzle), target) };
+					if (candidate > target)
+						puzzle[index_to_clear] = clue;
+					else
+						difficulty = candidate;
+				}
+				if (target == difficulty_t::GUESSING)
+					difficulty = grader.grade(SolutionCounter_t::toBoard<value_t>(puzzle));
+
+				result = { SolutionCounter_t::toBoard<value_t>(puzzle), SolutionCounter_t::toBoard<value_t>(solution), difficulty };
+				if (difficulty == target)
+					break;
+			}
+			return result;
+		}
+
+		/// @brief Generates `count` puzzles on `threads` threads
+		/// @param count number of puzzles
+		/// @param target requested difficulty
+		/// @param threads number of worker threads
+		/// @returns puzzles ordered by index, i.e. the same for any number of threads
+		std::vector<puzzle_t> generateBatch(std::size_t count, difficulty_t target, std::size_t threads) const
+		{
+			std::vector<puzzle_t> result(count, { Board_t<value_t>(), Board_t<value_t>(), difficulty_t::GUESSING });
+			std::atomic<std::size_t> next{ 0u };
+			std::vector<std::thread> workers;
+			for (std::size_t i{ 0u }; i < std::max<std::size_t>(1u, threads); i++)
+				workers.emplace_back([&]()
+					{
+						for (std::size_t index{ next++ }; index < count; index = next++)
+							result[index] = generate(index, target);
+					});
+			for (auto& worker : workers)
+				worker.join();
+			return result;
+		}
+	};
+}
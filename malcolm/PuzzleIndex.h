@@ -0,0 +1,431 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Board.h"
+#include "Checksum.h"
+
+namespace malcolm
+{
+	/// @brief What `PuzzleIndex_t` knows about a puzzle
+	enum class index_status_t : std::uint8_t
+	{
+		/// puzzle has exactly one solution, which is stored
+		SOLVED = 1,
+		/// puzzle has no solution
+		UNSOLVABLE = 2,
+		/// puzzle has more than one solution, one of them is stored
+		NOT_UNIQUE = 3
+	};
+
+	/// @returns name of index status
+	inline const char* toString(index_status_t status)
+	{
+		switch (status)
+		{
+		case index_status_t::SOLVED: return "solved";
+		case index_status_t::UNSOLVABLE: return "unsolvable";
+		default: return "not_unique";
+		}
+	}
+
+#ifndef _WIN32
+	/// @brief Persistent hash index of solved 9x9 puzzles in a memory-mapped file, shared by many processes and by runs on different days.
+	/// @li File: 4096-byte header followed by power-of-two number of 128-byte slots (open addressing, linear probing). Slot holds
+	/// tag (64-bit hash of the puzzle, 0 for empty slot), status, puzzle and solution (both `board_encoding_t::NIBBLE_PACKED`)
+	/// and checksum of them. Lookup touches single slot in the common case and decodes solution without allocations.
+	/// @li Readers don't lock anything: tag is published last with release ordering, so a slot with tag is complete for readers
+	/// of the same mapping, and records whose checksum doesn't match (torn by a crash) are ignored.
+	/// @li Writers are serialized with `flock()` on the file and only append: records are never changed nor removed.
+	/// `commit()` flushes slots first and the header last, so after a crash the file holds every committed record
+	/// and at most some ignored torn ones.
+	/// @li When the table gets 3/4 full, writer rebuilds it twice as large into a temporary file and atomically renames it over
+	/// the old one. Other processes keep reading their old mapping until `refresh()`, writers notice the new file when locking.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class PuzzleIndex_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+		/// Board packed by `BoardCodec_t::packNibbles()`
+		using packed_t = std::array<std::uint8_t, 41>;
+
+		/// @brief Single record of the table, aligned so it never crosses a page
+		struct alignas(128) slot_t
+		{
+			/// hash of the puzzle with the lowest bit set, 0 for empty slot; published last
+			std::uint64_t tag;
+			/// checksum of status, puzzle and solution
+			std::uint32_t check;
+			/// `index_status_t`
+			std::uint8_t status;
+			std::array<std::uint8_t, 3> reserved;
+			packed_t puzzle;
+			/// zeros if puzzle has no solution
+			packed_t solution;
+		};
+		static_assert(sizeof(slot_t) == 128u);
+
+		/// number of bytes protected by `slot_t::check`, starting at `slot_t::status`
+		static constexpr std::size_t s_checked_size{ offsetof(slot_t, solution) + sizeof(packed_t) - offsetof(slot_t, status) };
+
+		/// @brief First page of the file
+		struct header_t
+		{
+			/// `s_magic`
+			std::array<char, 8> magic;
+			/// `slot_t` size, guards against files of other layout
+			std::uint32_t slot_size;
+			std::uint32_t reserved;
+			/// number of slots, power of two
+			std::uint64_t capacity;
+			/// number of occupied slots
+			std::uint64_t used;
+			/// number of occupied slots at the last commit
+			std::uint64_t committed;
+		};
+
+		/// @brief Memory mapping of single version of the file. Replaced mappings are kept until destruction of the index,
+		/// so lock-free readers of this process never touch unmapped memory.
+		struct mapping_t
+		{
+			int fd{ -1 };
+			void* address{ nullptr };
+			std::size_t size{ 0u };
+			header_t* header{ nullptr };
+			slot_t* slots{ nullptr };
+			std::uint64_t mask{ 0u };
+
+			~mapping_t()
+			{
+				if (address != nullptr)
+					::munmap(address, size);
+				if (fd >= 0)
+					::close(fd);
+			}
+		};
+
+		/// @brief Holds `flock()` of the current file for the lifetime of the object
+		class file_lock_t
+		{
+			int m_fd;
+		public:
+			explicit file_lock_t(int fd) : m_fd{ fd } { ::flock(m_fd, LOCK_EX); }
+			~file_lock_t() { ::flock(m_fd, LOCK_UN); }
+			file_lock_t(const file_lock_t&) = delete;
+			file_lock_t& operator=(const file_lock_t&) = delete;
+		};
+
+		static constexpr std::array<char, 8> s_magic{ 'M', 'L', 'C', 'I', 'D', 'X', '0', '1' };
+		static constexpr std::size_t s_header_size{ 4096u };
+		/// seed of slot checksum, so it differs from the tag
+		static constexpr std::uint64_t s_magic_seed{ 0x4D4C4349445830ull };
+
+	private:
+		/// @brief path of the file
+		std::string m_path;
+
+		/// @brief true if records can be added
+		bool m_writable;
+
+		/// @brief current mapping, read without locking
+		std::atomic<mapping_t*> m_current{ nullptr };
+
+		/// @brief all mappings created so far, the current one included
+		std::vector<std::unique_ptr<mapping_t>> m_mappings;
+
+		/// @brief serializes writers and remapping within the process, `flock()` does it between processes
+		std::mutex m_write_mutex;
+
+		/// @brief counters of this process
+		std::atomic<std::size_t> m_hits{ 0u }, m_misses{ 0u }, m_inserted{ 0u };
+
+		/// @returns 9x9 board packed like `BoardCodec_t::packNibbles()` does. Fields are gathered column by column (raw board
+		/// is indexed by x first) into flat array and packed in second pass, which keeps both loops free of read-modify-write chains.
+		static packed_t pack(const Board_t& board)
+		{
+			std::array<std::uint8_t, 82u> cells{};
+			const auto& raw{ board.getRawBoardConstReference() };
+			for (std::size_t x{ 0u }; x < 9u; x++)
+				for (std::size_t y{ 0u }; y < 9u; y++)
+					cells[9u * y + x] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(raw[x][y]) & 0x0Fu);
+			packed_t packed;
+			for (std::size_t i{ 0u }; i < packed.size(); i++)
+				packed[i] = static_cast<std::uint8_t>(cells[2u * i] | (cells[2u * i + 1u] << 4));
+			return packed;
+		}
+
+		/// @brief Reverse operation for `pack()`
+		/// @param board 9x9 board to be overwritten
+		static void unpack(const packed_t& packed, Board_t& board)
+		{
+			std::array<std::uint8_t, 82u> cells;
+			for (std::size_t i{ 0u }; i < packed.size(); i++)
+			{
+				cells[2u * i] = packed[i] & 0x0Fu;
+				cells[2u * i + 1u] = packed[i] >> 4;
+			}
+			auto& raw{ board.getRawBoardRef() };
+			for (std::size_t x{ 0u }; x < 9u; x++)
+				for (std::size_t y{ 0u }; y < 9u; y++)
+					raw[x][y] = static_cast<value_t>(cells[9u * y + x]);
+		}
+
+		/// @returns tag of packed puzzle, with the lowest bit set so it's never 0
+		static std::uint64_t tagOf(const packed_t& key) { return utils::checksum::hash64(key.data(), key.size()) | 1u; }
+
+		/// @returns checksum protecting content of the slot
+		static std::uint32_t checksumOf(const slot_t& slot) { return static_cast<std::uint32_t>(utils::checksum::hash64(&slot.status, s_checked_size, s_magic_seed)); }
+
+		/// @returns tag of the slot, loaded with acquire ordering
+		static std::uint64_t loadTag(slot_t& slot) { return std::atomic_ref<std::uint64_t>(slot.tag).load(std::memory_order_acquire); }
+
+		/// @brief Maps file at given path
+		/// @throws std::runtime_error if file can't be opened or has other layout
+		static std::unique_ptr<mapping_t> map(const std::string& path, bool writable, std::uint64_t capacity)
+		{
+			auto mapping{ std::make_unique<mapping_t>() };
+			mapping->fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+			if (mapping->fd < 0)
+				throw std::runtime_error("can't open puzzle index " + path);
+			if (writable)
+			{
+				file_lock_t lock{ mapping->fd };
+				struct stat status {};
+				::fstat(mapping->fd, &status);
+				if (status.st_size == 0)
+					initialize(mapping->fd, capacity);
+			}
+			struct stat status {};
+			::fstat(mapping->fd, &status);
+			header_t header{};
+			if (static_cast<std::size_t>(status.st_size) < s_header_size || ::pread(mapping->fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+				|| header.magic != s_magic || header.slot_size != sizeof(slot_t) || header.capacity == 0u || (header.capacity & (header.capacity - 1u)) != 0u
+				|| static_cast<std::uint64_t>(status.st_size) < s_header_size + header.capacity * sizeof(slot_t))
+				throw std::runtime_error("file " + path + " isn't a puzzle index");
+			mapping->size = s_header_size + header.capacity * sizeof(slot_t);
+			mapping->address = ::mmap(nullptr, mapping->size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, mapping->fd, 0);
+			if (mapping->address == MAP_FAILED)
+			{
+				mapping->address = nullptr;
+				throw std::runtime_error("can't map puzzle index " + path);
+			}
+			mapping->header = static_cast<header_t*>(mapping->address);
+			mapping->slots = reinterpret_cast<slot_t*>(static_cast<std::uint8_t*>(mapping->address) + s_header_size);
+			mapping->mask = header.capacity - 1u;
+			return mapping;
+		}
+
+		/// @brief Writes empty table of given capacity into empty file
+		static void initialize(int fd, std::uint64_t capacity)
+		{
+			std::uint64_t slots{ 1024u };
+			while (slots < capacity)
+				slots <<= 1u;
+			if (::ftruncate(fd, static_cast<off_t>(s_header_size + slots * sizeof(slot_t))) != 0)
+				throw std::runtime_error("can't allocate puzzle index");
+			header_t header{ s_magic, static_cast<std::uint32_t>(sizeof(slot_t)), 0u, slots, 0u, 0u };
+			if (::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || ::fsync(fd) != 0)
+				throw std::runtime_error("can't initialize puzzle index");
+		}
+
+		/// @returns true if the path still names the file of given mapping (it wasn't replaced by a rebuild)
+		bool isCurrent(const mapping_t& mapping) const
+		{
+			struct stat mapped {}, named {};
+			return ::fstat(mapping.fd, &mapped) == 0 && ::stat(m_path.c_str(), &named) == 0 && mapped.st_ino == named.st_ino && mapped.st_dev == named.st_dev;
+		}
+
+		/// @brief Stores copy of slot into the first free slot of its probe sequence, without publishing order guarantees
+		/// (used only for tables nobody reads yet)
+		static void place(mapping_t& mapping, const slot_t& slot)
+		{
+			for (std::uint64_t position{ slot.tag >> 16 };; position++)
+			{
+				slot_t& target{ mapping.slots[position & mapping.mask] };
+				if (target.tag == 0u)
+				{
+					target = slot;
+					return;
+				}
+			}
+		}
+
+		/// @brief Rebuilds the table twice as large into a temporary file and renames it over the current one. Called with both locks held.
+		void grow(mapping_t& mapping)
+		{
+			const std::string temporary{ m_path + ".tmp" };
+			::unlink(temporary.c_str());
+			auto larger{ map(temporary, true, 2u * (mapping.mask + 1u)) };
+			std::uint64_t used{ 0u };
+			for (std::uint64_t i{ 0u }; i <= mapping.mask; i++)
+			{
+				const slot_t& slot{ mapping.slots[i] };
+				if (loadTag(mapping.slots[i]) != 0u && checksumOf(slot) == slot.check)
+				{
+					place(*larger, slot);
+					used++;
+				}
+			}
+			larger->header->used = used;
+			larger->header->committed = used;
+			if (::msync(larger->address, larger->size, MS_SYNC) != 0 || ::rename(temporary.c_str(), m_path.c_str()) != 0)
+				throw std::runtime_error("can't grow puzzle index " + m_path);
+			m_mappings.push_back(std::move(larger));
+			m_current.store(m_mappings.back().get(), std::memory_order_release);
+		}
+
+	public:
+		/// @param path file of the index, created if it doesn't exist
+		/// @param writable false to open the index for lookups only
+		/// @param capacity initial number of slots of newly created file
+		/// @throws std::runtime_error if file can't be opened or isn't a puzzle index
+		PuzzleIndex_t(std::string path, bool writable = true, std::uint64_t capacity = 1u << 16)
+			: m_path{ std::move(path) }, m_writable{ writable }
+		{
+			m_mappings.push_back(map(m_path, m_writable, capacity));
+			m_current.store(m_mappings.back().get());
+		}
+
+		PuzzleIndex_t(const PuzzleIndex_t&) = delete;
+		PuzzleIndex_t& operator=(const PuzzleIndex_t&) = delete;
+
+		/// @brief Looks the puzzle up, safe to call from many threads and concurrently with `insert()`
+		/// @param puzzle 9x9 board
+		/// @param solution 9x9 board receiving stored solution, or copy of the puzzle if it has none; unchanged if puzzle isn't indexed
+		/// @returns status of the puzzle, std::nullopt if it isn't indexed
+		std::optional<index_status_t> lookup(const Board_t& puzzle, Board_t& solution)
+		{
+			const packed_t key{ pack(puzzle) };
+			const std::uint64_t tag{ tagOf(key) };
+			mapping_t& mapping{ *m_current.load(std::memory_order_acquire) };
+			for (std::uint64_t position{ tag >> 16 }, probes{ 0u }; probes <= mapping.mask; position++, probes++)
+			{
+				slot_t& slot{ mapping.slots[position & mapping.mask] };
+				const std::uint64_t slot_tag{ loadTag(slot) };
+				if (slot_tag == 0u)
+					break;
+				if (slot_tag != tag || slot.puzzle != key || checksumOf(slot) != slot.check)
+					continue;
+				m_hits.fetch_add(1u, std::memory_order_relaxed);
+				const auto status{ static_cast<index_status_t>(slot.status) };
+				unpack(status == index_status_t::UNSOLVABLE ? slot.puzzle : slot.solution, solution);
+				return status;
+			}
+			m_misses.fetch_add(1u, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+
+		/// @brief Appends record of the puzzle, visible to readers immediately and durable after `commit()`
+		/// @param puzzle 9x9 board
+		/// @param solution 9x9 filled board for `SOLVED` and `NOT_UNIQUE`, ignored for `UNSOLVABLE`
+		/// @returns false if index is read-only or puzzle is already indexed
+		bool insert(const Board_t& puzzle, index_status_t status, const Board_t& solution)
+		{
+			if (!m_writable)
+				return false;
+			slot_t record{};
+			record.puzzle = pack(puzzle);
+			record.tag = tagOf(record.puzzle);
+			record.status = static_cast<std::uint8_t>(status);
+			if (status != index_status_t::UNSOLVABLE)
+				record.solution = pack(solution);
+			record.check = checksumOf(record);
+
+			std::lock_guard<std::mutex> guard{ m_write_mutex };
+			mapping_t* mapping{ m_current.load(std::memory_order_acquire) };
+			while (true) // another process may have rebuilt the file before we got its lock
+			{
+				file_lock_t lock{ mapping->fd };
+				if (!isCurrent(*mapping))
+				{
+					m_mappings.push_back(map(m_path, true, 0u));
+					mapping = m_mappings.back().get();
+					m_current.store(mapping, std::memory_order_release);
+					continue;
+				}
+				if (4u * (mapping->header->used + 1u) > 3u * (mapping->mask + 1u))
+				{
+					grow(*mapping);
+					mapping = m_current.load(std::memory_order_acquire);
+					continue;
+				}
+				for (std::uint64_t position{ record.tag >> 16 };; position++)
+				{
+					slot_t& slot{ mapping->slots[position & mapping->mask] };
+					const std::uint64_t slot_tag{ loadTag(slot) };
+					if (slot_tag == record.tag && slot.puzzle == record.puzzle && checksumOf(slot) == slot.check)
+						return false;
+					if (slot_tag != 0u)
+						continue;
+					std::memcpy(reinterpret_cast<std::uint8_t*>(&slot) + sizeof(record.tag), reinterpret_cast<const std::uint8_t*>(&record) + sizeof(record.tag), sizeof(slot_t) - sizeof(record.tag));
+					std::atomic_ref<std::uint64_t>(slot.tag).store(record.tag, std::memory_order_release);
+					mapping->header->used++;
+					m_inserted.fetch_add(1u, std::memory_order_relaxed);
+					return true;
+				}
+			}
+		}
+
+		/// @brief Makes all inserted records durable: flushes slots, then the header with number of committed records
+		/// @returns false if flushing failed
+		bool commit()
+		{
+			if (!m_writable)
+				return true;
+			std::lock_guard<std::mutex> guard{ m_write_mutex };
+			mapping_t& mapping{ *m_current.load(std::memory_order_acquire) };
+			file_lock_t lock{ mapping.fd };
+			if (::msync(mapping.address, mapping.size, MS_SYNC) != 0)
+				return false;
+			mapping.header->committed = mapping.header->used;
+			return ::msync(mapping.address, s_header_size, MS_SYNC) == 0;
+		}
+
+		/// @brief Switches to the current file if it was rebuilt by another process
+		void refresh()
+		{
+			std::lock_guard<std::mutex> guard{ m_write_mutex };
+			if (!isCurrent(*m_current.load(std::memory_order_acquire)))
+			{
+				m_mappings.push_back(map(m_path, m_writable, 0u));
+				m_current.store(m_mappings.back().get(), std::memory_order_release);
+			}
+		}
+
+		/// @returns number of records in the file
+		inline std::uint64_t size() const { return m_current.load(std::memory_order_acquire)->header->used; }
+
+		/// @returns number of lookups which found the puzzle
+		inline std::size_t getHits() const { return m_hits.load(); }
+
+		/// @returns number of lookups which didn't find the puzzle
+		inline std::size_t getMisses() const { return m_misses.load(); }
+
+		/// @returns number of records inserted by this process
+		inline std::size_t getInserted() const { return m_inserted.load(); }
+	};
+#endif
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Board.h"
+#include "BoardSolver.h"
+#include "SatSolver.h"
+#include "ConstraintGraph.h"
+#include "SolveBudget.h"
+
+namespace malcolm
+{
+	/// @brief Solves square boards with square boxes of any size (9x9, 16x16, 25x25, ...) by encoding them for `SatSolver_t`,
+	/// for boards too big for copy-per-branch bruteforce of `BoardSolver_t`.
+	/// @li Variable (x, y, v) is true if and only if value v is at position (x, y). Every field and every value in every row, column
+	/// and box is "exactly one" cardinality constraint: one clause for "at least one" and pairwise binary clauses for "at most one".
+	/// @li 9x9 boards of other geometry are encoded from units of their `ConstraintGraph_t`, extra peers (e.g. anti-knight)
+	/// get binary clauses forbidding equal values.
+	/// @li Preprocessing removes values excluded by givens from clauses. On 9x9 boards deduction strategies of `BoardSolver_t`
+	/// run first, so SAT search starts from what they fill and eliminate.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class SatBoardSolver_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+	private:
+		/// @brief Constant reference to externally given board
+		const Board_t& m_board;
+
+		/// @brief number of fields in row, column and box
+		std::size_t m_side;
+
+		/// @brief width (and height) of box
+		std::size_t m_box;
+
+		/// @brief true if deduction strategies should run before search
+		bool m_preprocess;
+
+		/// @brief units and peers of 9x9 board, nullptr for square boxes
+		std::shared_ptr<const ConstraintGraph_t> m_graph;
+
+		/// @brief counters of the last search
+		sat_statistics_t m_statistics;
+
+		/// @returns variable saying that `value` is at position (x, y)
+		inline std::uint32_t variableOf(std::size_t x, std::size_t y, std::size_t value) const
+		{
+			return static_cast<std::uint32_t>((y * m_side + x) * m_side + value - 1u);
+		}
+
+		/// @returns value at position (x, y)
+		inline value_t at(const Board_t& board, std::size_t x, std::size_t y) const
+		{
+			return board[{ static_cast<size_t>(x), static_cast<size_t>(y) }];
+		}
+
+	public:
+		/// @param board board to be solved, square with side being square of box width
+		/// @param preprocess false to skip deduction strategies on 9x9 boards
+		/// @param graph units and peers of 9x9 board, nullptr for rows, columns and square boxes
+		/// @throws std::invalid_argument if board doesn't have proper size
+		SatBoardSolver_t(const Board_t& board, bool preprocess = true, std::shared_ptr<const ConstraintGraph_t> graph = nullptr)
+			: m_board{ board }, m_side{ board.getSize().first }, m_box{ 1u }, m_preprocess{ preprocess }, m_graph{ std::move(graph) }
+		{
+			while (m_box * m_box < m_side)
+				m_box++;
+			if (m_side == 0u || m_box * m_box != m_side || board.getSize().second != m_side)
+				throw std::invalid_argument("board must be square with side being square of box width");
+			if (m_graph && m_side != 9u)
+				throw std::invalid_argument("constraint graph describes 9x9 board only");
+		}
+
+		/// Encodes the board and searches for solution within given limits
+		/// @param budget deadline, node limit (one node per conflict) and cancel token of the search
+		/// @returns status of the solve, solved board (or the given one with deductions of preprocessing) and number of conflicts
+		solve_result_t<value_t> getSolved(const solve_budget_t& budget = {})
+		{
+			const std::size_t side{ m_side };
+			Board_t start{ m_board };
+			std::vector<std::uint8_t> candidates(side * side * side, 1u);
+			auto exclude = [&](std::size_t x, std::size_t y, std::size_t value) { candidates[variableOf(x, y, value)] = 0u; };
+
+			// before preprocessing, whose validator and possibilities accept values 0-9 only
+			for (std::size_t y{ 0u }; y < side; y++)
+				for (std::size_t x{ 0u }; x < side; x++)
+					if (const value_t given{ at(m_board, x, y) }; given < static_cast<value_t>(0) || static_cast<std::size_t>(given) > side)
+						return { solve_status_t::UNSAT, m_board, 0u };
+
+			if (m_preprocess && side == 9u)
+			{
+				auto deduced{ BoardSolver_t<value_t>(m_board, nullptr, nullptr, m_graph).getDeduced() };
+				if (!deduced)
+					return { solve_status_t::UNSAT, m_board, 0u };
+				start = std::move(deduced->first);
+				for (std::size_t y{ 0u }; y < side; y++)
+					for (std::size_t x{ 0u }; x < side; x++)
+						if (at(start, x, y) == static_cast<value_t>(0u))
+							for (std::size_t value{ 1u }; value <= side; value++)
+								if (deduced->second[{ static_cast<size_t>(x), static_cast<size_t>(y) }].count(static_cast<value_t>(value)) == 0u)
+									exclude(x, y, value);
+			}
+			for (std::size_t y{ 0u }; y < side; y++)
+				for (std::size_t x{ 0u }; x < side; x++)
+				{
+					const value_t given{ at(start, x, y) };
+					if (given == static_cast<value_t>(0u))
+						continue;
+					for (std::size_t value{ 1u }; value <= side; value++)
+						if (value != static_cast<std::size_t>(given))
+							exclude(x, y, value);
+					if (m_graph)
+					{
+						for (auto peer : m_graph->getPeers(9u * y + x))
+							exclude(peer % 9u, peer / 9u, static_cast<std::size_t>(given));
+						continue;
+					}
+					const std::size_t box_x{ x - x % m_box }, box_y{ y - y % m_box };
+					for (std::size_t i{ 0u }; i < side; i++)
+					{
+						if (i != x)
+							exclude(i, y, static_cast<std::size_t>(given));
+						if (i != y)
+							exclude(x, i, static_cast<std::size_t>(given));
+						const std::size_t peer_x{ box_x + i % m_box }, peer_y{ box_y + i / m_box };
+						if (peer_x != x || peer_y != y)
+							exclude(peer_x, peer_y, static_cast<std::size_t>(given));
+					}
+				}
+
+			SatSolver_t sat(candidates.size());
+			bool ok{ true };
+			for (std::uint32_t variable{ 0u }; variable < candidates.size(); variable++)
+				if (!candidates[variable])
+					ok = ok && sat.addClause({ makeLiteral(variable, true) });
+			std::vector<std::uint32_t> group;
+			auto exactlyOne = [&]()
+				{
+					std::vector<literal_t> at_least_one;
+					for (auto variable : group)
+						if (candidates[variable])
+							at_least_one.push_back(makeLiteral(variable));
+					ok = ok && sat.addClause(at_least_one);
+					for (std::size_t i{ 0u }; i < at_least_one.size(); i++)
+						for (std::size_t j{ i + 1u }; j < at_least_one.size(); j++)
+							ok = ok && sat.addClause({ negationOf(at_least_one[i]), negationOf(at_least_one[j]) });
+					group.clear();
+				};
+			if (m_graph)
+			{
+				for (std::size_t field{ 0u }; field < ConstraintGraph_t::field_count && ok; field++)
+				{
+					for (std::size_t value{ 1u }; value <= side; value++)
+						group.push_back(variableOf(field % 9u, field / 9u, value));
+					exactlyOne(); // field
+					for (auto peer : m_graph->getExtraPeers(field)) // extra peers, not covered by units
+						for (std::size_t value{ 1u }; value <= side && peer > field; value++)
+						{
+							const std::uint32_t first{ variableOf(field % 9u, field / 9u, value) }, second{ variableOf(peer % 9u, peer / 9u, value) };
+							if (candidates[first] && candidates[second])
+								ok = ok && sat.addClause({ makeLiteral(first, true), makeLiteral(second, true) });
+						}
+				}
+				for (std::size_t unit{ 0u }; unit < m_graph->getUnitCount() && ok; unit++)
+					for (std::size_t value{ 1u }; value <= side; value++)
+					{
+						for (auto field : m_graph->getUnit(unit))
+							group.push_back(variableOf(field % 9u, field / 9u, value));
+						exactlyOne(); // value in unit
+					}
+			}
+			for (std::size_t a{ 0u }; a < side && ok && !m_graph; a++)
+				for (std::size_t b{ 0u }; b < side && ok; b++)
+				{
+					for (std::size_t value{ 1u }; value <= side; value++)
+						group.push_back(variableOf(a, b, value));
+					exactlyOne(); // field (a, b)
+					for (std::size_t i{ 0u }; i < side; i++)
+						group.push_back(variableOf(i, a, b + 1u));
+					exactlyOne(); // value b + 1 in row a
+					for (std::size_t i{ 0u }; i < side; i++)
+						group.push_back(variableOf(a, i, b + 1u));
+					exactlyOne(); // value b + 1 in column a
+					for (std::size_t i{ 0u }; i < side; i++)
+						group.push_back(variableOf(a % m_box * m_box + i % m_box, a / m_box * m_box + i / m_box, b + 1u));
+					exactlyOne(); // value b + 1 in box a
+				}
+			if (!ok)
+				return { solve_status_t::UNSAT, start, 0u };
+
+			SolveBudgetTracker_t tracker{ budget };
+			const sat_result_t result{ sat.solve(&tracker) };
+			m_statistics = sat.getStatistics();
+			if (result == sat_result_t::UNSATISFIABLE)
+				return { solve_status_t::UNSAT, start, tracker.getNodes() };
+			if (result == sat_result_t::UNKNOWN)
+				return { tracker.getStopReason(), start, tracker.getNodes() };
+			for (std::size_t y{ 0u }; y < side; y++)
+				for (std::size_t x{ 0u }; x < side; x++)
+					for (std::size_t value{ 1u }; value <= side; value++)
+						if (sat.valueOfVariable(variableOf(x, y, value)))
+							start[{ static_cast<size_t>(x), static_cast<size_t>(y) }] = static_cast<value_t>(value);
+			return { solve_status_t::SOLVED, std::move(start), tracker.getNodes() };
+		}
+
+		/// @returns counters of the last search
+		inline const sat_statistics_t& getStatistics() const { return m_statistics; }
+	};
+}
@@ -0,0 +1,564 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "SolveBudget.h"
+
+namespace malcolm
+{
+	/// @brief Literal of `SatSolver_t`: 2 * variable for positive literal, 2 * variable + 1 for its negation
+	using literal_t = std::uint32_t;
+
+	/// @returns literal of given variable
+	inline constexpr literal_t makeLiteral(std::uint32_t variable, bool negated = false) { return 2u * variable + (negated ? 1u : 0u); }
+
+	/// @returns variable of given literal
+	inline constexpr std::uint32_t variableOf(literal_t literal) { return literal >> 1u; }
+
+	/// @returns negation of given literal
+	inline constexpr literal_t negationOf(literal_t literal) { return literal ^ 1u; }
+
+	/// @brief Outcome of `SatSolver_t::solve()`
+	enum class sat_result_t : std::uint8_t
+	{
+		SATISFIABLE,
+		UNSATISFIABLE,
+		/// budget was exhausted first
+		UNKNOWN
+	};
+
+	/// @brief Counters of `SatSolver_t`
+	struct sat_statistics_t
+	{
+		std::size_t decisions{ 0u };
+		std::size_t propagations{ 0u };
+		std::size_t conflicts{ 0u };
+		std::size_t restarts{ 0u };
+		std::size_t learnt_clauses{ 0u };
+		std::size_t deleted_clauses{ 0u };
+	};
+
+	/// @brief Self-contained CDCL SAT solver in the spirit of MiniSat.
+	/// @li Two watched literals with blockers; binary clauses live only in watch lists.
+	/// @li First-UIP clause learning with local minimization, VSIDS branching with phase saving, Luby restarts.
+	/// @li Learnt clauses are reduced by LBD (glucose style); deleted clauses stay in the arena and their watchers are dropped lazily.
+	/// @li Clauses are added only before `solve()`, which can be called once.
+	class SatSolver_t
+	{
+	private:
+		/// @brief Clause reference marking binary clause in watchers and reasons
+		static constexpr std::uint32_t binary_flag{ 1u << 31u };
+
+		/// @brief Reason of decisions and of assignments at level 0 coming from unit clauses
+		static constexpr std::uint32_t no_reason{ std::numeric_limits<std::uint32_t>::max() };
+
+		/// @brief Flag of learnt clause in the second header word, the rest of the word is its LBD
+		static constexpr std::uint32_t learnt_flag{ 1u << 31u };
+
+		/// @brief Flag of deleted clause in the second header word
+		static constexpr std::uint32_t deleted_flag{ 1u << 30u };
+
+		/// @brief Entry of watch list: clause (offset in arena or `binary_flag`) and literal whose truth satisfies the clause
+		struct watcher_t
+		{
+			std::uint32_t clause;
+			literal_t blocker;
+		};
+
+		/// @brief clauses: size, flags with LBD, literals; the first two literals are watched
+		std::vector<std::uint32_t> m_arena;
+
+		/// @brief watchers of clauses to be visited when given literal becomes false
+		std::vector<std::vector<watcher_t>> m_watches;
+
+		/// @brief assignment of every variable: 0 unassigned, 1 true, -1 false
+		std::vector<std::int8_t> m_assigns;
+
+		/// @brief saved phase of every variable, true if it was last assigned false
+		std::vector<bool> m_polarity;
+
+		/// @brief decision level of every assigned variable
+		std::vector<std::uint32_t> m_levels;
+
+		/// @brief reason of every assigned variable: clause offset, `binary_flag` with the other literal, or `no_reason`
+		std::vector<std::uint32_t> m_reasons;
+
+		/// @brief VSIDS activity of every variable
+		std::vector<double> m_activity;
+
+		/// @brief amount added to activity on bump, grows instead of decaying all activities
+		double m_increment{ 1.0 };
+
+		/// @brief max-heap of variables by activity
+		std::vector<std::uint32_t> m_heap;
+
+		/// @brief position of every variable in `m_heap`, -1 if not there
+		std::vector<std::int32_t> m_heap_positions;
+
+		/// @brief assigned literals in order of assignment
+		std::vector<literal_t> m_trail;
+
+		/// @brief size of trail at start of every decision level
+		std::vector<std::size_t> m_trail_limits;
+
+		/// @brief index of the first trail literal not propagated yet
+		std::size_t m_propagated{ 0u };
+
+		/// @brief offsets of learnt clauses
+		std::vector<std::uint32_t> m_learnts;
+
+		/// @brief marks used by conflict analysis
+		std::vector<std::uint8_t> m_seen;
+
+		/// @brief literals of the last conflicting clause
+		std::vector<literal_t> m_conflict;
+
+		/// @brief false as soon as clauses are known to be unsatisfiable
+		bool m_ok{ true };
+
+		/// @brief counters
+		sat_statistics_t m_statistics;
+
+		/// @returns value of literal: 1 true, -1 false, 0 unassigned
+		inline std::int8_t valueOf(literal_t literal) const
+		{
+			const std::int8_t value{ m_assigns[variableOf(literal)] };
+			return (literal & 1u) ? static_cast<std::int8_t>(-value) : value;
+		}
+
+		/// @returns current decision level
+		inline std::uint32_t decisionLevel() const { return static_cast<std::uint32_t>(m_trail_limits.size()); }
+
+		/// @returns pointer to literals of clause at given offset
+		inline literal_t* literalsOf(std::uint32_t clause) { return m_arena.data() + clause + 2u; }
+
+		/// @returns number of literals of clause at given offset
+		inline std::uint32_t sizeOf(std::uint32_t clause) const { return m_arena[clause]; }
+
+		/// @brief Assigns literal true
+		void enqueue(literal_t literal, std::uint32_t reason)
+		{
+			const auto variable{ variableOf(literal) };
+			m_assigns[variable] = (literal & 1u) ? -1 : 1;
+			m_levels[variable] = decisionLevel();
+			m_reasons[variable] = reason;
+			m_trail.push_back(literal);
+		}
+
+		/// @brief Moves variable at given heap position up until its parent is more active
+		void heapUp(std::size_t position)
+		{
+			const std::uint32_t variable{ m_heap[position] };
+			while (position > 0u && m_activity[m_heap[(position - 1u) / 2u]] < m_activity[variable])
+			{
+				m_heap[position] = m_heap[(position - 1u) / 2u];
+				m_heap_positions[m_heap[position]] = static_cast<std::int32_t>(position);
+				position = (position - 1u) / 2u;
+			}
+			m_heap[position] = variable;
+			m_heap_positions[variable] = static_cast<std::int32_t>(position);
+		}
+
+		/// @brief Moves variable at given heap position down until its children are less active
+		void heapDown(std::size_t position)
+		{
+			const std::uint32_t variable{ m_heap[position] };
+			while (2u * position + 1u < m_heap.size())
+			{
+				std::size_t child{ 2u * position + 1u };
+				if (child + 1u < m_heap.size() && m_activity[m_heap[child + 1u]] > m_activity[m_heap[child]])
+					child++;
+				if (m_activity[m_heap[child]] <= m_activity[variable])
+					break;
+				m_heap[position] = m_heap[child];
+				m_heap_positions[m_heap[position]] = static_cast<std::int32_t>(position);
+				position = child;
+			}
+			m_heap[position] = variable;
+			m_heap_positions[variable] = static_cast<std::int32_t>(position);
+		}
+
+		/// @brief Inserts variable into heap unless it is already there
+		void heapInsert(std::uint32_t variable)
+		{
+			if (m_heap_positions[variable] >= 0)
+				return;
+			m_heap.push_back(variable);
+			heapUp(m_heap.size() - 1u);
+		}
+
+		/// @returns the most active variable, removed from heap
+		std::uint32_t heapPop()
+		{
+			const std::uint32_t top{ m_heap.front() };
+			m_heap_positions[top] = -1;
+			m_heap.front() = m_heap.back();
+			m_heap.pop_back();
+			if (!m_heap.empty())
+				heapDown(0u);
+			return top;
+		}
+
+		/// @brief Increases activity of variable, rescales all activities when they get too big
+		void bumpVariable(std::uint32_t variable)
+		{
+			if ((m_activity[variable] += m_increment) > 1e100)
+			{
+				for (auto& activity : m_activity)
+					activity *= 1e-100;
+				m_increment *= 1e-100;
+			}
+			if (m_heap_positions[variable] >= 0)
+				heapUp(static_cast<std::size_t>(m_heap_positions[variable]));
+		}
+
+		/// @brief Adds watchers of clause at given offset
+		void attach(std::uint32_t clause)
+		{
+			const literal_t* literals{ literalsOf(clause) };
+			m_watches[literals[0]].push_back({ clause, literals[1] });
+			m_watches[literals[1]].push_back({ clause, literals[0] });
+		}
+
+		/// @brief Stores clause of at least two literals, binary ones only in watch lists
+		/// @returns offset of the clause, `binary_flag` for binary ones
+		std::uint32_t store(const std::vector<literal_t>& literals, bool learnt, std::uint32_t lbd)
+		{
+			if (literals.size() == 2u)
+			{
+				m_watches[literals[0]].push_back({ binary_flag, literals[1] });
+				m_watches[literals[1]].push_back({ binary_flag, literals[0] });
+				return binary_flag;
+			}
+			const auto clause{ static_cast<std::uint32_t>(m_arena.size()) };
+			m_arena.push_back(static_cast<std::uint32_t>(literals.size()));
+			m_arena.push_back(learnt ? (learnt_flag | lbd) : 0u);
+			m_arena.insert(m_arena.end(), literals.begin(), literals.end());
+			attach(clause);
+			return clause;
+		}
+
+		/// @brief Propagates all enqueued literals
+		/// @returns false on conflict, its literals are then in `m_conflict`
+		bool propagate()
+		{
+			while (m_propagated < m_trail.size())
+			{
+				const literal_t false_literal{ negationOf(m_trail[m_propagated++]) };
+				auto& watchers{ m_watches[false_literal] };
+				m_statistics.propagations++;
+				std::size_t i{ 0u }, j{ 0u };
+				const std::size_t size{ watchers.size() };
+				while (i < size)
+				{
+					const watcher_t watcher{ watchers[i++] };
+					const std::int8_t blocker_value{ valueOf(watcher.blocker) };
+					if (blocker_value > 0)
+					{
+						watchers[j++] = watcher;
+						continue;
+					}
+					if (watcher.clause == binary_flag)
+					{
+						watchers[j++] = watcher;
+						if (blocker_value < 0)
+						{
+							m_conflict.assign({ watcher.blocker, false_literal });
+							while (i < size)
+								watchers[j++] = watchers[i++];
+							watchers.resize(j);
+							return false;
+						}
+						enqueue(watcher.blocker, binary_flag | false_literal);
+						continue;
+					}
+					if (m_arena[watcher.clause + 1u] & deleted_flag)
+						continue;
+
+					literal_t* literals{ literalsOf(watcher.clause) };
+					if (literals[0] == false_literal)
+						std::swap(literals[0], literals[1]);
+					const literal_t first{ literals[0] };
+					if (first != watcher.blocker && valueOf(first) > 0)
+					{
+						watchers[j++] = { watcher.clause, first };
+						continue;
+					}
+					bool moved{ false };
+					const std::uint32_t clause_size{ sizeOf(watcher.clause) };
+					for (std::uint32_t k{ 2u }; k < clause_size; k++)
+						if (valueOf(literals[k]) >= 0)
+						{
+							std::swap(literals[1], literals[k]);
+							m_watches[literals[1]].push_back({ watcher.clause, first });
+							moved = true;
+							break;
+						}
+					if (moved)
+						continue;
+					watchers[j++] = { watcher.clause, first };
+					if (valueOf(first) < 0)
+					{
+						m_conflict.assign(literals, literals + clause_size);
+						while (i < size)
+							watchers[j++] = watchers[i++];
+						watchers.resize(j);
+						return false;
+					}
+					enqueue(first, watcher.clause);
+				}
+				watchers.resize(j);
+			}
+			return true;
+		}
+
+		/// @brief Calls `visit` for every literal of reason of given variable other than the implied one
+		template<typename visitor_t>
+		void forEachReasonLiteral(std::uint32_t variable, visitor_t visit)
+		{
+			const std::uint32_t reason{ m_reasons[variable] };
+			if (reason == no_reason)
+				return;
+			if (reason & binary_flag)
+			{
+				visit(static_cast<literal_t>(reason & ~binary_flag));
+				return;
+			}
+			const literal_t* literals{ literalsOf(reason) };
+			for (std::uint32_t k{ 1u }; k < sizeOf(reason); k++)
+				visit(literals[k]);
+		}
+
+		/// @brief First-UIP conflict analysis of `m_conflict`
+		/// @param learnt filled with learnt clause, asserting literal first and literal of backtrack level second
+		/// @returns backtrack level
+		std::uint32_t analyze(std::vector<literal_t>& learnt)
+		{
+			learnt.assign(1u, 0u);
+			std::size_t path{ 0u }, index{ m_trail.size() };
+			literal_t pivot{ 0u };
+			auto visit = [&](literal_t literal)
+				{
+					const auto variable{ variableOf(literal) };
+					if (m_seen[variable] || m_levels[variable] == 0u)
+						return;
+					m_seen[variable] = 1u;
+					bumpVariable(variable);
+					if (m_levels[variable] >= decisionLevel())
+						path++;
+					else
+						learnt.push_back(literal);
+				};
+			for (auto literal : m_conflict)
+				visit(literal);
+			do
+			{
+				while (!m_seen[variableOf(m_trail[--index])]);
+				pivot = m_trail[index];
+				m_seen[variableOf(pivot)] = 0u;
+				if (--path == 0u)
+					break;
+				forEachReasonLiteral(variableOf(pivot), visit);
+			} while (true);
+			learnt[0] = negationOf(pivot);
+
+			// local minimization: literal implied only by other literals of the clause is redundant
+			std::vector<literal_t> marked(learnt.begin() + 1, learnt.end());
+			auto kept{ learnt.begin() + 1 };
+			for (auto it{ learnt.begin() + 1 }; it != learnt.end(); it++)
+			{
+				const auto variable{ variableOf(*it) };
+				bool redundant{ m_reasons[variable] != no_reason };
+				if (redundant)
+					forEachReasonLiteral(variable, [&](literal_t literal) { redundant = redundant && (m_seen[variableOf(literal)] || m_levels[variableOf(literal)] == 0u); });
+				if (!redundant)
+					*kept++ = *it;
+			}
+			learnt.erase(kept, learnt.end());
+			for (auto literal : marked)
+				m_seen[variableOf(literal)] = 0u;
+
+			if (learnt.size() == 1u)
+				return 0u;
+			std::size_t highest{ 1u };
+			for (std::size_t k{ 2u }; k < learnt.size(); k++)
+				if (m_levels[variableOf(learnt[k])] > m_levels[variableOf(learnt[highest])])
+					highest = k;
+			std::swap(learnt[1], learnt[highest]);
+			return m_levels[variableOf(learnt[1])];
+		}
+
+		/// @returns number of distinct decision levels of literals
+		std::uint32_t lbdOf(const std::vector<literal_t>& literals) const
+		{
+			std::vector<std::uint32_t> levels;
+			for (auto literal : literals)
+				levels.push_back(m_levels[variableOf(literal)]);
+			std::sort(levels.begin(), levels.end());
+			return static_cast<std::uint32_t>(std::unique(levels.begin(), levels.end()) - levels.begin());
+		}
+
+		/// @brief Unassigns all literals above given level, saving their phases
+		void backtrack(std::uint32_t level)
+		{
+			if (decisionLevel() <= level)
+				return;
+			for (std::size_t i{ m_trail.size() }; i > m_trail_limits[level]; i--)
+			{
+				const auto variable{ variableOf(m_trail[i - 1u]) };
+				m_polarity[variable] = (m_trail[i - 1u] & 1u) != 0u;
+				m_assigns[variable] = 0;
+				heapInsert(variable);
+			}
+			m_trail.resize(m_trail_limits[level]);
+			m_trail_limits.resize(level);
+			m_propagated = m_trail.size();
+		}
+
+		/// @brief Deletes half of learnt clauses with the highest LBD, keeping glue clauses (LBD <= 2) and reasons
+		void reduceLearnts()
+		{
+			auto lbd = [&](std::uint32_t clause) { return m_arena[clause + 1u] & ~(learnt_flag | deleted_flag); };
+			std::sort(m_learnts.begin(), m_learnts.end(), [&](std::uint32_t a, std::uint32_t b) { return lbd(a) > lbd(b); });
+			std::vector<std::uint32_t> kept;
+			for (std::size_t i{ 0u }; i < m_learnts.size(); i++)
+			{
+				const auto clause{ m_learnts[i] };
+				const auto implied{ variableOf(literalsOf(clause)[0]) };
+				const bool locked{ m_assigns[implied] != 0 && m_reasons[implied] == clause };
+				if (i < m_learnts.size() / 2u && lbd(clause) > 2u && !locked)
+				{
+					m_arena[clause + 1u] |= deleted_flag;
+					m_statistics.deleted_clauses++;
+				}
+				else
+					kept.push_back(clause);
+			}
+			m_learnts.swap(kept);
+		}
+
+		/// @returns i-th element (from 0) of Luby sequence 1 1 2 1 1 2 4 ...
+		static std::size_t luby(std::size_t i)
+		{
+			std::size_t size{ 1u }, power{ 0u };
+			while (size < i + 1u)
+			{
+				power++;
+				size = 2u * size + 1u;
+			}
+			while (size - 1u != i)
+			{
+				size = (size - 1u) / 2u;
+				power--;
+				i %= size;
+			}
+			return std::size_t{ 1u } << power;
+		}
+
+	public:
+		/// @param variables number of variables, numbered from 0
+		explicit SatSolver_t(std::size_t variables)
+			: m_watches(2u * variables), m_assigns(variables, 0), m_polarity(variables, true), m_levels(variables, 0u),
+			m_reasons(variables, no_reason), m_activity(variables, 0.0), m_heap_positions(variables, -1), m_seen(variables, 0u)
+		{
+			for (std::uint32_t variable{ 0u }; variable < variables; variable++)
+				heapInsert(variable);
+		}
+
+		/// @brief Adds clause, must be called before `solve()`
+		/// @returns false if clauses became unsatisfiable
+		bool addClause(std::vector<literal_t> literals)
+		{
+			if (!m_ok)
+				return false;
+			std::sort(literals.begin(), literals.end());
+			literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+			std::size_t kept{ 0u };
+			for (std::size_t i{ 0u }; i < literals.size(); i++)
+			{
+				if (valueOf(literals[i]) > 0 || (i + 1u < literals.size() && literals[i + 1u] == negationOf(literals[i])))
+					return true; // satisfied or tautology
+				if (valueOf(literals[i]) == 0)
+					literals[kept++] = literals[i];
+			}
+			literals.resize(kept);
+			if (literals.empty())
+				return m_ok = false;
+			if (literals.size() == 1u)
+			{
+				enqueue(literals[0], no_reason);
+				return m_ok = propagate();
+			}
+			store(literals, false, 0u);
+			return true;
+		}
+
+		/// @brief Searches for satisfying assignment
+		/// @param budget limits of the search, one node per conflict; nullptr for unlimited search
+		sat_result_t solve(SolveBudgetTracker_t* budget = nullptr)
+		{
+			if (!m_ok || !propagate())
+				return sat_result_t::UNSATISFIABLE;
+			std::vector<literal_t> learnt;
+			std::size_t restart{ 0u }, conflicts_until_restart{ 100u }, max_learnts{ std::max<std::size_t>(2000u, m_arena.size() / 16u) };
+			while (true)
+			{
+				if (!propagate())
+				{
+					m_statistics.conflicts++;
+					if (decisionLevel() == 0u)
+						return sat_result_t::UNSATISFIABLE;
+					if (budget != nullptr && !budget->step())
+						return sat_result_t::UNKNOWN;
+					const std::uint32_t level{ analyze(learnt) };
+					backtrack(level);
+					if (learnt.size() == 1u)
+						enqueue(learnt[0], no_reason);
+					else
+					{
+						const std::uint32_t clause{ store(learnt, true, lbdOf(learnt)) };
+						if (clause != binary_flag)
+							m_learnts.push_back(clause);
+						enqueue(learnt[0], clause == binary_flag ? (binary_flag | learnt[1]) : clause);
+						m_statistics.learnt_clauses++;
+					}
+					m_increment /= 0.95;
+					if (conflicts_until_restart > 0u)
+						conflicts_until_restart--;
+					continue;
+				}
+				if (conflicts_until_restart == 0u)
+				{
+					m_statistics.restarts++;
+					conflicts_until_restart = 100u * luby(++restart);
+					backtrack(0u);
+				}
+				if (m_learnts.size() >= max_learnts)
+				{
+					reduceLearnts();
+					max_learnts += max_learnts / 10u;
+				}
+				std::uint32_t next{ std::numeric_limits<std::uint32_t>::max() };
+				while (!m_heap.empty() && next == std::numeric_limits<std::uint32_t>::max())
+				{
+					const auto variable{ heapPop() };
+					if (m_assigns[variable] == 0)
+						next = variable;
+				}
+				if (next == std::numeric_limits<std::uint32_t>::max())
+					return sat_result_t::SATISFIABLE;
+				m_statistics.decisions++;
+				m_trail_limits.push_back(m_trail.size());
+				enqueue(makeLiteral(next, m_polarity[next]), no_reason);
+			}
+		}
+
+		/// @returns value of variable in found model
+		inline bool valueOfVariable(std::uint32_t variable) const { return m_assigns[variable] > 0; }
+
+		/// @returns counters of the search
+		inline const sat_statistics_t& getStatistics() const { return m_statistics; }
+	};
+}
@@ -0,0 +1,287 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace malcolm
+{
+	/// @brief How single assumption of bruteforce ended
+	enum class search_outcome_t : std::uint8_t
+	{
+		/// propagation found contradiction, value was erased from possibilities
+		CONTRADICTION,
+		/// propagation filled the board, value was inserted
+		SOLUTION,
+		/// propagation got stuck, next assumption was tried
+		NOTHING
+	};
+
+	/// @returns name of outcome used in reports
+	inline const char* toString(search_outcome_t outcome)
+	{
+		switch (outcome)
+		{
+		case search_outcome_t::CONTRADICTION: return "contradiction";
+		case search_outcome_t::SOLUTION: return "solution";
+		default: return "nothing";
+		}
+	}
+
+	/// @brief Single assumption tried by bruteforce and the propagation done beneath it
+	struct search_assumption_t
+	{
+		/// index of the field (9 * y + x)
+		std::uint8_t field{ 0u };
+		/// assumed value
+		std::uint8_t value{ 0u };
+		search_outcome_t outcome{ search_outcome_t::NOTHING };
+		/// time of the whole scenario, propagation included
+		std::uint64_t ns{ 0u };
+		/// fields filled by propagation
+		std::uint32_t insertions{ 0u };
+		/// possibilities erased by propagation
+		std::uint32_t eliminations{ 0u };
+		/// time spent in every strategy asked by propagation, names are string literals
+		std::vector<std::pair<std::string_view, std::uint64_t>> work;
+
+		/// @brief Adds time spent in given strategy
+		void addWork(std::string_view strategy, std::uint64_t strategy_ns)
+		{
+			for (auto& [name, total] : work)
+				if (name == strategy)
+				{
+					total += strategy_ns;
+					return;
+				}
+			work.emplace_back(strategy, strategy_ns);
+		}
+	};
+
+	/// @brief Single call of bruteforce: a branch point and all assumptions tried there
+	struct search_branch_t
+	{
+		/// puzzle given to `SearchProfiler_t::beginPuzzle()`
+		std::size_t puzzle{ 0u };
+		/// number of bruteforce calls of the puzzle before this one
+		std::uint32_t round{ 0u };
+		/// empty fields of the board when bruteforce was called
+		std::uint8_t empty{ 0u };
+		/// true if budget of the solve ran out during this call
+		bool exhausted{ false };
+		/// time of the whole call, choosing the assumptions included
+		std::uint64_t ns{ 0u };
+		/// assumptions in order they were tried
+		std::vector<search_assumption_t> assumptions;
+	};
+
+	/// @brief Records search tree of `BoardSolver_t`: every bruteforce call, every assumption tried there, its outcome,
+	/// time and the propagation work beneath it. Meant for finding out why single puzzles are slow, where `[0x52]`-`[0x54]`
+	/// trace lines are too scattered to read.
+	/// @li Disabled by default, then bruteforce pays a single atomic load per call.
+	/// @li Every thread records into its own list, so recording takes no locks. Lists are merged by `writeCollapsed()`
+	/// and `printSummary()`, which should be called when recording threads are done. Everything is kept in memory
+	/// until the end of the process, so profile batches of the size you want to read.
+	class SearchProfiler_t
+	{
+	private:
+		/// @brief Branches of single thread
+		struct thread_profile_t
+		{
+			std::vector<std::unique_ptr<search_branch_t>> branches;
+			std::size_t puzzle{ 0u };
+			std::uint32_t rounds{ 0u };
+		};
+
+		/// @brief Process-wide switch, see setEnabled()
+		inline static std::atomic<bool> s_enabled{ false };
+
+		/// @brief guards `s_threads`
+		inline static std::mutex s_mutex;
+
+		/// @brief profiles of all threads which recorded anything, kept until the end of the process
+		inline static std::vector<std::unique_ptr<thread_profile_t>> s_threads;
+
+		/// @returns profile of calling thread, created on first use
+		static thread_profile_t& forThisThread()
+		{
+			thread_local thread_profile_t* profile{ nullptr };
+			if (profile == nullptr)
+			{
+				std::lock_guard lock{ s_mutex };
+				s_threads.push_back(std::make_unique<thread_profile_t>());
+				profile = s_threads.back().get();
+			}
+			return *profile;
+		}
+
+		/// @returns branches of all threads ordered by puzzle and round
+		static std::vector<const search_branch_t*> merged()
+		{
+			std::vector<const search_branch_t*> result;
+			for (const auto& thread : s_threads)
+				for (const auto& branch : thread->branches)
+					result.push_back(branch.get());
+			std::sort(result.begin(), result.end(), [](const auto* lhs, const auto* rhs) { return std::pair{ lhs->puzzle, lhs->round } < std::pair{ rhs->puzzle, rhs->round }; });
+			return result;
+		}
+
+		/// @brief Writes assumption as `r<y>c<x>=<value>` with 1-based row and column, as players name fields
+		static void writeAssumption(std::ostream& stream, const search_assumption_t& assumption)
+		{
+			stream << 'r' << assumption.field / 9u + 1u << 'c' << assumption.field % 9u + 1u << '=' << static_cast<std::uint32_t>(assumption.value);
+		}
+
+	public:
+		/// @brief Enables or disables recording
+		static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+		/// @returns true if search is recorded
+		static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+		/// @brief Marks start of the next puzzle solved by calling thread, its branches are reported under given number
+		static void beginPuzzle(std::size_t puzzle)
+		{
+			auto& profile{ forThisThread() };
+			profile.puzzle = puzzle;
+			profile.rounds = 0u;
+		}
+
+		/// @brief Starts recording of bruteforce call of calling thread
+		/// @param empty number of empty fields of the board
+		/// @returns branch to be filled by the caller, valid until the end of the process
+		static search_branch_t& openBranch(std::size_t empty)
+		{
+			auto& profile{ forThisThread() };
+			profile.branches.push_back(std::make_unique<search_branch_t>());
+			search_branch_t& branch{ *profile.branches.back() };
+			branch.puzzle = profile.puzzle;
+			branch.round = profile.rounds++;
+			branch.empty = static_cast<std::uint8_t>(empty);
+			return branch;
+		}
+
+		/// @brief Writes the tree in collapsed-stack format read by flamegraph tools (`flamegraph.pl`, speedscope, inferno):
+		/// one line per path `puzzle_<n>;bruteforce_<round>;r<y>c<x>=<v>:<outcome>;<strategy>` followed by nanoseconds spent there.
+		/// Time not spent in strategies is reported on the shorter paths (e.g. choosing assumptions, copying boards).
+		/// @param stream destination of the report
+		static void writeCollapsed(std::ostream& stream)
+		{
+			std::lock_guard lock{ s_mutex };
+			for (const auto* branch : merged())
+			{
+				std::uint64_t children{ 0u };
+				for (const auto& assumption : branch->assumptions)
+				{
+					std::uint64_t work{ 0u };
+					for (const auto& [strategy, strategy_ns] : assumption.work)
+					{
+						stream << "puzzle_" << branch->puzzle << ";bruteforce_" << branch->round << ';';
+						writeAssumption(stream, assumption);
+						stream << ':' << toString(assumption.outcome) << ';' << strategy << ' ' << strategy_ns << '\n';
+						work += strategy_ns;
+					}
+					stream << "puzzle_" << branch->puzzle << ";bruteforce_" << branch->round << ';';
+					writeAssumption(stream, assumption);
+					stream << ':' << toString(assumption.outcome) << ' ' << (assumption.ns > work ? assumption.ns - work : 0u) << '\n';
+					children += assumption.ns;
+				}
+				stream << "puzzle_" << branch->puzzle << ";bruteforce_" << branch->round << ' ' << (branch->ns > children ? branch->ns - children : 0u) << '\n';
+			}
+		}
+
+		/// @brief Writes totals per outcome and the most expensive branch points with their most expensive assumption
+		/// @param stream destination of the report
+		/// @param top number of reported branch points
+		static void printSummary(std::ostream& stream, std::size_t top)
+		{
+			std::lock_guard lock{ s_mutex };
+			auto branches{ merged() };
+			std::uint64_t total_ns{ 0u };
+			std::array<std::pair<std::size_t, std::uint64_t>, 3u> outcomes{};
+			for (const auto* branch : branches)
+			{
+				total_ns += branch->ns;
+				for (const auto& assumption : branch->assumptions)
+				{
+					outcomes[static_cast<std::size_t>(assumption.outcome)].first++;
+					outcomes[static_cast<std::size_t>(assumption.outcome)].second += assumption.ns;
+				}
+			}
+			stream << "search profile: " << branches.size() << " branch points, " << std::fixed << std::setprecision(1) << total_ns / 1e6 << " ms\n";
+			for (std::size_t i{ 0u }; i < outcomes.size(); i++)
+				stream << "  " << std::left << std::setw(14) << toString(static_cast<search_outcome_t>(i)) << std::right << std::setw(9) << outcomes[i].first
+					<< " assumptions" << std::setw(12) << std::setprecision(1) << outcomes[i].second / 1e6 << " ms\n";
+
+			top = std::min(top, branches.size());
+			std::partial_sort(branches.begin(), branches.begin() + top, branches.end(), [](const auto* lhs, const auto* rhs) { return lhs->ns > rhs->ns; });
+			stream << "    puzzle   round  empty  tried     time[us]  insertions  eliminations  resolved by          most expensive\n";
+			for (std::size_t i{ 0u }; i < top; i++)
+			{
+				const search_branch_t& branch{ *branches[i] };
+				std::uint32_t insertions{ 0u }, eliminations{ 0u };
+				for (const auto& assumption : branch.assumptions)
+				{
+					insertions += assumption.insertions;
+					eliminations += assumption.eliminations;
+				}
+				stream << std::setw(10) << branch.puzzle << std::setw(8) << branch.round << std::setw(7) << static_cast<std::uint32_t>(branch.empty)
+					<< std::setw(7) << branch.assumptions.size() << std::setw(13) << std::setprecision(1) << branch.ns / 1e3
+					<< std::setw(12) << insertions << std::setw(14) << eliminations << "  ";
+				std::ostringstream resolved, expensive;
+				if (branch.exhausted || branch.assumptions.empty() || branch.assumptions.back().outcome == search_outcome_t::NOTHING)
+					resolved << (branch.exhausted ? "budget" : "nothing");
+				else
+				{
+					writeAssumption(resolved, branch.assumptions.back());
+					resolved << ':' << toString(branch.assumptions.back().outcome);
+				}
+				const auto costliest{ std::max_element(branch.assumptions.begin(), branch.assumptions.end(), [](const auto& lhs, const auto& rhs) { return lhs.ns < rhs.ns; }) };
+				if (costliest != branch.assumptions.end())
+				{
+					writeAssumption(expensive, *costliest);
+					expensive << " (" << std::fixed << std::setprecision(1) << costliest->ns / 1e3 << " us)";
+				}
+				stream << std::left << std::setw(21) << resolved.str() << expensive.str() << std::right << "\n";
+			}
+		}
+	};
+
+	/// @brief Measures time from construction to destruction into given branch, if there is one
+	class ScopedSearchTimer_t
+	{
+	private:
+		/// @brief destination of the measured time, nullptr if search isn't recorded
+		std::uint64_t* m_destination;
+
+		/// @brief time of construction
+		std::chrono::steady_clock::time_point m_start;
+
+	public:
+		/// @param destination destination of the measured time, nullptr to measure nothing
+		explicit ScopedSearchTimer_t(std::uint64_t* destination)
+			: m_destination{ destination }
+		{
+			if (m_destination != nullptr)
+				m_start = std::chrono::steady_clock::now();
+		}
+
+		ScopedSearchTimer_t(const ScopedSearchTimer_t&) = delete;
+		ScopedSearchTimer_t& operator=(const ScopedSearchTimer_t&) = delete;
+
+		~ScopedSearchTimer_t()
+		{
+			if (m_destination != nullptr)
+				*m_destination = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+		}
+	};
+}
@@ -0,0 +1,530 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "BoardSerializer.h"
+#include "SolverServer.h"
+#include "SolvingPipeline.h"
+
+namespace malcolm
+{
+	/// @brief Framing of messages exchanged by `ShardCoordinator_t` and its workers over stream socket, all integers little endian
+	/// @li assignment: u32 shard, u64 offset of its first byte in the input, u64 offset behind its last byte
+	/// @li result: u32 shard, u32 number of puzzles, u64 size of results followed by results in `pipeline_output_t::TEXT` format
+	struct shard_protocol_t
+	{
+		/// size of single assignment
+		static constexpr std::size_t assignment_size{ 20u };
+		/// size of result without the results themselves
+		static constexpr std::size_t result_header_size{ 16u };
+		/// file descriptor of the socket in worker process
+		static constexpr int worker_descriptor{ 3 };
+	};
+
+	/// @brief Settings of `ShardCoordinator_t`
+	struct shard_config_t
+	{
+		/// number of worker processes
+		std::size_t workers{ std::max(1u, std::thread::hardware_concurrency()) };
+		/// approximate size of single shard in bytes, every shard is extended to the end of its last line
+		std::size_t shard_size{ 4u << 20u };
+		/// directory of completed shards, empty for `<output>.shards`
+		std::string checkpoint{};
+		/// number of times a shard is handed out before the run fails, guards against puzzles crashing every worker
+		std::size_t attempts{ 3u };
+		/// time limit of single puzzle, 0 means no limit
+		std::chrono::milliseconds time_limit{ 0 };
+		/// node limit of single puzzle (see `solve_budget_t`), 0 means no limit
+		std::size_t node_limit{ 0u };
+		/// executable started as worker, it's expected to call `ShardCoordinator_t::serve()` for `--shard-worker`
+		std::string executable{ "/proc/self/exe" };
+	};
+
+#ifndef _WIN32
+	/// @brief Solves puzzle file too large for single run: splits it into shards (byte ranges ending at line ends) and hands them
+	/// to worker processes, every one running `SolvingPipeline_t` with single `BoardSolver_t` thread.
+	/// @li Workers are copies of `shard_config_t::executable` started with `fork()` and `exec()`, connected by Unix domain socket pair
+	/// (see `shard_protocol_t`). They read their shards from the input file themselves, only offsets and results go through sockets.
+	/// @li Result of every shard is written to the checkpoint directory (temporary file renamed when complete), so a run killed
+	/// at any moment is resumed by running it again: shards found in the checkpoint aren't solved again. The directory also
+	/// holds a manifest (size and modification time of the input, shard size), a checkpoint of different input is refused.
+	/// @li Worker which dies is replaced and its shard handed out again, up to `shard_config_t::attempts` times.
+	/// @li When all shards are done they are concatenated in input order into the output file, which is replaced at once
+	/// by rename, and the checkpoint is removed. Output is the same as of `--batch` run over the whole file.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class ShardCoordinator_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// @brief Byte range of the input
+		struct shard_range_t
+		{
+			std::uint64_t begin;
+			std::uint64_t end;
+		};
+
+		/// @brief Running worker process
+		struct worker_process_t
+		{
+			pid_t pid{ -1 };
+			/// coordinator's end of the socket pair
+			int fd{ -1 };
+			/// shard being solved, `idle` if none
+			std::size_t shard{ idle };
+			/// time the shard was handed out
+			std::chrono::steady_clock::time_point assigned{};
+		};
+
+		/// @brief `worker_process_t::shard` of worker waiting for assignment
+		static constexpr std::size_t idle{ static_cast<std::size_t>(-1) };
+
+	private:
+		/// @brief path of puzzle file
+		std::string m_input;
+
+		/// @brief path of result file
+		std::string m_output;
+
+		/// @brief settings given in constructor, `checkpoint` filled in
+		shard_config_t m_config;
+
+		/// @brief all shards of the input in input order
+		std::vector<shard_range_t> m_shards;
+
+		/// @brief running workers
+		std::vector<worker_process_t> m_workers;
+
+		/// @brief number of shards found in the checkpoint
+		std::size_t m_resumed{ 0u };
+
+		/// @brief number of shards solved by this run
+		std::size_t m_completed{ 0u };
+
+		/// @brief number of puzzles in shards solved by this run
+		std::size_t m_puzzles{ 0u };
+
+		/// @brief number of workers replaced after they died
+		std::size_t m_restarts{ 0u };
+
+		/// @returns path of result of given shard in the checkpoint
+		std::string shardPath(std::size_t shard) const
+		{
+			char name[32];
+			std::snprintf(name, sizeof(name), "/shard-%08zu", shard);
+			return m_config.checkpoint + name;
+		}
+
+		/// @brief Reads exactly `size` bytes of file from given offset
+		/// @returns false if the file is shorter or can't be read
+		static bool readAt(int fd, char* data, std::size_t size, std::uint64_t offset)
+		{
+			while (size > 0u)
+			{
+				auto received{ ::pread(fd, data, size, static_cast<off_t>(offset)) };
+				if (received <= 0)
+					return false;
+				data += received;
+				offset += static_cast<std::uint64_t>(received);
+				size -= static_cast<std::size_t>(received);
+			}
+			return true;
+		}
+
+		/// @brief Writes file into temporary one and renames it to `path` when it's on disk, so file with the final name is always complete
+		/// @throws std::runtime_error if the file can't be written
+		static void writeFileAtomically(const std::string& path, const char* data, std::size_t size)
+		{
+			const std::string temporary{ path + ".tmp" };
+			int fd{ ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) };
+			if (fd < 0)
+				throw std::runtime_error("can't create " + temporary);
+			bool written{ true };
+			for (std::size_t offset{ 0u }; written && offset < size;)
+			{
+				auto count{ ::write(fd, data + offset, size - offset) };
+				written = count > 0;
+				offset += written ? static_cast<std::size_t>(count) : 0u;
+			}
+			written = ::fsync(fd) == 0 && written;
+			::close(fd);
+			if (!written || ::rename(temporary.c_str(), path.c_str()) != 0)
+				throw std::runtime_error("can't write " + path);
+		}
+
+		/// @brief Flushes renames done in the checkpoint directory
+		void syncCheckpoint() const
+		{
+			int fd{ ::open(m_config.checkpoint.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+			if (fd >= 0)
+			{
+				::fsync(fd);
+				::close(fd);
+			}
+		}
+
+		/// @brief Splits file into ranges of about `shard_size` bytes, every range ends behind a line end (or at the end of the file)
+		/// @throws std::runtime_error if the file can't be read
+		static std::vector<shard_range_t> split(int fd, std::uint64_t size, std::uint64_t shard_size)
+		{
+			std::vector<shard_range_t> shards;
+			std::array<char, 4096u> buffer;
+			for (std::uint64_t begin{ 0u }; begin < size;)
+			{
+				std::uint64_t end{ std::min(size, begin + shard_size) };
+				for (std::uint64_t position{ end - 1u }; end < size; ) // range already ending with line end stays as it is
+				{
+					const std::size_t count{ static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), size - position)) };
+					if (!readAt(fd, buffer.data(), count, position))
+						throw std::runtime_error("can't read puzzle file");
+					if (const auto* newline{ static_cast<const char*>(std::memchr(buffer.data(), '\n', count)) })
+					{
+						end = position + static_cast<std::uint64_t>(newline - buffer.data()) + 1u;
+						break;
+					}
+					position += count;
+					end = position;
+				}
+				shards.push_back({ begin, end });
+				begin = end;
+			}
+			return shards;
+		}
+
+		/// @brief Splits the input into shards and opens the checkpoint, shards completed by earlier runs are counted in `m_resumed`
+		/// @returns shards still to be solved, in input order
+		/// @throws std::runtime_error if the input can't be read, or the checkpoint can't be created or belongs to different input
+		std::deque<std::size_t> prepare()
+		{
+			int fd{ ::open(m_input.c_str(), O_RDONLY | O_CLOEXEC) };
+			struct stat status{};
+			if (fd < 0 || ::fstat(fd, &status) != 0)
+			{
+				if (fd >= 0)
+					::close(fd);
+				throw std::runtime_error("can't open " + m_input);
+			}
+			try
+			{
+				m_shards = split(fd, static_cast<std::uint64_t>(status.st_size), m_config.shard_size);
+			}
+			catch (...)
+			{
+				::close(fd);
+				throw;
+			}
+			::close(fd);
+
+			if (::mkdir(m_config.checkpoint.c_str(), 0755) != 0 && errno != EEXIST)
+				throw std::runtime_error("can't create checkpoint directory " + m_config.checkpoint);
+			std::ostringstream manifest;
+			manifest << "malcolm shards 1\n" << status.st_size << " " << status.st_mtime << " " << m_config.shard_size << " " << m_shards.size() << "\n";
+			const std::string manifest_path{ m_config.checkpoint + "/manifest" };
+			if (std::ifstream existing{ manifest_path, std::ios::binary })
+			{
+				if (std::string{ std::istreambuf_iterator<char>{ existing }, std::istreambuf_iterator<char>{} } != manifest.str())
+					throw std::runtime_error("checkpoint " + m_config.checkpoint + " was made for different input or shard size, remove it to start over");
+			}
+			else
+			{
+				writeFileAtomically(manifest_path, manifest.str().data(), manifest.str().size());
+				syncCheckpoint();
+			}
+
+			std::deque<std::size_t> pending;
+			for (std::size_t shard{ 0u }; shard < m_shards.size(); shard++)
+			{
+				if (::access(shardPath(shard).c_str(), F_OK) == 0)
+					m_resumed++;
+				else
+					pending.push_back(shard);
+			}
+			return pending;
+		}
+
+		/// @brief Starts worker process connected by socket pair
+		/// @throws std::runtime_error if the process can't be started
+		worker_process_t spawn() const
+		{
+			int sockets[2];
+			if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+				throw std::runtime_error("can't create socket pair");
+			// everything the child needs is prepared before fork(), it only moves its socket and calls exec()
+			std::vector<std::string> arguments{ m_config.executable, "--shard-worker", std::to_string(shard_protocol_t::worker_descriptor), m_input,
+				"--time-limit", std::to_string(m_config.time_limit.count()), "--node-limit", std::to_string(m_config.node_limit) };
+			std::vector<char*> argv;
+			for (auto& argument : arguments)
+				argv.push_back(argument.data());
+			argv.push_back(nullptr);
+
+			const pid_t pid{ ::fork() };
+			if (pid == 0)
+			{
+				if (sockets[1] == shard_protocol_t::worker_descriptor)
+					::fcntl(sockets[1], F_SETFD, 0);
+				else
+					::dup2(sockets[1], shard_protocol_t::worker_descriptor);
+				::execv(argv[0], argv.data());
+				::_exit(127);
+			}
+			::close(sockets[1]);
+			if (pid < 0)
+			{
+				::close(sockets[0]);
+				throw std::runtime_error("can't start worker process");
+			}
+			worker_process_t worker;
+			worker.pid = pid;
+			worker.fd = sockets[0];
+			return worker;
+		}
+
+		/// @brief Closes socket of worker and waits for its exit
+		/// @param terminate if true, worker is killed instead of being let finish its shard
+		static void stop(worker_process_t& worker, bool terminate)
+		{
+			if (terminate)
+				::kill(worker.pid, SIGTERM);
+			::close(worker.fd);
+			while (::waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR)
+				;
+		}
+
+		/// @brief Hands shard to idle worker
+		void assign(worker_process_t& worker, std::size_t shard)
+		{
+			std::array<std::uint8_t, shard_protocol_t::assignment_size> assignment;
+			detail::storeU32(assignment.data(), static_cast<std::uint32_t>(shard));
+			detail::storeU64(assignment.data() + 4u, m_shards[shard].begin);
+			detail::storeU64(assignment.data() + 12u, m_shards[shard].end);
+			worker.shard = shard;
+			worker.assigned = std::chrono::steady_clock::now();
+			detail::writeFully(worker.fd, assignment.data(), assignment.size()); // broken worker is noticed when its result is read
+		}
+
+		/// @brief Reads result of worker's shard and stores it in the checkpoint
+		/// @returns false if the worker died or sent something else than result of its shard
+		bool receive(worker_process_t& worker, std::ostream& report)
+		{
+			std::array<std::uint8_t, shard_protocol_t::result_header_size> header;
+			if (!detail::readFully(worker.fd, header.data(), header.size()) || detail::loadU32(header.data()) != worker.shard)
+				return false;
+			const std::uint32_t puzzles{ detail::loadU32(header.data() + 4u) };
+			const std::uint64_t size{ detail::loadU64(header.data() + 8u) };
+			const shard_range_t& range{ m_shards[worker.shard] };
+			if (size > text_result_size * (range.end - range.begin)) // every result line comes from a non-blank input line of at least one byte
+				return false;
+			std::vector<std::uint8_t> results(static_cast<std::size_t>(size));
+			if (!detail::readFully(worker.fd, results.data(), results.size()))
+				return false;
+
+			writeFileAtomically(shardPath(worker.shard), reinterpret_cast<const char*>(results.data()), results.size());
+			syncCheckpoint();
+			m_completed++;
+			m_puzzles += puzzles;
+			const double ms{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - worker.assigned).count() };
+			report << "shard " << worker.shard + 1u << "/" << m_shards.size() << ": " << puzzles << " puzzles in "
+				<< std::fixed << std::setprecision(1) << ms << " ms\n" << std::flush;
+			worker.shard = idle;
+			return true;
+		}
+
+		/// @brief Concatenates completed shards in input order into the output file and removes the checkpoint
+		/// @throws std::runtime_error if a shard can't be read or the output written
+		void merge() const
+		{
+			const std::string temporary{ m_output + ".tmp" };
+			{
+				std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+				std::vector<char> buffer(1u << 20u);
+				for (std::size_t shard{ 0u }; shard < m_shards.size(); shard++)
+				{
+					std::ifstream in{ shardPath(shard), std::ios::binary };
+					if (!in)
+						throw std::runtime_error("can't read " + shardPath(shard));
+					while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0)
+						out.write(buffer.data(), in.gcount());
+				}
+				out.flush();
+				if (!out)
+					throw std::runtime_error("can't write " + temporary);
+			}
+			int fd{ ::open(temporary.c_str(), O_RDONLY | O_CLOEXEC) };
+			const bool synced{ fd >= 0 && ::fsync(fd) == 0 };
+			if (fd >= 0)
+				::close(fd);
+			if (!synced || ::rename(temporary.c_str(), m_output.c_str()) != 0)
+				throw std::runtime_error("can't write " + m_output);
+
+			for (std::size_t shard{ 0u }; shard < m_shards.size(); shard++)
+				::unlink(shardPath(shard).c_str());
+			::unlink((m_config.checkpoint + "/manifest").c_str());
+			::rmdir(m_config.checkpoint.c_str());
+		}
+
+	public:
+		/// @param input path of puzzle file, one puzzle per line as in `SolvingPipeline_t`
+		/// @param output path of result file, replaced when all shards are done
+		/// @param config settings of the run
+		ShardCoordinator_t(const std::string& input, const std::string& output, const shard_config_t& config)
+			: m_input{ input }, m_output{ output }, m_config{ config }
+		{
+			m_config.workers = std::max<std::size_t>(1u, m_config.workers);
+			m_config.shard_size = std::max<std::size_t>(1u, m_config.shard_size);
+			m_config.attempts = std::max<std::size_t>(1u, m_config.attempts);
+			if (m_config.checkpoint.empty())
+				m_config.checkpoint = m_output + ".shards";
+		}
+
+		ShardCoordinator_t(const ShardCoordinator_t&) = delete;
+		ShardCoordinator_t& operator=(const ShardCoordinator_t&) = delete;
+
+		/// @brief Solves shards which aren't in the checkpoint yet and merges all of them into the output file
+		/// @param report stream receiving progress (line per shard) and summary
+		/// @throws std::runtime_error if files can't be read or written, workers can't be started or a shard failed too many times;
+		/// completed shards stay in the checkpoint for the next run
+		void run(std::ostream& report)
+		{
+			const auto start{ std::chrono::steady_clock::now() };
+			auto pending{ prepare() };
+			std::vector<std::size_t> attempts(m_shards.size(), 0u);
+			try
+			{
+				while (m_workers.size() < std::min(m_config.workers, pending.size()))
+					m_workers.push_back(spawn());
+				std::vector<pollfd> descriptors;
+				std::vector<std::size_t> busy;
+				for (;;)
+				{
+					for (auto& worker : m_workers)
+						if (worker.shard == idle && !pending.empty())
+						{
+							attempts[pending.front()]++;
+							assign(worker, pending.front());
+							pending.pop_front();
+						}
+					descriptors.clear();
+					busy.clear();
+					for (std::size_t i{ 0u }; i < m_workers.size(); i++)
+						if (m_workers[i].shard != idle)
+						{
+							descriptors.push_back({ m_workers[i].fd, POLLIN, 0 });
+							busy.push_back(i);
+						}
+					if (busy.empty())
+						break;
+					if (::poll(descriptors.data(), descriptors.size(), -1) < 0)
+					{
+						if (errno == EINTR)
+							continue;
+						throw std::runtime_error("can't wait for workers");
+					}
+					for (std::size_t i{ 0u }; i < busy.size(); i++)
+					{
+						if (descriptors[i].revents == 0)
+							continue;
+						worker_process_t& worker{ m_workers[busy[i]] };
+						const std::size_t shard{ worker.shard };
+						if (receive(worker, report))
+							continue;
+						stop(worker, true);
+						worker = worker_process_t{};
+						if (attempts[shard] >= m_config.attempts)
+							throw std::runtime_error("shard " + std::to_string(shard + 1u) + " failed " + std::to_string(attempts[shard]) + " times, giving up");
+						report << "shard " << shard + 1u << "/" << m_shards.size() << ": worker died, shard handed out again\n";
+						pending.push_front(shard);
+						worker = spawn();
+						m_restarts++;
+					}
+				}
+			}
+			catch (...)
+			{
+				for (auto& worker : m_workers)
+					if (worker.pid > 0)
+						stop(worker, true);
+				m_workers.clear();
+				throw;
+			}
+			for (auto& worker : m_workers)
+				stop(worker, false);
+			m_workers.clear();
+			merge();
+
+			report << "shards: " << m_shards.size() << " total, " << m_resumed << " from checkpoint, " << m_completed << " solved ("
+				<< m_puzzles << " puzzles), " << m_restarts << " workers restarted, " << std::fixed << std::setprecision(1)
+				<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms\n";
+		}
+
+		/// @brief Main loop of worker process: solves assigned shards of the input until the coordinator closes the socket
+		/// or assigns range which isn't within the input
+		/// @param fd socket connected to the coordinator
+		/// @param input path of puzzle file
+		/// @param config settings of `SolvingPipeline_t` solving every shard
+		/// @returns exit code of the worker process
+		static int serve(int fd, const std::string& input, const pipeline_config_t& config)
+		{
+			int file{ ::open(input.c_str(), O_RDONLY | O_CLOEXEC) };
+			struct stat status{};
+			if (file < 0 || ::fstat(file, &status) != 0)
+			{
+				if (file >= 0)
+					::close(file);
+				return 1;
+			}
+			SolvingPipeline_t<value_t> pipeline(config);
+			std::array<std::uint8_t, shard_protocol_t::assignment_size> assignment;
+			std::array<std::uint8_t, shard_protocol_t::result_header_size> header;
+			std::string text;
+			while (detail::readFully(fd, assignment.data(), assignment.size()))
+			{
+				const std::uint64_t begin{ detail::loadU64(assignment.data() + 4u) }, end{ detail::loadU64(assignment.data() + 12u) };
+				if (end < begin || end > static_cast<std::uint64_t>(status.st_size)) // checked before the range is allocated
+					break;
+				text.resize(static_cast<std::size_t>(end - begin));
+				if (!readAt(file, text.data(), text.size(), begin))
+					break;
+				std::istringstream in{ text };
+				std::ostringstream out;
+				const std::size_t written{ pipeline.getStatistics(3u).items.load() };
+				pipeline.run(in, out);
+				const std::string results{ out.str() };
+
+				std::memcpy(header.data(), assignment.data(), 4u);
+				detail::storeU32(header.data() + 4u, static_cast<std::uint32_t>(pipeline.getStatistics(3u).items.load() - written));
+				detail::storeU64(header.data() + 8u, results.size());
+				if (!detail::writeFully(fd, header.data(), header.size()) || !detail::writeFully(fd, reinterpret_cast<const std::uint8_t*>(results.data()), results.size()))
+					break;
+			}
+			::close(file);
+			return 0;
+		}
+	};
+#endif
+}
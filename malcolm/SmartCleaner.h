@@ -1,15 +1,16 @@
 #pragma once
+#include <bit>
 #include <unordered_set>
 #include "Types.h"
 #include "Board.h"
 #include "VectorUtils.h"
-#include "Vector2DUtils.h"
+#include "ConstraintGraph.h"
 #include "FileTracingService.h"
 
 namespace malcolm
 {
 	/// @brief provides functionalities to support board solving
-	/// @li We will work with 3x3 subboards centered at one of `Board_t<size_t>::centersFor9x9Board()`, which will
+	/// @li We will work with units of `ConstraintGraph_t` - on classic board rows, columns and 3x3 subboards, which will
 	/// be called just subboards for simplicity.
 	/// @tparam T type of data stored in board
 	template<typename T>
@@ -88,11 +89,17 @@ namespace malcolm
 		/// not valid place for number 4. Why? Because every column has to contain each number exactly once.
 		/// If F7 and F9 are not equal to 4, then F1-F9 doesn't contain any four which leads to contradition..
 		/// This can be used to clear some values from possibility board, which should lead to processing even more complexified problems.
+		/// 
+		/// Both rules are special cases of a single one, which holds for any geometry given by `ConstraintGraph_t`: if every field
+		/// of some unit where goal is still possible sees field F (F is peer of each of them), goal can't be placed in F.
 
 	private:
 		/// @brief tracing service for smart cleaner
 		FileTracingService_t m_trace;
 
+		/// @brief units and peers of the board, owned by the solver
+		const ConstraintGraph_t* m_graph;
+
 	protected:
 		/// @brief type of data stored in board
 		using value_t = T;
@@ -115,9 +122,10 @@ namespace malcolm
 		using rule_container_t = std::set<rule_t>;
 
 	public:
-		/// @brief default constructor responsible for tracing service initialization
-		SmartCleaner_t()
-			: m_trace{ "smart_cleaner" }
+		/// @brief constructor responsible for tracing service initialization
+		/// @param graph units and peers of the board, has to outlive the cleaner
+		explicit SmartCleaner_t(const ConstraintGraph_t& graph = *ConstraintGraph_t::classic())
+			: m_trace{ "smart_cleaner" }, m_graph{ &graph }
 		{
 		}
 
@@ -127,7 +135,7 @@ namespace malcolm
 		void smartclean(Board_t<value_t>& board, PossibilitiesBoard_t<value_t>& possibilities_board, value_t goal)
 		{
 			size_t count{ board.count(goal) };
-			if (count == 9u || count == 0u)
+			if (count == 9u)
 				return;
 			m_trace << "[9x99] opening smart clean for the goal " << goal << " and game...\n";
 
@@ -146,128 +154,29 @@ namespace malcolm
 			}
 			
 			m_trace << "[9x99] current goal <" << goal << "> and count <" << static_cast<std::int32_t>(count) << ">\n";
-			field_container_t known_fields{ 
-				board.toContainer<field_container_t>(
-					[](field_container_t& container, const field_t<value_t>& value)
-					{ 
-						container.insert(value); 
-					}
-				)
-			};
-			std::size_t counter{ 0u };
-			for (auto& [pos, val] : known_fields)
-			{
-				if (val != static_cast<value_t>(0u))
-					counter ++;
-			}
-			m_trace << "[9x99] " << counter << " numbers are known for now...\n";
-
-			/// @brief used to retrieve vector<column_t> from Board_t
-			/// @param object Board_t from which columns should be extracted
-			/// @param column_numbers set of column indices to be extracted
-			auto extract_specified_columns = [](const Board_t<value_t>& object, const std::vector<size_t>& column_numbers)
-				-> std::vector<column_t<value_t>>
-			{
-				std::vector<column_t<value_t>> result;
-				for (auto number : column_numbers)
-					result.push_back(object.getColumn<column_t<value_t>>(number, [](column_t<value_t>& col, const value_t& val) { col.push_back(val); }));
-				return result;
-			};
 
-			/// @see extract_specified_columns
-			auto extract_specified_rows = [&extract_specified_columns](const Board_t<value_t>& object, const std::vector<size_t>& row_numbers)
-				-> std::vector<row_t<value_t>>
-			{
-				return extract_specified_columns(object.transposed(), row_numbers);
-			};
-
-			/// @see extract_specified_columns
-			auto extract_columns = [&extract_specified_columns](const Board_t<value_t>& object)
-				-> std::vector<column_t<value_t>>
-			{
-				std::vector<size_t> target;
-				for (auto i{ 0u }; i < object.getSize().first; i++)
-					target.push_back(static_cast<size_t>(i));
-				return extract_specified_columns(object, target);
-			};
-
-			/// @see extract_specified_columns
-			auto extract_rows = [&extract_columns](const Board_t <value_t>& object)
-				-> std::vector<row_t<value_t>>
-			{
-				return extract_columns(object.transposed());
-			};
+			bitboard_t candidates;
+			for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+				if (possibilities_board[bitboard_t::positionOf(index)].contains(goal))
+					candidates.set(index);
 
-			/// @brief checks row/column if there are free places and there is no goal number filled
-			auto can_goal_be_placed_in = [&](const auto& container)
-				-> bool
+			for (std::size_t unit{ 0u }; unit < m_graph->getUnitCount(); unit++)
 			{
-				return !container.contains(goal) && container.contains(static_cast<value_t>(0u));
-			};
-			
-			m_trace << "[9x99] prepared function objects...\n";
-			for (auto& x : board.centersFor9x9Board())
-			{
-				m_trace << "[9x90] received next local_center: <" << static_cast<std::int32_t>(x.first) << ", " << static_cast<std::int32_t>(x.second) << ">\n";
-				Board_t<value_t> neighborhood{ board.copyNeighborhood(x) };
-				if (neighborhood.find(goal) != pos_t{-1, -1})
+				bitboard_t hosts{ candidates & m_graph->getUnitMask(unit) };
+				if (!hosts.any()) // goal is already in the unit (or can't be placed there at all, what is up to the solver)
 					continue;
-
-				m_trace << "[8x90] retrieving rows and columns...\n";
-				// determine in which row/column we should put goal in neighborhood
-				std::vector<column_t<value_t>> columns{ extract_columns(neighborhood) };
-				std::vector<row_t<value_t>> rows{ extract_rows(neighborhood) };
-				std::vector<column_t<value_t>> full_columns{ extract_specified_columns(board, {static_cast<size_t>(static_cast<short>(x.first) - 1), static_cast<size_t>(x.first), static_cast<size_t>(static_cast<short>(x.first) + 1)}) };
-				std::vector<row_t<value_t>> full_rows{ extract_specified_rows(board, {static_cast<size_t>(static_cast<short>(x.second) - 1), static_cast<size_t>(x.second), static_cast<size_t>(static_cast<short>(x.second) + 1)}) };
-
-				m_trace << "[8x88] determining local rules... \n";
-				rule_container_t determined_local_rules_for_columns;
-				for (auto i{ 0u }; i < neighborhood.getSize().first; i++)
-				{
-					column_t<value_t> full_column{ (extract_specified_columns(board, {static_cast<size_t>(-1 + static_cast<short>(i + x.first))}))[0] };
-					if (utils::vector::contains(full_column, goal))
-					{
-						m_trace << "[8x86] goal must not be in column " << i << " at local 3x3 subboard\n";
-						determined_local_rules_for_columns.insert({ relation_type_t::MUST_NOT_BE_IN_COLUMN,i + 1 });
-					}
-					else if (utils::vector::isFull(columns[i]))
-					{
-						m_trace << "[8x87] goal must not be in column " << i << " at local 3x3 subboard\n";
-						determined_local_rules_for_columns.insert({ relation_type_t::MUST_NOT_BE_IN_COLUMN,i + 1 });
-					}
-				}
-
-				m_trace << "[8x77] determined <" << determined_local_rules_for_columns.size() << "> rules\n";
-				short allowed_column{ -5 };
-				if (determined_local_rules_for_columns.size() >= 2u)
-				{
-					std::set<size_t> forbidden_local_columns;
-					for (auto& [relation, col_no] : determined_local_rules_for_columns)
-						if (relation == relation_type_t::MUST_NOT_BE_IN_COLUMN)
-							forbidden_local_columns.insert(col_no);
-
-					short allowed_column_relative{ -5 };
-					for (auto val : { 1,2,3 })
-						if (!forbidden_local_columns.contains(val))
-							allowed_column_relative = val - 2;
-
-					allowed_column = allowed_column_relative + x.first;
-				}
-				if (allowed_column > -1)
+				m_trace << "[9x90] goal is possible at <" << hosts.count() << "> fields of unit <" << static_cast<std::int32_t>(unit) << ">\n";
+				bitboard_t seeing{ ~bitboard_t{} };
+				for (; hosts.any() && seeing.any(); hosts.popFirst())
+					seeing = seeing & m_graph->getPeerMask(hosts.first());
+				for (bitboard_t erased{ seeing & candidates }; erased.any(); erased.popFirst())
 				{
-					for (auto i{ 0u }; i < possibilities_board.getSize().second; i++)
-					{
-						pos_t current_position{ pos_t{allowed_column, i} };
-						if (utils::vector2d::getLocalCenter(current_position).first == x.first && utils::vector2d::getLocalCenter(current_position).second == x.second)
-							continue;
-						if (possibilities_board[current_position].count(goal) > 0u)
-						{
-							m_trace << "[3x33] erasing occurencies of <" << goal << "> in possibilities_board[" << static_cast<std::int32_t>(current_position.first) << ", " << static_cast<std::int32_t>(current_position.second) << "]\n";
-							possibilities_board[current_position].erase(goal);
-						}
-					}
+					const pos_t current_position{ bitboard_t::positionOf(erased.first()) };
+					m_trace << "[3x33] erasing occurencies of <" << goal << "> in possibilities_board[" << static_cast<std::int32_t>(current_position.first) << ", " << static_cast<std::int32_t>(current_position.second) << "]\n";
+					possibilities_board[current_position].erase(goal);
+					candidates.reset(erased.first());
 				}
 			}
 		}
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "Canonicalizer.h"
+#include "IncrementalValidator.h"
+#include "SolutionCounter.h"
+
+namespace malcolm
+{
+	/// @brief Thread-safe LRU cache of solutions of puzzles equal up to symmetry (see `Canonicalizer_t`).
+	/// @li Canonicalization costs more than solving an easy puzzle, so it's done only when it can pay off. Every puzzle first gets
+	/// cheap signature which is the same for all symmetric puzzles (numbers of givens in rows and columns grouped by bands and stacks,
+	/// in boxes and per value). Entries are grouped by signature, a puzzle whose signature isn't cached is a miss without
+	/// canonicalization, and the same puzzle requested again is found by exact comparison.
+	/// @li Only when an entry with equal signature but different givens exists, both puzzles are canonicalized (the entry only once)
+	/// and compared by canonical form. Solution of the entry is mapped back with inverse of the transform found for the request.
+	/// @li Entries are spread over independently locked shards, so concurrent solver threads rarely wait for each other.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class SolutionCache_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Flat representation of board, see `SolutionCounter_t`
+		using cells_t = SolutionCounter_t::cells_t;
+
+		/// Canonical puzzle packed to 4 bits per field
+		using key_t = std::string;
+
+		/// Value shared by all puzzles equal up to symmetry, see `signatureOf()`
+		using signature_t = std::uint64_t;
+
+		/// @brief Solved puzzle
+		struct entry_t
+		{
+			/// signature of `puzzle`
+			signature_t signature;
+			/// puzzle as it was requested first
+			cells_t puzzle;
+			/// solution of `puzzle`
+			cells_t solution;
+			/// canonical form of `puzzle`, empty until an entry with the same signature is requested
+			key_t key{};
+			/// `solution` mapped by transform found for `key`, valid only if `key` isn't empty
+			cells_t canonical_solution{};
+		};
+
+		/// Entries ordered from the most to the least recently used
+		using entries_t = std::list<entry_t>;
+
+		/// @brief Single independently locked part of the cache
+		struct shard_t
+		{
+			/// guards all members of the shard
+			std::mutex mutex;
+			/// entries ordered from the most to the least recently used
+			entries_t entries;
+			/// entries with given signature
+			std::unordered_map<signature_t, std::vector<typename entries_t::iterator>> index;
+		};
+
+	private:
+		/// @brief independently locked parts of the cache
+		std::vector<std::unique_ptr<shard_t>> m_shards;
+
+		/// @brief maximal number of entries in single shard
+		std::size_t m_shard_capacity;
+
+		/// @brief number of requests answered from the cache
+		std::atomic<std::size_t> m_hits{ 0u };
+
+		/// @brief number of requests passed to the solver
+		std::atomic<std::size_t> m_misses{ 0u };
+
+		/// @brief number of boards passed to `Canonicalizer_t`
+		std::atomic<std::size_t> m_canonicalized{ 0u };
+
+		/// @returns canonical puzzle packed to 4 bits per field
+		static key_t makeKey(const cells_t& cells)
+		{
+			key_t key(41u, '\0');
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				key[i >> 1] = static_cast<char>(key[i >> 1] | (cells[i] << ((i & 1u) << 2)));
+			return key;
+		}
+
+		/// @returns value which is the same for all boards equal up to symmetries handled by `Canonicalizer_t`:
+		/// numbers of givens per row within every band (sorted, bands sorted) and the same for columns - both taken in fixed order,
+		/// so transposition doesn't change it - together with sorted numbers of givens per box and per value
+		static signature_t signatureOf(const cells_t& cells)
+		{
+			std::array<std::uint8_t, 9> rows{}, columns{}, boxes{}, values{};
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				if (cells[i] != 0u)
+				{
+					rows[i / 9u]++;
+					columns[i % 9u]++;
+					boxes[i / 27u * 3u + i % 9u / 3u]++;
+					values[cells[i] - 1u]++;
+				}
+			auto pack = [](auto first, auto last)
+				{
+					std::uint64_t packed{ 0u };
+					for (; first != last; ++first)
+						packed = packed << 4 | *first;
+					return packed;
+				};
+			auto profile = [&pack](std::array<std::uint8_t, 9>& lines)
+				{
+					std::array<std::uint64_t, 3> bands;
+					for (std::size_t band{ 0u }; band < 3u; band++)
+					{
+						std::sort(lines.begin() + 3u * band, lines.begin() + 3u * band + 3u);
+						bands[band] = pack(lines.begin() + 3u * band, lines.begin() + 3u * band + 3u);
+					}
+					std::sort(bands.begin(), bands.end());
+					return bands[0] << 24 | bands[1] << 12 | bands[2];
+				};
+			const std::uint64_t row_profile{ profile(rows) }, column_profile{ profile(columns) };
+			std::sort(boxes.begin(), boxes.end());
+			std::sort(values.begin(), values.end());
+			// 36 bits of every part, mixed into 64 bits; collisions only cost a canonicalization
+			std::uint64_t signature{ std::min(row_profile, column_profile) * 0x9E3779B97F4A7C15u ^ std::max(row_profile, column_profile) };
+			signature = (signature ^ (signature >> 31)) * 0xBF58476D1CE4E5B9u ^ pack(boxes.begin(), boxes.end());
+			signature = (signature ^ (signature >> 29)) * 0x94D049BB133111EBu ^ pack(values.begin(), values.end());
+			return signature ^ (signature >> 32);
+		}
+
+		/// @returns shard responsible for given signature
+		shard_t& shardFor(signature_t signature)
+		{
+			return *m_shards[signature % m_shards.size()];
+		}
+
+		/// @returns canonical form of given board packed into key, `transform` receives symmetry mapping the board to it
+		key_t canonicalKey(const cells_t& cells, Canonicalizer_t::transform_t& transform)
+		{
+			thread_local Canonicalizer_t canonicalizer;
+			m_canonicalized.fetch_add(1u, std::memory_order_relaxed);
+			return makeKey(canonicalizer.canonicalize(cells, transform));
+		}
+
+		/// @brief Looks up puzzle among cached entries with its signature, caller holds lock of the shard
+		/// @param key canonical form of the puzzle, empty if not computed yet
+		/// @param transform symmetry mapping the puzzle to `key`, valid only if `key` isn't empty
+		/// @returns solution of the puzzle, empty if it isn't cached
+		/// @returns true in `needs_key` if the puzzle wasn't found, but could be found by its canonical form
+		std::optional<cells_t> find(shard_t& shard, signature_t signature, const cells_t& puzzle, const key_t& key, const Canonicalizer_t::transform_t& transform, bool& needs_key)
+		{
+			needs_key = false;
+			auto bucket{ shard.index.find(signature) };
+			if (bucket == shard.index.end())
+				return std::nullopt;
+			for (auto entry : bucket->second)
+				if (entry->puzzle == puzzle)
+				{
+					shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+					return entry->solution;
+				}
+			if (key.empty())
+			{
+				needs_key = true;
+				return std::nullopt;
+			}
+			for (auto entry : bucket->second)
+			{
+				if (entry->key.empty())
+				{
+					Canonicalizer_t::transform_t entry_transform;
+					entry->key = canonicalKey(entry->puzzle, entry_transform);
+					entry->canonical_solution = entry_transform.apply(entry->solution);
+				}
+				if (entry->key == key)
+				{
+					shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+					return transform.invert(entry->canonical_solution);
+				}
+			}
+			return std::nullopt;
+		}
+
+	public:
+		/// @param capacity maximal number of stored solutions
+		/// @param shards number of independently locked parts
+		SolutionCache_t(std::size_t capacity, std::size_t shards = 16u)
+			: m_shard_capacity{ std::max<std::size_t>(1u, capacity / std::max<std::size_t>(1u, shards)) }
+		{
+			for (std::size_t i{ 0u }; i < std::max<std::size_t>(1u, shards); i++)
+				m_shards.push_back(std::make_unique<shard_t>());
+		}
+
+		/// @brief Returns solution of puzzle, calling `solve` only if no symmetric puzzle was solved before
+		/// @param puzzle 9x9 board to be solved
+		/// @param solve function solving the puzzle; its result is cached only if it's filled and consistent with the puzzle
+		/// @returns solution of the puzzle
+		Board_t<value_t> getSolved(const Board_t<value_t>& puzzle, const std::function<Board_t<value_t>(const Board_t<value_t>&)>& solve)
+		{
+			const cells_t puzzle_cells{ SolutionCounter_t::toCells(puzzle) };
+			const signature_t signature{ signatureOf(puzzle_cells) };
+			shard_t& shard{ shardFor(signature) };
+			key_t key;
+			Canonicalizer_t::transform_t transform;
+			bool needs_key{ false };
+			{
+				std::lock_guard<std::mutex> lock{ shard.mutex };
+				if (auto found{ find(shard, signature, puzzle_cells, key, transform, needs_key) })
+				{
+					m_hits.fetch_add(1u, std::memory_order_relaxed);
+					return SolutionCounter_t::toBoard<value_t>(*found);
+				}
+			}
+			if (needs_key)
+			{
+				key = canonicalKey(puzzle_cells, transform); // outside of the lock, the entries get their keys under it
+				std::lock_guard<std::mutex> lock{ shard.mutex };
+				if (auto found{ find(shard, signature, puzzle_cells, key, transform, needs_key) })
+				{
+					m_hits.fetch_add(1u, std::memory_order_relaxed);
+					return SolutionCounter_t::toBoard<value_t>(*found);
+				}
+			}
+			m_misses.fetch_add(1u, std::memory_order_relaxed);
+
+			Board_t<value_t> solution{ solve(puzzle) };
+			cells_t solution_cells{ SolutionCounter_t::toCells(solution) };
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				if (solution_cells[i] == 0u || (puzzle_cells[i] != 0u && puzzle_cells[i] != solution_cells[i]))
+					return solution;
+			if (!IncrementalValidator_t<value_t>(solution).isConsistent()) // filled, but with duplicates
+				return solution;
+
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			auto& bucket{ shard.index[signature] };
+			for (auto entry : bucket)
+				if (entry->puzzle == puzzle_cells || (!key.empty() && entry->key == key))
+					return solution;
+			shard.entries.push_front({ signature, puzzle_cells, solution_cells, key, key.empty() ? cells_t{} : transform.apply(solution_cells) });
+			bucket.push_back(shard.entries.begin());
+			if (shard.entries.size() > m_shard_capacity)
+			{
+				auto evicted{ std::prev(shard.entries.end()) };
+				auto& evicted_bucket{ shard.index[evicted->signature] };
+				std::erase(evicted_bucket, evicted);
+				if (evicted_bucket.empty())
+					shard.index.erase(evicted->signature);
+				shard.entries.pop_back();
+			}
+			return solution;
+		}
+
+		/// @returns number of requests answered from the cache
+		inline std::size_t getHits() const { return m_hits.load(); }
+
+		/// @returns number of requests passed to the solver
+		inline std::size_t getMisses() const { return m_misses.load(); }
+
+		/// @returns number of boards which had to be canonicalized, i.e. requests and entries sharing signature with another puzzle
+		inline std::size_t getCanonicalized() const { return m_canonicalized.load(); }
+	};
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "Types.h"
+#include "Board.h"
+
+namespace malcolm
+{
+	/// @brief Fast backtracking search over bitmasks of used values, used where only number of solutions matters
+	/// (e.g. uniqueness checks during puzzle generation).
+	/// @li Fields are indexed row by row: index = 9 * y + x, value 0 means empty field.
+	/// @li Search always continues in the field with minimal number of candidates.
+	class SolutionCounter_t
+	{
+	public:
+		/// Flat representation of 9x9 board
+		using cells_t = std::array<std::uint8_t, 81>;
+
+	private:
+		/// @brief masks of values used in rows, columns and subboards (bit v-1 for value v)
+		std::array<std::uint16_t, 9> m_rows{}, m_columns{}, m_subboards{};
+
+		/// @brief current state of search
+		cells_t m_cells{};
+
+		/// @brief number of solutions found so far
+		std::size_t m_found{ 0u };
+
+		/// @brief search stops when `m_found` reaches this value
+		std::size_t m_limit{ 2u };
+
+		/// @brief optional place where first found solution is stored
+		cells_t* m_solution{ nullptr };
+
+		/// @returns index of subboard containing field with given index
+		static constexpr std::size_t subboardOf(std::size_t index) { return (index / 27u) * 3u + (index % 9u) / 3u; }
+
+		/// @returns mask of values allowed at given field
+		inline std::uint16_t candidates(std::size_t index) const
+		{
+			return static_cast<std::uint16_t>(~(m_rows[index / 9u] | m_columns[index % 9u] | m_subboards[subboardOf(index)]) & 0x1FFu);
+		}
+
+		/// @brief sets or clears value bit in masks of all units containing given field
+		inline void toggle(std::size_t index, std::uint16_t bit)
+		{
+			m_rows[index / 9u] ^= bit;
+			m_columns[index % 9u] ^= bit;
+			m_subboards[subboardOf(index)] ^= bit;
+		}
+
+		/// @brief recursive part of the search
+		void search()
+		{
+			std::size_t best_index{ 81u };
+			int best_count{ 10 };
+			std::uint16_t best_mask{ 0u };
+			for (std::size_t i{ 0u }; i < 81u; i++)
+			{
+				if (m_cells[i] != 0u)
+					continue;
+				std::uint16_t mask{ candidates(i) };
+				int count{ std::popcount(mask) };
+				if (count < best_count)
+				{
+					best_index = i;
+					best_count = count;
+					best_mask = mask;
+					if (count <= 1)
+						break;
+				}
+			}
+			if (best_index == 81u)
+			{
+				if (m_found++ == 0u && m_solution)
+					*m_solution = m_cells;
+				return;
+			}
+			while (best_mask != 0u && m_found < m_limit)
+			{
+				std::uint16_t bit{ static_cast<std::uint16_t>(best_mask & -best_mask) };
+				best_mask ^= bit;
+				m_cells[best_index] = static_cast<std::uint8_t>(std::countr_zero(bit) + 1);
+				toggle(best_index, bit);
+				search();
+				toggle(best_index, bit);
+			}
+			m_cells[best_index] = 0u;
+		}
+
+	public:
+		/// @brief Counts solutions of given board, stopping as soon as `limit` solutions were found
+		/// @param cells board to be solved
+		/// @param limit maximal number of solutions to look for, 2 is enough to check uniqueness
+		/// @param solution if not nullptr, receives first found solution
+		/// @returns number of found solutions (at most `limit`), 0 if board is contradictory
+		std::size_t count(const cells_t& cells, std::size_t limit = 2u, cells_t* solution = nullptr)
+		{
+			m_rows.fill(0u);
+			m_columns.fill(0u);
+			m_subboards.fill(0u);
+			m_cells = cells;
+			m_found = 0u;
+			m_limit = limit;
+			m_solution = solution;
+			for (std::size_t i{ 0u }; i < 81u; i++)
+			{
+				if (m_cells[i] == 0u)
+					continue;
+				std::uint16_t bit{ static_cast<std::uint16_t>(1u << (m_cells[i] - 1u)) };
+				if ((m_rows[i / 9u] | m_columns[i % 9u] | m_subboards[subboardOf(i)]) & bit)
+					return 0u;
+				toggle(i, bit);
+			}
+			search();
+			return m_found;
+		}
+
+		/// @brief Converts `Board_t` into flat representation used by `count()`
+		/// @tparam T type of data stored in board
+		template<typename T>
+		static cells_t toCells(const Board_t<T>& board)
+		{
+			cells_t cells{};
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				cells[i] = static_cast<std::uint8_t>(board[{ static_cast<size_t>(i % 9u), static_cast<size_t>(i / 9u) }]);
+			return cells;
+		}
+
+		/// @brief Converts flat representation back into `Board_t`
+		/// @tparam T type of data stored in board
+		template<typename T>
+		static Board_t<T> toBoard(const cells_t& cells)
+		{
+			Board_t<T> board(9u, 9u);
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				board[{ static_cast<size_t>(i % 9u), static_cast<size_t>(i / 9u) }] = static_cast<T>(cells[i]);
+			return board;
+		}
+	};
+}
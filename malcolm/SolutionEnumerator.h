@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Types.h"
+#include "Board.h"
+#include "Bitboard.h"
+#include "ConstraintGraph.h"
+#include "Generator.h"
+
+namespace malcolm
+{
+	/// @brief Lazily enumerates all solutions of 9x9 board, e.g. of under-constrained patterns during puzzle design.
+	/// @li Solutions are yielded one by one as soon as they are found. Search is suspended between them and does no work
+	/// for solutions which are never pulled - stop iterating (or destroy the generator) to stop the search.
+	/// @li Backtracking keeps its state in fixed-size arrays and an explicit stack of at most 81 frames instead of recursion,
+	/// so memory use doesn't depend on the number of solutions.
+	/// @li Search always continues in the field with minimal number of candidates, as in `SolutionCounter_t`, but over units
+	/// and extra peers of given `ConstraintGraph_t`, so variants can be enumerated too.
+	/// @li Nothing is yielded for boards with conflicting givens.
+	/// @tparam T type of data stored in board
+	/// @param board board to be solved, copied into the coroutine state
+	/// @param graph units and peers of the board, nullptr for classic sudoku
+	/// @returns generator of solved boards
+	template<typename T>
+	utils::Generator_t<Board_t<T>> enumerateSolutions(Board_t<T> board, std::shared_ptr<const ConstraintGraph_t> graph = nullptr)
+	{
+		/// @brief Field being guessed: its index and values not tried yet
+		struct frame_t
+		{
+			std::uint8_t index;
+			std::uint16_t remaining;
+		};
+
+		if (!graph)
+			graph = ConstraintGraph_t::classic();
+		std::array<std::uint8_t, ConstraintGraph_t::field_count> cells{};
+		std::vector<std::uint16_t> used(graph->getUnitCount(), 0u); // bit v - 1 set if value v is in the unit
+
+		auto candidates = [&](std::size_t index)
+			{
+				std::uint16_t taken{ 0u };
+				for (auto unit : graph->getUnitsOf(index))
+					taken |= used[unit];
+				for (auto peer : graph->getExtraPeers(index))
+					if (cells[peer] != 0u)
+						taken |= static_cast<std::uint16_t>(1u << (cells[peer] - 1u));
+				return static_cast<std::uint16_t>(~taken & 0x1FFu);
+			};
+		auto toggle = [&](std::size_t index, std::uint16_t bit)
+			{
+				for (auto unit : graph->getUnitsOf(index))
+					used[unit] ^= bit;
+			};
+
+		for (std::size_t index{ 0u }; index < ConstraintGraph_t::field_count; index++)
+		{
+			const auto value{ static_cast<std::uint8_t>(board[bitboard_t::positionOf(index)]) };
+			if (value == 0u)
+				continue;
+			if (value > 9u || !(candidates(index) & (1u << (value - 1u))))
+				co_return;
+			const std::uint16_t bit{ static_cast<std::uint16_t>(1u << (value - 1u)) };
+			cells[index] = value;
+			toggle(index, bit);
+		}
+
+		std::array<frame_t, ConstraintGraph_t::field_count> stack{};
+		std::size_t depth{ 0u };
+		bool descend{ true };
+		while (true)
+		{
+			if (descend)
+			{
+				std::size_t best_index{ ConstraintGraph_t::field_count };
+				int best_count{ 10 };
+				std::uint16_t best_mask{ 0u };
+				for (std::size_t i{ 0u }; i < ConstraintGraph_t::field_count && best_count > 0; i++)
+				{
+					if (cells[i] != 0u)
+						continue;
+					const std::uint16_t mask{ candidates(i) };
+					const int count{ std::popcount(mask) };
+					if (count < best_count)
+					{
+						best_index = i;
+						best_count = count;
+						best_mask = mask;
+					}
+				}
+				if (best_index == ConstraintGraph_t::field_count)
+				{
+					for (std::size_t i{ 0u }; i < ConstraintGraph_t::field_count; i++)
+						board[bitboard_t::positionOf(i)] = static_cast<T>(cells[i]);
+					co_yield board;
+				}
+				else
+					stack[depth++] = { static_cast<std::uint8_t>(best_index), best_mask };
+			}
+
+			descend = false;
+			while (depth > 0u && !descend) // undo the last guess and try the next value, going up while frames are exhausted
+			{
+				frame_t& top{ stack[depth - 1u] };
+				if (cells[top.index] != 0u)
+				{
+					toggle(top.index, static_cast<std::uint16_t>(1u << (cells[top.index] - 1u)));
+					cells[top.index] = 0u;
+				}
+				if (top.remaining == 0u)
+				{
+					depth--;
+					continue;
+				}
+				const std::uint16_t bit{ static_cast<std::uint16_t>(top.remaining & -top.remaining) };
+				top.remaining ^= bit;
+				cells[top.index] = static_cast<std::uint8_t>(std::countr_zero(bit) + 1);
+				toggle(top.index, bit);
+				descend = true;
+			}
+			if (!descend)
+				co_return;
+		}
+	}
+}
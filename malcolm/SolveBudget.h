@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include "Board.h"
+
+namespace malcolm
+{
+	/// @brief Limits of single solve, see `BoardSolver_t::getSolved(const solve_budget_t&)`
+	struct solve_budget_t
+	{
+		/// solving stops when this point in time is reached
+		std::chrono::steady_clock::time_point deadline{ std::chrono::steady_clock::time_point::max() };
+		/// solving stops after this number of nodes (insertions, elimination rounds and bruteforce scenarios)
+		std::size_t max_nodes{ std::numeric_limits<std::size_t>::max() };
+		/// solving stops as soon as the flag is set, nullptr if solve can't be cancelled
+		const std::atomic<bool>* cancel_token{ nullptr };
+		/// deadline and cancellation are checked once per this number of nodes
+		std::size_t check_interval{ 64u };
+
+		/// @returns budget with deadline set given time from now
+		static solve_budget_t withTimeout(std::chrono::nanoseconds timeout)
+		{
+			solve_budget_t budget;
+			budget.deadline = std::chrono::steady_clock::now() + timeout;
+			return budget;
+		}
+	};
+
+	/// @brief Outcome of budgeted solve
+	enum class solve_status_t : std::uint8_t
+	{
+		/// board is filled
+		SOLVED,
+		/// board has no solution
+		UNSAT,
+		/// deadline or node limit was reached
+		TIMED_OUT,
+		/// cancel token was set
+		CANCELLED,
+		/// solver ran out of strategies before filling the board
+		UNSOLVED
+	};
+
+	/// @returns name of status used in reports
+	inline const char* toString(solve_status_t status)
+	{
+		switch (status)
+		{
+		case solve_status_t::SOLVED: return "solved";
+		case solve_status_t::UNSAT: return "unsat";
+		case solve_status_t::TIMED_OUT: return "timed_out";
+		case solve_status_t::CANCELLED: return "cancelled";
+		default: return "unsolved";
+		}
+	}
+
+	/// @brief Result of budgeted solve
+	/// @tparam T type of data stored in board
+	template<typename T>
+	struct solve_result_t
+	{
+		/// how solving ended
+		solve_status_t status;
+		/// solution, or the most filled board reached before solving stopped
+		Board_t<T> board;
+		/// number of nodes visited
+		std::size_t nodes;
+	};
+
+	/// @brief Counts nodes of single solve and decides when its budget is exhausted. Shared by solver and all its bruteforce scenarios.
+	/// @li Node limit is checked on every node, clock and cancel token only every `check_interval` nodes.
+	class SolveBudgetTracker_t
+	{
+	private:
+		/// @brief limits given in constructor
+		solve_budget_t m_budget;
+
+		/// @brief nodes visited so far
+		std::size_t m_nodes{ 0u };
+
+		/// @brief nodes left until the next check of clock and cancel token
+		std::size_t m_until_check;
+
+		/// @brief reason of stop, `solve_status_t::SOLVED` while budget isn't exhausted
+		solve_status_t m_stop_reason{ solve_status_t::SOLVED };
+
+	public:
+		explicit SolveBudgetTracker_t(const solve_budget_t& budget)
+			: m_budget{ budget }, m_until_check{ 0u }
+		{
+		}
+
+		/// @brief Counts next node
+		/// @returns false if budget is exhausted and solving should stop
+		bool step()
+		{
+			if (m_stop_reason != solve_status_t::SOLVED)
+				return false;
+			if (++m_nodes > m_budget.max_nodes)
+			{
+				m_stop_reason = solve_status_t::TIMED_OUT;
+				return false;
+			}
+			if (m_until_check-- == 0u)
+			{
+				m_until_check = m_budget.check_interval;
+				if (m_budget.cancel_token != nullptr && m_budget.cancel_token->load(std::memory_order_relaxed))
+					m_stop_reason = solve_status_t::CANCELLED;
+				else if (std::chrono::steady_clock::now() >= m_budget.deadline)
+					m_stop_reason = solve_status_t::TIMED_OUT;
+			}
+			return m_stop_reason == solve_status_t::SOLVED;
+		}
+
+		/// @returns true if budget is exhausted
+		inline bool isExhausted() const { return m_stop_reason != solve_status_t::SOLVED; }
+
+		/// @returns `solve_status_t::TIMED_OUT` or `solve_status_t::CANCELLED` if budget is exhausted, `solve_status_t::SOLVED` otherwise
+		inline solve_status_t getStopReason() const { return m_stop_reason; }
+
+		/// @returns number of nodes visited so far
+		inline std::size_t getNodes() const { return m_nodes; }
+	};
+}
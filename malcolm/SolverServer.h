@@ -0,0 +1,429 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Board.h"
+#include "BoardSolver.h"
+#include "BoardSerializer.h"
+#include "SolveBudget.h"
+#include "BoundedQueue.h"
+#include "LatencyHistogram.h"
+
+namespace malcolm
+{
+	/// @brief Framing of messages exchanged by `SolverServer_t` and `LoadGenerator_t` over stream socket, all integers little endian
+	/// @li request: u32 id chosen by client, 41 bytes of 9x9 puzzle packed with `BoardCodec_t::packNibbles()`
+	/// @li response: u32 id of request, u8 status (`solve_status_t` or `malformed_status`), 41 bytes of packed board
+	/// @li responses on single connection may come in different order than requests
+	struct solver_protocol_t
+	{
+		/// size of packed 9x9 board
+		static constexpr std::size_t board_size{ 41u };
+		/// size of single request
+		static constexpr std::size_t request_size{ 4u + board_size };
+		/// size of single response
+		static constexpr std::size_t response_size{ 5u + board_size };
+		/// status of response to request containing values out of range 0-9
+		static constexpr std::uint8_t malformed_status{ 0xFFu };
+	};
+
+#ifndef _WIN32
+	namespace detail
+	{
+		/// @brief Reads exactly `size` bytes from socket
+		/// @returns false if connection was closed or broken before
+		inline bool readFully(int fd, std::uint8_t* data, std::size_t size)
+		{
+			while (size > 0u)
+			{
+				auto received{ ::recv(fd, data, size, 0) };
+				if (received <= 0)
+					return false;
+				data += received;
+				size -= static_cast<std::size_t>(received);
+			}
+			return true;
+		}
+
+		/// @brief Writes exactly `size` bytes to socket
+		/// @returns false if connection was closed or broken before
+		inline bool writeFully(int fd, const std::uint8_t* data, std::size_t size)
+		{
+			while (size > 0u)
+			{
+				auto sent{ ::send(fd, data, size, MSG_NOSIGNAL) };
+				if (sent <= 0)
+					return false;
+				data += sent;
+				size -= static_cast<std::size_t>(sent);
+			}
+			return true;
+		}
+
+		/// @returns address of Unix domain socket with given path
+		inline sockaddr_un makeAddress(const std::string& path)
+		{
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+			if (path.size() >= sizeof(address.sun_path))
+				throw std::invalid_argument("socket path too long: " + path);
+			std::memcpy(address.sun_path, path.c_str(), path.size() + 1u);
+			return address;
+		}
+	}
+
+	/// @brief Settings of `SolverServer_t`
+	struct server_config_t
+	{
+		/// number of solving threads, every one keeps its own buffers for whole lifetime of the server
+		std::size_t threads{ std::max(1u, std::thread::hardware_concurrency()) };
+		/// maximal number of requests solved by one thread before responses are sent
+		std::size_t batch_size{ 32u };
+		/// time a thread waits for more requests after the first one of a batch arrived
+		std::chrono::microseconds batch_window{ 200 };
+		/// capacity of queue of received requests, readers wait when it's full
+		std::size_t queue_capacity{ 4096u };
+		/// maximal number of unanswered requests of single connection, its reader waits until some of them are answered
+		std::size_t connection_requests{ 256u };
+		/// time a write of responses may block, client which doesn't read them for so long is disconnected; 0 means no limit
+		std::chrono::milliseconds write_timeout{ 1000 };
+		/// time limit of single puzzle, 0 means no limit
+		std::chrono::milliseconds time_limit{ 0 };
+		/// interval of statistics printed while running, 0 disables them
+		std::chrono::seconds statistics_interval{ 0 };
+	};
+
+	/// @brief Long running solver serving requests (see `solver_protocol_t`) on Unix domain socket.
+	/// @li Every connection has its own reader thread which only splits incoming bytes into requests and queues them.
+	/// @li Solving threads take requests in micro-batches: after the first request they collect whatever arrives
+	/// within `batch_window` (up to `batch_size` requests), solve them and send responses grouped by connection,
+	/// so requests arriving close together cost one write per connection instead of one per request.
+	/// @li Every connection may have at most `connection_requests` unanswered requests, so a client which doesn't read its
+	/// responses stops being read too and can't fill the queue. Writes block for at most `write_timeout`, a client which
+	/// doesn't read for so long is disconnected and the rest of its requests is dropped, so it can't stall solving threads.
+	/// @li Latency (from receiving request to sending response) and throughput are collected per solving thread.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class SolverServer_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+		/// @brief Accepted client connection, closed when the last request referring to it is answered
+		struct connection_t
+		{
+			int fd;
+			/// serializes responses written by different solving threads
+			std::mutex write_mutex;
+			/// set by reader thread when client disconnected
+			std::atomic<bool> finished{ false };
+			/// set when writing responses failed or timed out, remaining requests are dropped
+			std::atomic<bool> broken{ false };
+			/// protects `pending`
+			std::mutex pending_mutex;
+			/// signalled when `pending` decreased or connection broke
+			std::condition_variable pending_changed;
+			/// number of requests read but not answered yet
+			std::size_t pending{ 0u };
+
+			explicit connection_t(int descriptor) : fd{ descriptor } { }
+			~connection_t() { ::close(fd); }
+		};
+
+		/// @brief Single received request
+		struct request_t
+		{
+			std::shared_ptr<connection_t> connection;
+			std::uint32_t id{ 0u };
+			std::array<std::uint8_t, solver_protocol_t::board_size> puzzle{};
+			std::chrono::steady_clock::time_point arrival;
+		};
+
+		/// @brief State owned by single solving thread and reused for every batch
+		struct worker_context_t
+		{
+			/// requests of current batch
+			std::vector<request_t> batch;
+			/// responses of current batch, grouped by connection
+			std::vector<std::uint8_t> output;
+			/// latencies (in nanoseconds) of requests answered since the last report, recorded only by owning thread
+			utils::LatencyHistogram_t interval;
+			/// latencies of all requests answered since start
+			utils::LatencyHistogram_t total;
+			/// number of answered batches since start
+			std::atomic<std::size_t> batches{ 0u };
+			/// orders strategies for all requests solved by owning thread
+			std::shared_ptr<StrategyScheduler_t> scheduler{ std::make_shared<StrategyScheduler_t>() };
+		};
+
+	private:
+		/// @brief path of listening socket
+		std::string m_path;
+
+		/// @brief settings given in constructor
+		server_config_t m_config;
+
+		/// @brief requests waiting for solving threads
+		utils::BoundedQueue_t<request_t> m_requests;
+
+		/// @brief per-thread state of solving threads
+		std::vector<std::unique_ptr<worker_context_t>> m_contexts;
+
+		/// @brief time of the last statistics report
+		std::chrono::steady_clock::time_point m_last_report;
+
+		/// @brief time when the server started listening
+		std::chrono::steady_clock::time_point m_start;
+
+		/// @brief Reads requests from connection until client disconnects
+		void readConnection(std::shared_ptr<connection_t> connection)
+		{
+			std::vector<std::uint8_t> buffer(64u * solver_protocol_t::request_size);
+			std::size_t filled{ 0u };
+			for (;;)
+			{
+				auto received{ ::recv(connection->fd, buffer.data() + filled, buffer.size() - filled, 0) };
+				if (received <= 0)
+					break;
+				filled += static_cast<std::size_t>(received);
+				const auto now{ std::chrono::steady_clock::now() };
+				std::size_t offset{ 0u };
+				for (; filled - offset >= solver_protocol_t::request_size; offset += solver_protocol_t::request_size)
+				{
+					{
+						std::unique_lock<std::mutex> lock{ connection->pending_mutex };
+						connection->pending_changed.wait(lock, [&]() { return connection->pending < m_config.connection_requests || connection->broken; });
+						if (connection->broken)
+							break;
+						connection->pending++;
+					}
+					request_t request;
+					request.connection = connection;
+					request.id = detail::loadU32(buffer.data() + offset);
+					std::memcpy(request.puzzle.data(), buffer.data() + offset + 4u, solver_protocol_t::board_size);
+					request.arrival = now;
+					m_requests.push(std::move(request));
+				}
+				if (connection->broken)
+					break;
+				std::memmove(buffer.data(), buffer.data() + offset, filled - offset);
+				filled -= offset;
+			}
+			connection->finished = true;
+		}
+
+		/// @brief Writes responses of `count` requests to their connection, disconnects client if writing fails or times out
+		void respond(connection_t& connection, const std::vector<std::uint8_t>& output, std::size_t count)
+		{
+			{
+				std::lock_guard<std::mutex> lock{ connection.write_mutex };
+				if (!connection.broken && !detail::writeFully(connection.fd, output.data(), output.size()))
+				{
+					connection.broken = true;
+					::shutdown(connection.fd, SHUT_RDWR); // wakes reader blocked in recv()
+				}
+			}
+			{
+				std::lock_guard<std::mutex> lock{ connection.pending_mutex };
+				connection.pending -= count;
+			}
+			connection.pending_changed.notify_all();
+		}
+
+		/// @brief Solves single request and appends response to `output`
+		void answer(const request_t& request, std::vector<std::uint8_t>& output, const std::shared_ptr<StrategyScheduler_t>& scheduler) const
+		{
+			std::uint8_t status{ solver_protocol_t::malformed_status };
+			Board_t board{ BoardCodec_t<value_t>::unpackNibbles(request.puzzle.data(), 9u) };
+			if (board.count([](const value_t& value) { return value > static_cast<value_t>(9); }) == 0u)
+			{
+				solve_budget_t budget{ m_config.time_limit.count() > 0 ? solve_budget_t::withTimeout(m_config.time_limit) : solve_budget_t{} };
+				auto result{ malcolm::solve(board, budget, scheduler) };
+				status = static_cast<std::uint8_t>(result.status);
+				board = std::move(result.board);
+			}
+			const std::size_t offset{ output.size() };
+			output.resize(offset + solver_protocol_t::response_size);
+			detail::storeU32(output.data() + offset, request.id);
+			output[offset + 4u] = status;
+			BoardCodec_t<value_t>::packNibbles(board, output.data() + offset + 5u); // can't fail, values come from 4-bit fields or solver
+		}
+
+		/// @brief Main loop of solving thread
+		void work(worker_context_t& context)
+		{
+			request_t first;
+			while (m_requests.pop(first))
+			{
+				context.batch.clear();
+				context.batch.push_back(std::move(first));
+				const auto window_end{ std::chrono::steady_clock::now() + m_config.batch_window };
+				while (context.batch.size() < m_config.batch_size)
+				{
+					request_t next;
+					if (m_requests.tryPop(next))
+						context.batch.push_back(std::move(next));
+					else if (std::chrono::steady_clock::now() < window_end)
+						std::this_thread::yield();
+					else
+						break;
+				}
+
+				std::stable_sort(context.batch.begin(), context.batch.end(), [](const request_t& a, const request_t& b) { return a.connection.get() < b.connection.get(); });
+				for (auto group_begin{ context.batch.begin() }; group_begin != context.batch.end();)
+				{
+					auto group_end{ std::find_if(group_begin, context.batch.end(), [&](const request_t& request) { return request.connection != group_begin->connection; }) };
+					context.output.clear();
+					if (!group_begin->connection->broken)
+						for (auto it{ group_begin }; it != group_end; it++)
+							answer(*it, context.output, context.scheduler);
+					respond(*group_begin->connection, context.output, static_cast<std::size_t>(group_end - group_begin));
+					group_begin = group_end;
+				}
+
+				const auto now{ std::chrono::steady_clock::now() };
+				for (const auto& request : context.batch)
+				{
+					auto latency{ static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - request.arrival).count()) };
+					context.interval.record(latency);
+					context.total.record(latency);
+				}
+				context.batches.fetch_add(1u, std::memory_order_relaxed);
+				context.batch.clear(); // releases connections
+			}
+		}
+
+	public:
+		/// @param path path of Unix domain socket, existing file is replaced
+		/// @param config settings of the server
+		SolverServer_t(const std::string& path, const server_config_t& config)
+			: m_path{ path }, m_config{ config }, m_requests{ config.queue_capacity }
+		{
+			m_config.threads = std::max<std::size_t>(1u, m_config.threads);
+			m_config.batch_size = std::max<std::size_t>(1u, m_config.batch_size);
+			m_config.connection_requests = std::max<std::size_t>(1u, m_config.connection_requests);
+			for (std::size_t i{ 0u }; i < m_config.threads; i++)
+				m_contexts.push_back(std::make_unique<worker_context_t>());
+		}
+
+		/// @brief Serves requests until `stop` is set
+		/// @param stop flag checked a few times per second
+		/// @param report stream receiving periodic and final statistics
+		void run(const std::atomic<bool>& stop, std::ostream& report)
+		{
+			int listener{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+			if (listener < 0)
+				throw std::runtime_error("can't create socket");
+			sockaddr_un address{ detail::makeAddress(m_path) };
+			::unlink(m_path.c_str());
+			if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 128) != 0)
+			{
+				::close(listener);
+				throw std::runtime_error("can't listen on " + m_path);
+			}
+
+			m_start = std::chrono::steady_clock::now();
+			m_last_report = m_start;
+			std::vector<std::thread> workers;
+			for (auto& context : m_contexts)
+				workers.emplace_back([this, &context]() { work(*context); });
+
+			std::vector<std::pair<std::thread, std::shared_ptr<connection_t>>> readers;
+			while (!stop.load())
+			{
+				pollfd descriptor{ listener, POLLIN, 0 };
+				if (::poll(&descriptor, 1, 200) > 0 && (descriptor.revents & POLLIN))
+				{
+					int client{ ::accept(listener, nullptr, nullptr) };
+					if (client >= 0)
+					{
+						if (m_config.write_timeout.count() > 0)
+						{
+							timeval timeout{ static_cast<time_t>(m_config.write_timeout.count() / 1000), static_cast<suseconds_t>(m_config.write_timeout.count() % 1000 * 1000) };
+							::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+						}
+						auto connection{ std::make_shared<connection_t>(client) };
+						readers.emplace_back(std::thread([this, connection]() { readConnection(connection); }), connection);
+					}
+				}
+				for (auto it{ readers.begin() }; it != readers.end();) // forget disconnected clients
+				{
+					if (it->second->finished)
+					{
+						it->first.join();
+						it = readers.erase(it);
+					}
+					else
+						it++;
+				}
+				if (m_config.statistics_interval.count() > 0 && std::chrono::steady_clock::now() - m_last_report >= m_config.statistics_interval)
+					printStatistics(report);
+			}
+
+			::close(listener);
+			::unlink(m_path.c_str());
+			for (auto& [reader, connection] : readers)
+				::shutdown(connection->fd, SHUT_RD);
+			for (auto& [reader, connection] : readers)
+				reader.join();
+			readers.clear();
+			m_requests.close();
+			for (auto& worker : workers)
+				worker.join();
+			printStatistics(report);
+			printStatistics(report, true);
+		}
+
+		/// @brief Prints number of answered requests, throughput, latency percentiles and average batch size
+		/// @param out destination stream
+		/// @param since_start if false, counters since the previous report are printed and reset, otherwise counters since start
+		void printStatistics(std::ostream& out, bool since_start = false)
+		{
+			utils::LatencyHistogram_t merged;
+			std::size_t batches{ 0u }, requests{ 0u };
+			for (auto& context : m_contexts)
+			{
+				merged.merge(since_start ? context->total : context->interval);
+				if (!since_start)
+					context->interval.reset();
+				requests += context->total.count();
+				batches += context->batches.load(std::memory_order_relaxed);
+			}
+			const auto now{ std::chrono::steady_clock::now() };
+			const double seconds{ std::chrono::duration<double>(now - (since_start ? m_start : m_last_report)).count() };
+			if (!since_start)
+				m_last_report = now;
+
+			out << std::fixed << std::setprecision(1)
+				<< (since_start ? "total: " : "") << "requests " << merged.count()
+				<< "  throughput " << (seconds > 0.0 ? merged.count() / seconds : 0.0) << "/s  ";
+			merged.printSummary(out, 1e3, "us");
+			out << "  avg batch " << (batches > 0u ? static_cast<double>(requests) / batches : 0.0) << "\n";
+		}
+	};
+#endif
+}
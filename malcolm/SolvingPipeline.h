@@ -0,0 +1,574 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "BoardSolver.h"
+#include "SatBoardSolver.h"
+#include "IncrementalValidator.h"
+#include "ConstraintGraph.h"
+#include "BoardSerializer.h"
+#include "SolutionCache.h"
+#include "SolutionCounter.h"
+#include "PuzzleIndex.h"
+#include "BoundedQueue.h"
+#include "LatencyHistogram.h"
+
+namespace malcolm
+{
+	/// @brief Format of results produced by the last stage of `SolvingPipeline_t`
+	enum class pipeline_output_t
+	{
+		/// One line per puzzle: 81 characters of solved board ('.' for empty field), space and validation result (0/1),
+		/// or `rejected_status` after empty board for line which couldn't be parsed
+		TEXT,
+		/// Solved boards written with `BoardWriter_t` (`board_encoding_t::NIBBLE_PACKED`), empty board for line which couldn't be parsed
+		BINARY
+	};
+
+	/// @brief Solver used by solving stage of `SolvingPipeline_t`
+	enum class solver_backend_t
+	{
+		/// `BoardSolver_t`
+		STRATEGIES,
+		/// `SatBoardSolver_t`
+		SAT
+	};
+
+	/// @brief Character written by `pipeline_output_t::TEXT` instead of validation result for rejected input line
+	inline constexpr char rejected_status{ 'R' };
+
+	/// @brief Size of every line written by `pipeline_output_t::TEXT`, newline included
+	inline constexpr std::size_t text_result_size{ 84u };
+
+	/// @brief Settings of `SolvingPipeline_t`
+	struct pipeline_config_t
+	{
+		/// number of threads running `BoardSolver_t`
+		std::size_t solve_threads{ std::max(1u, std::thread::hardware_concurrency()) };
+		/// number of threads running `IncrementalValidator_t`
+		std::size_t validate_threads{ 1u };
+		/// capacity of every queue between stages, bounds number of boards kept in memory
+		std::size_t queue_capacity{ 1024u };
+		/// format of results
+		pipeline_output_t output{ pipeline_output_t::TEXT };
+		/// number of solutions kept in `SolutionCache_t`, 0 disables the cache
+		std::size_t cache_capacity{ 0u };
+		/// time limit of single puzzle, 0 means no limit
+		std::chrono::milliseconds time_limit{ 0 };
+		/// node limit of single puzzle (see `solve_budget_t`), 0 means no limit
+		std::size_t node_limit{ 0u };
+		/// number of the slowest puzzles remembered for `printSlowest()`, 0 disables it
+		std::size_t slowest_count{ 0u };
+		/// ordering of strategies, every solving thread has its own `StrategyScheduler_t`
+		scheduler_config_t scheduler{};
+		/// solver of every puzzle
+		solver_backend_t backend{ solver_backend_t::STRATEGIES };
+		/// units and peers of every puzzle (jigsaw, diagonal, ...), nullptr for classic sudoku
+		std::shared_ptr<const ConstraintGraph_t> graph{};
+#ifndef _WIN32
+		/// file of `PuzzleIndex_t` shared with other runs, empty disables the index
+		std::string index_path{};
+#endif
+	};
+
+	/// @brief Counters collected by single stage of `SolvingPipeline_t`
+	struct stage_statistics_t
+	{
+		/// name displayed in report
+		std::string name;
+		/// number of threads running the stage
+		std::size_t threads{ 1u };
+		/// number of processed boards
+		std::atomic<std::size_t> items{ 0u };
+		/// number of rejected inputs (malformed lines)
+		std::atomic<std::size_t> rejected{ 0u };
+		/// time spent on processing, summed over all threads of the stage (waiting on queues isn't included)
+		std::atomic<std::uint64_t> busy_ns{ 0u };
+	};
+
+	/// @brief Runs parse -> solve -> validate -> serialize stages concurrently. Stages are connected with bounded lock-free queues,
+	/// so memory usage doesn't depend on length of input stream. Results are written in input order: items which overtook
+	/// a slow predecessor wait in reorder buffer, and parsing stops while the number of items in flight reaches what queues
+	/// and threads of all stages hold together, so the buffer stays bounded as well.
+	/// @li Input: one puzzle per line, 81 fields written row by row, digits 1-9 for known fields and '0' or '.' for empty ones.
+	/// Whitespace inside line is ignored, so the format used by interactive mode (space separated numbers) is accepted as well.
+	/// Blank lines are skipped, every other line gets its result line - malformed ones (and killer puzzles with invalid cages)
+	/// are marked as rejected, so line N of results always belongs to N-th puzzle line of input.
+	/// @li Killer puzzles have their cages after '|', in format of `KillerCages_t::parse()`. They are always solved by `BoardSolver_t`
+	/// and never taken from `SolutionCache_t`, which doesn't know cages.
+	/// @li Variants given by `pipeline_config_t::graph` apply to every puzzle. Unless the graph is classic, `SolutionCache_t`
+	/// is bypassed, as its canonical form relies on symmetries of classic sudoku.
+	/// @li With `pipeline_config_t::index_path` every classic puzzle is first looked up in `PuzzleIndex_t`, and only missing ones
+	/// are solved. Validated solutions (checked for uniqueness with `SolutionCounter_t`) and proven contradictions are added
+	/// to the index and committed when the run ends. Unsolvable puzzles taken from the index are written unchanged.
+	/// @tparam T type of data stored in board
+	template<typename T>
+	class SolvingPipeline_t
+	{
+	protected:
+		/// Represents type of data stored in board
+		using value_t = T;
+
+		/// Alias for `Board_t` with specified data type for code simplification.
+		using Board_t = malcolm::Board_t<value_t>;
+
+		/// @brief Board travelling through stages
+		struct item_t
+		{
+			/// position in input stream, used to restore order of results
+			std::size_t sequence{ 0u };
+			/// parsed input, empty board for rejected line
+			Board_t puzzle;
+			/// cages of killer puzzle, nullptr for classic one
+			std::shared_ptr<const KillerCages_t> cages{};
+			/// output of `BoardSolver_t`
+			Board_t solution{};
+			/// false if solver threw an exception
+			bool solved{ false };
+			/// how solving ended, `solve_status_t::SOLVED` for answers taken from cache
+			solve_status_t status{ solve_status_t::UNSOLVED };
+			/// nodes visited by solver, 0 for answers taken from cache or index
+			std::size_t nodes{ 0u };
+			/// true if answer was taken from `PuzzleIndex_t`
+			bool indexed{ false };
+			/// time spent on solving
+			std::uint64_t solve_ns{ 0u };
+			/// result of `IncrementalValidator_t::isConsistent()` for filled solution
+			bool valid{ false };
+			/// true if input line couldn't be parsed, such item passes all stages untouched
+			bool rejected{ false };
+		};
+
+		/// Queue connecting two stages
+		using queue_t = utils::BoundedQueue_t<item_t>;
+
+		/// @brief Puzzle remembered by `printSlowest()`
+		struct slow_puzzle_t
+		{
+			std::uint64_t solve_ns;
+			std::size_t sequence;
+			std::size_t nodes;
+			solve_status_t status;
+			Board_t puzzle;
+
+			inline bool operator>(const slow_puzzle_t& other) const { return solve_ns > other.solve_ns; }
+		};
+
+		/// @brief Latencies collected by single solving thread, merged only when reported
+		struct solver_latency_t
+		{
+			/// per-puzzle solve time in nanoseconds
+			utils::LatencyHistogram_t histogram;
+			/// the slowest puzzles, min-heap ordered by solve time
+			std::vector<slow_puzzle_t> slowest;
+		};
+
+	private:
+		/// @brief settings given in constructor
+		pipeline_config_t m_config;
+
+		/// @brief counters of parse, solve, validate and serialize stages
+		std::unique_ptr<stage_statistics_t[]> m_statistics;
+
+		/// @brief wall time of last `run()` call
+		std::chrono::nanoseconds m_wall_time{ 0 };
+
+		/// @brief maximal number of items in flight, see `run()`
+		std::size_t m_in_flight_limit{ 0u };
+
+		/// @brief the largest number of items waiting in reorder buffer during last `run()` call
+		std::size_t m_reorder_peak{ 0u };
+
+		/// @brief solutions of already seen puzzles (up to symmetry), nullptr if disabled
+		std::unique_ptr<SolutionCache_t<value_t>> m_cache;
+
+#ifndef _WIN32
+		/// @brief persistent index of puzzles solved by earlier runs, nullptr if disabled
+		std::unique_ptr<PuzzleIndex_t<value_t>> m_index;
+#endif
+
+		/// @brief latencies of every solving thread
+		std::vector<std::unique_ptr<solver_latency_t>> m_latencies;
+
+		/// @brief scheduler of every solving thread, with `scheduling_scope_t::PUZZLE` it only sums observations of per-puzzle schedulers
+		std::vector<std::shared_ptr<StrategyScheduler_t>> m_schedulers;
+
+#ifndef _WIN32
+		/// @returns true if answer for the item can be kept in `PuzzleIndex_t`, which knows neither cages nor variants
+		bool isIndexable(const item_t& item) const { return !item.cages && (!m_config.graph || m_config.graph->isClassic()); }
+#endif
+
+		/// @brief Runs `worker` on `threads` threads, measures time spent in `worker` and closes `output` when all threads are done
+		/// @param statistics counters of the stage
+		/// @param input source of boards
+		/// @param output destination of processed boards, can be nullptr for last stage
+		/// @param worker function processing single item on thread with given index, returns false if item should be dropped
+		template<typename worker_t>
+		static std::vector<std::thread> startStage(stage_statistics_t& statistics, queue_t& input, queue_t* output, worker_t worker)
+		{
+			auto remaining{ std::make_shared<std::atomic<std::size_t>>(statistics.threads) };
+			std::vector<std::thread> threads;
+			for (auto i{ 0u }; i < statistics.threads; i++)
+			{
+				threads.emplace_back([&statistics, &input, output, worker, remaining, thread_index = static_cast<std::size_t>(i)]() mutable
+					{
+						item_t item;
+						while (input.pop(item))
+						{
+							auto start{ std::chrono::steady_clock::now() };
+							bool keep{ worker(item, thread_index) };
+							statistics.busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+							statistics.items.fetch_add(1u, std::memory_order_relaxed);
+							if (!keep)
+								statistics.rejected.fetch_add(1u, std::memory_order_relaxed);
+							if (keep && output)
+								output->push(std::move(item));
+						}
+						if (remaining->fetch_sub(1u) == 1u && output)
+							output->close();
+					});
+			}
+			return threads;
+		}
+
+	public:
+		/// @brief Converts line of text into board
+		/// @param line input line
+		/// @param board board of size 9x9 to be filled
+		/// @returns false if line doesn't contain exactly 81 fields
+		static bool parseLine(const std::string& line, Board_t& board)
+		{
+			std::size_t index{ 0u };
+			for (char c : line)
+			{
+				if (c == ' ' || c == '\t' || c == '\r')
+					continue;
+				if (index == 81u || !((c >= '0' && c <= '9') || c == '.'))
+					return false;
+				board[{ static_cast<size_t>(index % 9u), static_cast<size_t>(index / 9u) }] = c == '.' ? static_cast<value_t>(0u) : static_cast<value_t>(c - '0');
+				index++;
+			}
+			return index == 81u;
+		}
+
+		/// @param config settings of stages and queues
+		/// @throws std::runtime_error if `pipeline_config_t::index_path` can't be opened
+		SolvingPipeline_t(const pipeline_config_t& config = {})
+			: m_config{ config }, m_statistics{ std::make_unique<stage_statistics_t[]>(4u) }
+		{
+			m_config.solve_threads = std::max<std::size_t>(1u, m_config.solve_threads);
+			m_config.validate_threads = std::max<std::size_t>(1u, m_config.validate_threads);
+			m_statistics[0].name = "parse";
+			m_statistics[1].name = "solve";
+			m_statistics[1].threads = m_config.solve_threads;
+			m_statistics[2].name = "validate";
+			m_statistics[2].threads = m_config.validate_threads;
+			m_statistics[3].name = "serialize";
+			m_config.queue_capacity = std::max<std::size_t>(1u, m_config.queue_capacity);
+			m_in_flight_limit = 3u * m_config.queue_capacity + m_config.solve_threads + m_config.validate_threads + 1u;
+			if (m_config.cache_capacity > 0u)
+				m_cache = std::make_unique<SolutionCache_t<value_t>>(m_config.cache_capacity);
+#ifndef _WIN32
+			if (!m_config.index_path.empty())
+				m_index = std::make_unique<PuzzleIndex_t<value_t>>(m_config.index_path);
+#endif
+			for (std::size_t i{ 0u }; i < m_config.solve_threads; i++)
+			{
+				m_latencies.push_back(std::make_unique<solver_latency_t>());
+				m_schedulers.push_back(std::make_shared<StrategyScheduler_t>(m_config.scheduler));
+			}
+		}
+
+		/// @brief Processes whole input stream
+		/// @param in stream of puzzles, one per line
+		/// @param out stream for results (opened in binary mode for `pipeline_output_t::BINARY`)
+		void run(std::istream& in, std::ostream& out)
+		{
+			auto wall_start{ std::chrono::steady_clock::now() };
+			queue_t parsed{ m_config.queue_capacity }, solved{ m_config.queue_capacity }, validated{ m_config.queue_capacity };
+
+			auto solvers{ startStage(m_statistics[1], parsed, &solved, [this](item_t& item, std::size_t thread_index)
+				{
+					if (item.rejected)
+					{
+						item.solution = item.puzzle;
+						return true;
+					}
+					item.status = solve_status_t::SOLVED;
+					auto solve = [this, &item, thread_index](const Board_t& puzzle)
+						{
+							solve_budget_t budget{ m_config.time_limit.count() > 0 ? solve_budget_t::withTimeout(m_config.time_limit) : solve_budget_t{} };
+							if (m_config.node_limit > 0u)
+								budget.max_nodes = m_config.node_limit;
+							if (m_config.backend == solver_backend_t::SAT && !item.cages)
+							{
+								auto result{ SatBoardSolver_t<value_t>(puzzle, true, m_config.graph).getSolved(budget) };
+								item.status = result.status;
+								item.nodes = result.nodes;
+								return std::move(result.board);
+							}
+							if (SearchProfiler_t::isEnabled())
+								SearchProfiler_t::beginPuzzle(item.sequence);
+							const auto& thread_scheduler{ m_schedulers[thread_index] };
+							auto scheduler{ m_config.scheduler.scope == scheduling_scope_t::BATCH ? thread_scheduler : std::make_shared<StrategyScheduler_t>(m_config.scheduler) };
+							auto result{ malcolm::solve(puzzle, budget, scheduler, item.cages, m_config.graph) };
+							if (scheduler != thread_scheduler)
+								thread_scheduler->merge(*scheduler);
+							item.status = result.status;
+							item.nodes = result.nodes;
+							return std::move(result.board);
+						};
+					auto start{ std::chrono::steady_clock::now() };
+#ifndef _WIN32
+					if (m_index && isIndexable(item))
+					{
+						item.solution = Board_t(9u, 9u);
+						if (auto status{ m_index->lookup(item.puzzle, item.solution) })
+						{
+							item.status = *status == index_status_t::UNSOLVABLE ? solve_status_t::UNSAT : solve_status_t::SOLVED;
+							item.solved = true;
+							item.indexed = true;
+						}
+					}
+#endif
+					if (!item.indexed)
+					{
+						try
+						{
+							const bool cacheable{ m_cache && !item.cages && (!m_config.graph || m_config.graph->isClassic()) };
+							item.solution = cacheable ? m_cache->getSolved(item.puzzle, solve) : solve(item.puzzle);
+							item.solved = true;
+						}
+						catch (const std::exception&)
+						{
+							item.solution = item.puzzle;
+						}
+					}
+					item.solve_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+					solver_latency_t& latency{ *m_latencies[thread_index] };
+					latency.histogram.record(item.solve_ns);
+					if (m_config.slowest_count > 0u && (latency.slowest.size() < m_config.slowest_count || item.solve_ns > latency.slowest.front().solve_ns))
+					{
+						if (latency.slowest.size() == m_config.slowest_count)
+						{
+							std::pop_heap(latency.slowest.begin(), latency.slowest.end(), std::greater<>());
+							latency.slowest.pop_back();
+						}
+						latency.slowest.push_back({ item.solve_ns, item.sequence, item.nodes, item.status, item.puzzle });
+						std::push_heap(latency.slowest.begin(), latency.slowest.end(), std::greater<>());
+					}
+					return true;
+				}) };
+
+			auto validators{ startStage(m_statistics[2], solved, &validated, [this](item_t& item, std::size_t)
+				{
+					if (item.rejected)
+						return true;
+					const ConstraintGraph_t& graph{ m_config.graph ? *m_config.graph : *ConstraintGraph_t::classic() };
+					item.valid = item.solved && item.solution.count(static_cast<value_t>(0u)) == 0u && IncrementalValidator_t<value_t>(item.solution, graph).isConsistent()
+						&& (!item.cages || item.cages->isSatisfiedBy(item.solution));
+#ifndef _WIN32
+					if (m_index && !item.indexed && isIndexable(item))
+					{
+						if (item.valid)
+						{
+							const auto unique{ SolutionCounter_t().count(SolutionCounter_t::toCells(item.puzzle), 2u) == 1u };
+							m_index->insert(item.puzzle, unique ? index_status_t::SOLVED : index_status_t::NOT_UNIQUE, item.solution);
+						}
+						else if (item.solved && item.status == solve_status_t::UNSAT)
+							m_index->insert(item.puzzle, index_status_t::UNSOLVABLE, item.puzzle);
+					}
+#endif
+					return true;
+				}) };
+
+			std::unique_ptr<BoardWriter_t<value_t>> writer;
+			if (m_config.output == pipeline_output_t::BINARY)
+				writer = std::make_unique<BoardWriter_t<value_t>>(out);
+			// parse stage waits while `m_in_flight_limit` items are parsed but not written, which bounds `reorder_buffer` too
+			std::mutex written_mutex;
+			std::condition_variable written_advanced;
+			std::size_t written{ 0u };
+			std::map<std::size_t, item_t> reorder_buffer; // items which overtook their predecessors
+			std::size_t next_sequence{ 0u };
+			m_reorder_peak = 0u;
+			auto serializers{ startStage(m_statistics[3], validated, nullptr, [&](item_t& item, std::size_t)
+				{
+					reorder_buffer.emplace(item.sequence, std::move(item));
+					m_reorder_peak = std::max(m_reorder_peak, reorder_buffer.size());
+					const std::size_t first{ next_sequence };
+					for (auto it{ reorder_buffer.begin() }; it != reorder_buffer.end() && it->first == next_sequence; it = reorder_buffer.erase(it), next_sequence++)
+					{
+						if (writer)
+						{
+							writer->write(it->second.solution);
+							continue;
+						}
+						char line[text_result_size];
+						for (auto i{ 0u }; i < 81u; i++)
+						{
+							auto value{ it->second.solution[{ static_cast<size_t>(i % 9u), static_cast<size_t>(i / 9u) }] };
+							line[i] = value == static_cast<value_t>(0u) ? '.' : static_cast<char>('0' + value);
+						}
+						line[81] = ' ';
+						line[82] = it->second.rejected ? rejected_status : it->second.valid ? '1' : '0';
+						line[83] = '\n';
+						out.write(line, sizeof(line));
+					}
+					if (next_sequence != first)
+					{
+						{
+							std::lock_guard<std::mutex> lock{ written_mutex };
+							written = next_sequence;
+						}
+						written_advanced.notify_one();
+					}
+					return true;
+				}) };
+
+			// parse stage runs on calling thread, push() blocks when solvers can't keep up
+			stage_statistics_t& parse_statistics{ m_statistics[0] };
+			std::string line;
+			std::size_t sequence{ 0u };
+			while (std::getline(in, line))
+			{
+				auto start{ std::chrono::steady_clock::now() };
+				if (line.find_first_not_of(" \t\r") == std::string::npos)
+					continue;
+				item_t item{ .sequence = sequence, .puzzle = Board_t(9u, 9u) };
+				bool parsed_correctly{ false };
+				try
+				{
+					const std::size_t separator{ line.find('|') };
+					parsed_correctly = parseLine(line.substr(0u, separator), item.puzzle);
+					if (separator != std::string::npos)
+						item.cages = std::make_shared<const KillerCages_t>(KillerCages_t::parse(line.substr(separator + 1u)));
+				}
+				catch (const std::exception&)
+				{
+					parsed_correctly = false;
+				}
+				parse_statistics.busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+				parse_statistics.items.fetch_add(1u, std::memory_order_relaxed);
+				if (!parsed_correctly)
+				{
+					parse_statistics.rejected.fetch_add(1u, std::memory_order_relaxed);
+					item = { .sequence = sequence, .puzzle = Board_t(9u, 9u), .rejected = true };
+				}
+				{
+					std::unique_lock<std::mutex> lock{ written_mutex };
+					written_advanced.wait(lock, [&]() { return sequence - written < m_in_flight_limit; });
+				}
+				sequence++;
+				parsed.push(std::move(item));
+			}
+			parsed.close();
+
+			for (auto* stage : { &solvers, &validators, &serializers })
+				for (auto& thread : *stage)
+					thread.join();
+			writer.reset();
+			out.flush();
+#ifndef _WIN32
+			if (m_index)
+				m_index->commit();
+#endif
+			m_wall_time = std::chrono::steady_clock::now() - wall_start;
+		}
+
+		/// @brief Writes per-stage counters. Utilisation close to 100% marks the bottleneck stage.
+		/// @param stream destination of the report
+		void printStatistics(std::ostream& stream) const
+		{
+			double wall_seconds{ std::chrono::duration<double>(m_wall_time).count() };
+			stream << "stage       threads      items   rejected     busy[ms]  items/s/thread  utilisation\n";
+			for (auto i{ 0u }; i < 4u; i++)
+			{
+				const auto& stage{ m_statistics[i] };
+				double busy_seconds{ stage.busy_ns.load() / 1e9 };
+				double per_thread{ busy_seconds > 0.0 ? stage.items.load() / (busy_seconds / stage.threads) : 0.0 };
+				double utilisation{ wall_seconds > 0.0 ? 100.0 * busy_seconds / (wall_seconds * stage.threads) : 0.0 };
+				stream << std::left << std::setw(10) << stage.name << std::right
+					<< std::setw(9) << stage.threads
+					<< std::setw(11) << stage.items.load()
+					<< std::setw(11) << stage.rejected.load()
+					<< std::setw(13) << std::fixed << std::setprecision(1) << busy_seconds * 1e3
+					<< std::setw(16) << std::setprecision(0) << per_thread
+					<< std::setw(12) << std::setprecision(1) << utilisation << "%\n";
+			}
+			stream << "wall time: " << std::fixed << std::setprecision(1) << wall_seconds * 1e3 << " ms\n";
+			stream << "reorder buffer: peak " << m_reorder_peak << " items, limit " << m_in_flight_limit << "\n";
+			if (m_cache)
+				stream << "solution cache: " << m_cache->getHits() << " hits, " << m_cache->getMisses() << " misses, " << m_cache->getCanonicalized() << " canonicalized\n";
+#ifndef _WIN32
+			if (m_index)
+				stream << "puzzle index: " << m_index->getHits() << " hits, " << m_index->getMisses() << " misses, "
+					<< m_index->getInserted() << " added, " << m_index->size() << " records\n";
+#endif
+		}
+
+		/// @brief Writes percentiles of per-puzzle solve time, merged from all solving threads
+		/// @param stream destination of the report
+		void printLatency(std::ostream& stream) const
+		{
+			utils::LatencyHistogram_t merged;
+			for (const auto& latency : m_latencies)
+				merged.merge(latency->histogram);
+			stream << "solve latency (" << merged.count() << " puzzles): ";
+			merged.printSummary(stream, 1e3, "us");
+			stream << "\n";
+		}
+
+		/// @brief Writes calls, yield and cost of every strategy, summed over all solving threads
+		/// @param stream destination of the report
+		void printScheduler(std::ostream& stream) const
+		{
+			StrategyScheduler_t merged;
+			for (const auto& scheduler : m_schedulers)
+				merged.merge(*scheduler);
+			merged.printStatistics(stream);
+		}
+
+		/// @brief Writes the slowest puzzles, one per line: puzzle in input format, solve time, visited nodes, status
+		/// and position in input, so the lines can be cut and added to benchmark corpus
+		/// @param stream destination of the report
+		void printSlowest(std::ostream& stream) const
+		{
+			std::vector<slow_puzzle_t> slowest;
+			for (const auto& latency : m_latencies)
+				slowest.insert(slowest.end(), latency->slowest.begin(), latency->slowest.end());
+			std::sort(slowest.begin(), slowest.end(), std::greater<>());
+			if (slowest.size() > m_config.slowest_count)
+				slowest.resize(m_config.slowest_count);
+			for (const auto& puzzle : slowest)
+			{
+				for (auto i{ 0u }; i < 81u; i++)
+				{
+					auto value{ puzzle.puzzle[{ static_cast<size_t>(i % 9u), static_cast<size_t>(i / 9u) }] };
+					stream << (value == static_cast<value_t>(0u) ? '.' : static_cast<char>('0' + value));
+				}
+				stream << std::fixed << std::setprecision(1) << " " << puzzle.solve_ns / 1e3 << "us " << puzzle.nodes << " " << toString(puzzle.status) << " #" << puzzle.sequence << "\n";
+			}
+		}
+
+		/// @returns the largest number of results which waited for a slower predecessor during the last `run()` call,
+		/// never more than 3 * `queue_capacity` + number of solving and validating threads + 1
+		inline std::size_t getReorderPeak() const { return m_reorder_peak; }
+
+		/// @returns counters of stage with given index (0 - parse, 1 - solve, 2 - validate, 3 - serialize)
+		inline const stage_statistics_t& getStatistics(std::size_t stage) const { return m_statistics[stage]; }
+	};
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace malcolm
+{
+	/// @brief Group of strategies scheduled together, see `StrategyScheduler_t`
+	enum class strategy_phase_t : std::uint8_t
+	{
+		/// strategies asked for the next field to be filled
+		FILLING,
+		/// strategies asked for possibilities to be erased
+		ELIMINATING
+	};
+
+	/// @brief How `StrategyScheduler_t` orders strategies
+	enum class scheduling_policy_t : std::uint8_t
+	{
+		/// always in order of registration
+		FIXED,
+		/// by observed yield per unit of cost, the most profitable first
+		ADAPTIVE
+	};
+
+	/// @brief How long observations of `StrategyScheduler_t` are kept
+	enum class scheduling_scope_t : std::uint8_t
+	{
+		/// every puzzle starts with fresh scheduler (shared only with its bruteforce scenarios)
+		PUZZLE,
+		/// one scheduler per solving thread is reused for all puzzles of a batch
+		BATCH
+	};
+
+	/// @brief Settings of `StrategyScheduler_t`
+	struct scheduler_config_t
+	{
+		/// ordering of strategies
+		scheduling_policy_t policy{ scheduling_policy_t::ADAPTIVE };
+		/// lifetime of observations
+		scheduling_scope_t scope{ scheduling_scope_t::BATCH };
+		/// weight of history in moving averages of yield and cost, 0 means only the last call counts
+		double decay{ 0.9 };
+		/// every N-th ordering of a phase puts first the strategy measured longest ago, 0 disables it (`scheduling_policy_t::ADAPTIVE` only)
+		std::size_t exploration_interval{ 64u };
+	};
+
+	/// @brief Measures cost (time spent) and yield (filled fields or erased possibilities) of every call of every strategy
+	/// and decides in which order strategies are asked next time.
+	/// @li Callers ask strategies in returned order and stop at the first one which yields anything, so strategies
+	/// which were expensive and unproductive recently are asked only when all others fail - they are never skipped completely,
+	/// so the set of puzzles that can be solved doesn't depend on the policy.
+	/// @li Strategies without observations are tried first, so every strategy gets measured.
+	/// @li A demoted strategy may not be reached for a long time while cheaper ones keep succeeding, so its averages would
+	/// describe puzzles seen long ago. Every `scheduler_config_t::exploration_interval`-th ordering therefore puts first
+	/// the strategy measured longest ago.
+	/// @li Not thread-safe, every solving thread uses its own scheduler.
+	class StrategyScheduler_t
+	{
+	public:
+		/// @brief Observations of single strategy
+		struct strategy_statistics_t
+		{
+			/// name used in reports
+			std::string name;
+			/// number of calls
+			std::uint64_t calls{ 0u };
+			/// number of calls which yielded anything
+			std::uint64_t productive_calls{ 0u };
+			/// sum of yields
+			std::uint64_t yield{ 0u };
+			/// sum of costs in nanoseconds
+			std::uint64_t cost_ns{ 0u };
+			/// moving average of yield per call
+			double average_yield{ 0.0 };
+			/// moving average of cost per call in nanoseconds
+			double average_cost{ 0.0 };
+			/// number of orderings of the phase when the strategy was last recorded or explored
+			std::uint64_t last_measured{ 0u };
+		};
+
+	private:
+		/// @brief settings given in constructor
+		scheduler_config_t m_config;
+
+		/// @brief observations of strategies of every phase, indexed as registered
+		std::array<std::vector<strategy_statistics_t>, 2> m_statistics;
+
+		/// @brief number of `order()` calls of every phase
+		std::array<std::uint64_t, 2> m_orderings{};
+
+		/// @returns expected yield per nanosecond, infinity for strategies without observations
+		static double score(const strategy_statistics_t& statistics)
+		{
+			if (statistics.calls == 0u)
+				return std::numeric_limits<double>::infinity();
+			return statistics.average_yield / std::max(1.0, statistics.average_cost);
+		}
+
+	public:
+		/// @param config settings of the scheduler
+		explicit StrategyScheduler_t(const scheduler_config_t& config = {})
+			: m_config{ config }
+		{
+		}
+
+		/// @brief Registers strategies of given phase, does nothing if they are already registered (scheduler reused for next puzzle)
+		/// @param phase group of strategies
+		/// @param names names of strategies, their indices are used in `order()` and `record()`
+		void registerStrategies(strategy_phase_t phase, const std::vector<std::string>& names)
+		{
+			auto& statistics{ m_statistics[static_cast<std::size_t>(phase)] };
+			if (!statistics.empty())
+				return;
+			for (const auto& name : names)
+				statistics.push_back({ name });
+		}
+
+		/// @param phase group of strategies
+		/// @returns indices of strategies in order in which they should be asked
+		std::vector<std::size_t> order(strategy_phase_t phase)
+		{
+			auto& statistics{ m_statistics[static_cast<std::size_t>(phase)] };
+			const std::uint64_t ordering{ ++m_orderings[static_cast<std::size_t>(phase)] };
+			std::vector<std::size_t> result(statistics.size());
+			for (std::size_t i{ 0u }; i < result.size(); i++)
+				result[i] = i;
+			if (m_config.policy != scheduling_policy_t::ADAPTIVE)
+				return result;
+			std::stable_sort(result.begin(), result.end(), [&](std::size_t a, std::size_t b) { return score(statistics[a]) > score(statistics[b]); });
+			if (m_config.exploration_interval > 0u && ordering % m_config.exploration_interval == 0u && !result.empty())
+			{
+				// marked as measured now, so a strategy the caller skips (e.g. smart cleaning in bruteforce scenarios) doesn't block the others
+				auto stalest{ std::min_element(result.begin(), result.end(), [&](std::size_t a, std::size_t b) { return statistics[a].last_measured < statistics[b].last_measured; }) };
+				statistics[*stalest].last_measured = ordering;
+				std::rotate(result.begin(), stalest, stalest + 1);
+			}
+			return result;
+		}
+
+		/// @brief Stores observation of single call
+		/// @param phase group of strategies
+		/// @param index index of strategy given in `registerStrategies()`
+		/// @param cost_ns time spent in the call
+		/// @param yield number of filled fields or erased possibilities
+		void record(strategy_phase_t phase, std::size_t index, std::uint64_t cost_ns, std::size_t yield)
+		{
+			auto& statistics{ m_statistics[static_cast<std::size_t>(phase)][index] };
+			const double history{ statistics.calls == 0u ? 0.0 : m_config.decay };
+			statistics.average_yield = history * statistics.average_yield + (1.0 - history) * static_cast<double>(yield);
+			statistics.average_cost = history * statistics.average_cost + (1.0 - history) * static_cast<double>(cost_ns);
+			statistics.last_measured = m_orderings[static_cast<std::size_t>(phase)];
+			statistics.calls++;
+			statistics.productive_calls += yield > 0u ? 1u : 0u;
+			statistics.yield += yield;
+			statistics.cost_ns += cost_ns;
+		}
+
+		/// @brief Adds totals of other scheduler, used to report observations of many threads together
+		void merge(const StrategyScheduler_t& other)
+		{
+			for (std::size_t phase{ 0u }; phase < 2u; phase++)
+			{
+				auto& statistics{ m_statistics[phase] };
+				if (statistics.empty())
+					for (const auto& other_statistics : other.m_statistics[phase])
+						statistics.push_back({ other_statistics.name });
+				for (std::size_t i{ 0u }; i < std::min(statistics.size(), other.m_statistics[phase].size()); i++)
+				{
+					const auto& other_statistics{ other.m_statistics[phase][i] };
+					statistics[i].calls += other_statistics.calls;
+					statistics[i].productive_calls += other_statistics.productive_calls;
+					statistics[i].yield += other_statistics.yield;
+					statistics[i].cost_ns += other_statistics.cost_ns;
+				}
+			}
+		}
+
+		/// @brief Writes totals of every strategy
+		void printStatistics(std::ostream& stream) const
+		{
+			stream << "strategy                 phase        calls  productive      yield    cost[ms]  yield/ms\n";
+			for (std::size_t phase{ 0u }; phase < 2u; phase++)
+				for (const auto& statistics : m_statistics[phase])
+				{
+					const double cost_ms{ statistics.cost_ns / 1e6 };
+					stream << std::left << std::setw(25) << statistics.name << std::setw(10) << (phase == 0u ? "filling" : "eliminating") << std::right
+						<< std::setw(8) << statistics.calls
+						<< std::setw(12) << statistics.productive_calls
+						<< std::setw(11) << statistics.yield
+						<< std::setw(12) << std::fixed << std::setprecision(1) << cost_ms
+						<< std::setw(10) << std::setprecision(1) << (cost_ms > 0.0 ? statistics.yield / cost_ms : 0.0) << "\n";
+				}
+		}
+	};
+}
@@ -12,8 +12,8 @@ namespace malcolm
 	class TheOnlyPossibilityStrategy_t : public ISolvingStrategy_t<T>
 	{
 		using value_t = T;
-		using field_t = field_t<value_t>;
-		using value_container_t = value_container_t<value_t>;
+		using field_t = malcolm::field_t<value_t>;
+		using value_container_t = malcolm::value_container_t<value_t>;
 
 	public:
 		inline virtual field_t retrieveNextMove(const PossibilitiesBoard_t<value_t>& possibilities, const Board_t<value_t>& board) const override
@@ -22,7 +22,6 @@ namespace malcolm
 			if (possibilities.count(has_one_element) > 0)
 			{
 				pos_t valid_position{ possibilities.find(has_one_element) };
-				value_container_t local_neighborhood{ board.getNeighborhood(valid_position) };
 				const value_container_t& options = possibilities[valid_position];
 				value_t goal{ *(options.begin()) };
 				return { valid_position, goal };
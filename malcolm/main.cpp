@@ -1,12 +1,837 @@
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 #include "Board.h"
 #include "BoardSolver.h"
 #include "BoardValidator.h"
+#include "SolvingPipeline.h"
+#include "SatBoardSolver.h"
+#include "SolutionEnumerator.h"
+#include "HintSession.h"
+#include "MultiGridSolver.h"
+#include "PuzzleGenerator.h"
+#include "SolverServer.h"
+#include "LoadGenerator.h"
+#include "ShardCoordinator.h"
 
-int main()
+/// Invalid command line, reported by `main()` with its message
+struct usage_error_t : std::invalid_argument
+{
+	using std::invalid_argument::invalid_argument;
+};
+
+/// Parses whole non-negative number given on command line as `name`
+/// @throws usage_error_t if text isn't such number or it's out of range
+std::uint64_t parseNumber(const std::string& name, const std::string& text)
+{
+	if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+		throw usage_error_t("invalid value of " + name + ": " + text);
+	try
+	{
+		return std::stoull(text);
+	}
+	catch (const std::out_of_range&)
+	{
+		throw usage_error_t("value of " + name + " is out of range: " + text);
+	}
+}
+
+/// @returns value of option `argv[i]`, which follows it on command line; `i` is moved to the value
+/// @throws usage_error_t if option is the last argument
+std::string optionValue(int argc, char** argv, int& i)
+{
+	if (i + 1 >= argc)
+		throw usage_error_t(std::string{ "missing value of " } + argv[i]);
+	return argv[++i];
+}
+
+/// @returns numeric value of option `argv[i]`, see `optionValue()`
+std::uint64_t numericOption(int argc, char** argv, int& i)
+{
+	const std::string option{ argv[i] };
+	return parseNumber(option, optionValue(argc, argv, i));
+}
+
+/// Reads description of `ConstraintGraph_t` given on command line, or from file if it starts with '@'
+/// @returns compiled graph, nullptr (after printing the reason) if description can't be read or is invalid
+std::shared_ptr<const malcolm::ConstraintGraph_t> loadVariant(std::string description)
+{
+	if (!description.empty() && description.front() == '@')
+	{
+		std::ifstream file{ description.substr(1u) };
+		if (!file)
+		{
+			std::cerr << "can't open variant file: " << description.substr(1u) << "\n";
+			return nullptr;
+		}
+		description.assign(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+	}
+	try
+	{
+		return std::make_shared<const malcolm::ConstraintGraph_t>(malcolm::ConstraintGraph_t::parse(description));
+	}
+	catch (const std::invalid_argument& error)
+	{
+		std::cerr << "invalid variant: " << error.what() << "\n";
+		return nullptr;
+	}
+}
+
+/// Batch mode: solves stream of puzzles (one per line) with `SolvingPipeline_t`
+/// @li --batch [--solve-threads N] [--validate-threads N] [--queue-capacity N] [--cache N] [--time-limit MS] [--node-limit N] [--binary] [--trace] [--stats] [--latency] [--slowest N]
+/// [--scheduler fixed|puzzle|batch] [--scheduler-stats] [--perf] [--backend strategies|sat] [--variant DESCRIPTION|@FILE] [--index PATH]
+/// [--search-profile FILE] [--search-top N]
+/// @li --variant takes description of `ConstraintGraph_t` (e.g. `diagonal+anti-knight`), or name of file containing it after '@'
+/// @li --index names file of `PuzzleIndex_t` shared by runs; puzzles found there aren't solved again
+/// @li --search-profile records bruteforce search with `SearchProfiler_t`, writes it to FILE as collapsed stacks
+/// for flamegraph tools and prints N (default 10) most expensive branch points
+int runBatch(int argc, char** argv)
+{
+	using value_t = int;
+
+	malcolm::pipeline_config_t config;
+	bool print_statistics{ false }, print_latency{ false }, print_scheduler{ false }, print_perf{ false }, trace{ false };
+	std::string search_profile;
+	std::size_t search_top{ 10u };
+	for (auto i{ 2 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--solve-threads")
+			config.solve_threads = numericOption(argc, argv, i);
+		else if (argument == "--validate-threads")
+			config.validate_threads = numericOption(argc, argv, i);
+		else if (argument == "--queue-capacity")
+			config.queue_capacity = numericOption(argc, argv, i);
+		else if (argument == "--cache")
+			config.cache_capacity = numericOption(argc, argv, i);
+		else if (argument == "--time-limit")
+			config.time_limit = std::chrono::milliseconds(numericOption(argc, argv, i));
+		else if (argument == "--node-limit")
+			config.node_limit = numericOption(argc, argv, i);
+		else if (argument == "--binary")
+			config.output = malcolm::pipeline_output_t::BINARY;
+		else if (argument == "--stats")
+			print_statistics = true;
+		else if (argument == "--latency")
+			print_latency = true;
+		else if (argument == "--slowest")
+			config.slowest_count = numericOption(argc, argv, i);
+		else if (argument == "--scheduler")
+		{
+			std::string policy{ optionValue(argc, argv, i) };
+			if (policy == "fixed")
+				config.scheduler.policy = malcolm::scheduling_policy_t::FIXED;
+			else if (policy == "puzzle")
+				config.scheduler.scope = malcolm::scheduling_scope_t::PUZZLE;
+			else if (policy != "batch")
+			{
+				std::cerr << "unknown scheduler: " << policy << "\n";
+				return 1;
+			}
+		}
+		else if (argument == "--scheduler-stats")
+			print_scheduler = true;
+		else if (argument == "--perf")
+			print_perf = true;
+		else if (argument == "--backend")
+		{
+			std::string backend{ optionValue(argc, argv, i) };
+			if (backend == "sat")
+				config.backend = malcolm::solver_backend_t::SAT;
+			else if (backend != "strategies")
+			{
+				std::cerr << "unknown backend: " << backend << "\n";
+				return 1;
+			}
+		}
+		else if (argument == "--variant")
+		{
+			config.graph = loadVariant(optionValue(argc, argv, i));
+			if (!config.graph)
+				return 1;
+		}
+		else if (argument == "--index")
+		{
+#ifdef _WIN32
+			std::cerr << "puzzle index is not supported on this platform\n";
+			return 1;
+#else
+			config.index_path = optionValue(argc, argv, i);
+#endif
+		}
+		else if (argument == "--search-profile")
+			search_profile = optionValue(argc, argv, i);
+		else if (argument == "--search-top")
+			search_top = numericOption(argc, argv, i);
+		else if (argument == "--trace")
+			trace = true;
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	std::ofstream search_stream;
+	if (!search_profile.empty())
+	{
+		search_stream.open(search_profile);
+		if (!search_stream)
+		{
+			std::cerr << "can't open " << search_profile << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(trace);
+	utils::PerfProfile_t::setEnabled(print_perf);
+	malcolm::SearchProfiler_t::setEnabled(!search_profile.empty());
+#ifdef _WIN32
+	if (config.output == malcolm::pipeline_output_t::BINARY)
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	std::ios::sync_with_stdio(false);
+	std::unique_ptr<malcolm::SolvingPipeline_t<value_t>> pipeline;
+	try
+	{
+		pipeline = std::make_unique<malcolm::SolvingPipeline_t<value_t>>(config);
+	}
+	catch (const std::runtime_error& error)
+	{
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	pipeline->run(std::cin, std::cout);
+	if (print_statistics)
+		pipeline->printStatistics(std::cerr);
+	if (print_latency)
+		pipeline->printLatency(std::cerr);
+	if (config.slowest_count > 0u)
+		pipeline->printSlowest(std::cerr);
+	if (print_scheduler)
+		pipeline->printScheduler(std::cerr);
+	if (print_perf)
+		utils::PerfProfile_t::printReport(std::cerr);
+	if (!search_profile.empty())
+	{
+		malcolm::SearchProfiler_t::writeCollapsed(search_stream);
+		malcolm::SearchProfiler_t::printSummary(std::cerr, search_top);
+	}
+	return 0;
+}
+
+/// Generator mode: writes `count` unique puzzles of requested difficulty, one per line followed by its grade
+/// @li --generate count [--difficulty naked|hidden|locked|guess] [--seed S] [--threads N]
+int runGenerator(int argc, char** argv)
 {
 	using value_t = int;
 
+	if (argc < 3)
+	{
+		std::cerr << "missing number of puzzles\n";
+		return 1;
+	}
+	std::size_t count{ parseNumber("number of puzzles", argv[2]) }, threads{ std::max(1u, std::thread::hardware_concurrency()) };
+	std::uint64_t seed{ 0u };
+	malcolm::difficulty_t difficulty{ malcolm::difficulty_t::HIDDEN_SINGLE };
+	for (auto i{ 3 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--seed")
+			seed = numericOption(argc, argv, i);
+		else if (argument == "--threads")
+			threads = numericOption(argc, argv, i);
+		else if (argument == "--difficulty")
+		{
+			std::string name{ optionValue(argc, argv, i) };
+			bool known{ false };
+			for (auto level : { malcolm::difficulty_t::NAKED_SINGLE, malcolm::difficulty_t::HIDDEN_SINGLE, malcolm::difficulty_t::LOCKED_CANDIDATES, malcolm::difficulty_t::GUESSING })
+				if (name == malcolm::toString(level))
+				{
+					difficulty = level;
+					known = true;
+				}
+			if (!known)
+			{
+				std::cerr << "unknown difficulty: " << name << "\n";
+				return 1;
+			}
+		}
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(false);
+
+	malcolm::PuzzleGenerator_t<value_t> generator(seed);
+	for (const auto& generated : generator.generateBatch(count, difficulty, threads))
+	{
+		for (auto y{ 0u }; y < 9u; y++)
+			for (auto x{ 0u }; x < 9u; x++)
+			{
+				auto value{ generated.puzzle[{ static_cast<malcolm::size_t>(x), static_cast<malcolm::size_t>(y) }] };
+				std::cout << (value == 0 ? '.' : static_cast<char>('0' + value));
+			}
+		std::cout << " " << malcolm::toString(generated.difficulty) << "\n";
+	}
+	return 0;
+}
+
+/// Enumeration mode: for every puzzle read from stdin (one per line, as in batch mode) writes its solutions one per line
+/// followed by an empty line, number of solutions goes to stderr. Solutions are written as soon as they are found.
+/// @li --enumerate [--limit K] [--variant DESCRIPTION|@FILE]
+int runEnumerate(int argc, char** argv)
+{
+	using value_t = int;
+
+	std::size_t limit{ 0u };
+	std::shared_ptr<const malcolm::ConstraintGraph_t> graph;
+	for (auto i{ 2 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--limit")
+			limit = numericOption(argc, argv, i);
+		else if (argument == "--variant")
+		{
+			graph = loadVariant(optionValue(argc, argv, i));
+			if (!graph)
+				return 1;
+		}
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(false);
+
+	std::string line;
+	for (std::size_t sequence{ 0u }; std::getline(std::cin, line); sequence++)
+	{
+		malcolm::Board_t<value_t> board(9u, 9u);
+		if (!malcolm::SolvingPipeline_t<value_t>::parseLine(line, board))
+		{
+			std::cerr << "puzzle " << sequence << ": malformed line\n";
+			continue;
+		}
+		std::size_t found{ 0u };
+		for (const auto& solution : malcolm::enumerateSolutions(board, graph))
+		{
+			for (std::size_t i{ 0u }; i < 81u; i++)
+				std::cout << static_cast<char>('0' + solution[{ static_cast<malcolm::size_t>(i % 9u), static_cast<malcolm::size_t>(i / 9u) }]);
+			std::cout << "\n";
+			if (++found == limit)
+				break;
+		}
+		std::cout << "\n" << std::flush;
+		std::cerr << "puzzle " << sequence << ": " << found << (found == limit ? " solutions (limit reached)\n" : " solutions\n");
+	}
+	return 0;
+}
+
+/// Hint mode: follows moves of a player and answers hint requests with `HintSession_t`. Commands are read from stdin, one per line:
+/// @li `puzzle <81 fields>` starts new session, `set x y v`, `clear x y` and `undo` edit the board, `hint` prints the next step
+/// as `<strategy> <x> <y> <value>` (locked candidates add unit and eliminated fields) followed by time it took.
+/// @li --hints [--variant DESCRIPTION|@FILE]
+int runHints(int argc, char** argv)
+{
+	using value_t = int;
+
+	std::shared_ptr<const malcolm::ConstraintGraph_t> graph;
+	for (auto i{ 2 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--variant")
+		{
+			graph = loadVariant(optionValue(argc, argv, i));
+			if (!graph)
+				return 1;
+		}
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(false);
+
+	std::unique_ptr<malcolm::HintSession_t<value_t>> session;
+	std::string line;
+	while (std::getline(std::cin, line))
+	{
+		std::istringstream command_stream{ line };
+		std::string command;
+		if (!(command_stream >> command))
+			continue;
+		if (command == "puzzle")
+		{
+			std::string fields;
+			std::getline(command_stream, fields);
+			malcolm::Board_t<value_t> board(9u, 9u);
+			if (!malcolm::SolvingPipeline_t<value_t>::parseLine(fields, board))
+			{
+				std::cout << "error malformed puzzle" << std::endl;
+				continue;
+			}
+			session = std::make_unique<malcolm::HintSession_t<value_t>>(board, graph);
+			std::cout << (session->isSolvable() ? "ok" : "error puzzle has no solution") << std::endl;
+			continue;
+		}
+		if (!session)
+		{
+			std::cout << "error no puzzle" << std::endl;
+			continue;
+		}
+		std::size_t x{ 0u }, y{ 0u };
+		value_t value{ 0 };
+		bool done{ false };
+		if (command == "set" && command_stream >> x >> y >> value && x < 9u && y < 9u)
+			done = session->set({ static_cast<malcolm::size_t>(x), static_cast<malcolm::size_t>(y) }, value);
+		else if (command == "clear" && command_stream >> x >> y && x < 9u && y < 9u)
+			done = session->clear({ static_cast<malcolm::size_t>(x), static_cast<malcolm::size_t>(y) });
+		else if (command == "undo")
+			done = session->undo();
+		else if (command == "hint")
+		{
+			const auto start{ std::chrono::steady_clock::now() };
+			const auto hint{ session->hint() };
+			const double us{ std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() };
+			std::cout << malcolm::toString(hint.strategy) << " " << static_cast<int>(hint.pos.first) << " " << static_cast<int>(hint.pos.second) << " " << hint.value;
+			if (hint.strategy == malcolm::hint_strategy_t::LOCKED_CANDIDATES)
+			{
+				std::cout << " unit " << hint.unit << " eliminates";
+				for (auto fields{ hint.eliminated }; fields.any(); fields.popFirst())
+					std::cout << " " << fields.first() % 9u << "," << fields.first() / 9u;
+			}
+			std::cout << " (" << std::fixed << std::setprecision(1) << us << "us)" << std::endl;
+			continue;
+		}
+		else
+		{
+			std::cout << "error unknown command" << std::endl;
+			continue;
+		}
+		std::cout << (done ? "ok" : "error rejected") << std::endl;
+	}
+	return 0;
+}
+
+/// SAT mode: solves single board of any size with square boxes (9x9, 16x16, 25x25, ...) with `SatBoardSolver_t`.
+/// Board is read from stdin as whitespace separated numbers row by row (0 for empty field), its size follows from their count.
+/// @li --sat [--time-limit MS] [--no-preprocess]
+int runSat(int argc, char** argv)
+{
+	using value_t = int;
+
+	malcolm::solve_budget_t budget;
+	bool preprocess{ true };
+	for (auto i{ 2 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--time-limit")
+			budget = malcolm::solve_budget_t::withTimeout(std::chrono::milliseconds(numericOption(argc, argv, i)));
+		else if (argument == "--no-preprocess")
+			preprocess = false;
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(false);
+
+	std::vector<value_t> values;
+	for (value_t value; std::cin >> value;)
+		values.push_back(value);
+	std::size_t side{ 0u };
+	while (side * side < values.size())
+		side++;
+	if (side == 0u || side * side != values.size() || side > 255u)
+	{
+		std::cerr << "expected square board, got " << values.size() << " numbers\n";
+		return 1;
+	}
+	malcolm::Board_t<value_t> board(static_cast<malcolm::size_t>(side), static_cast<malcolm::size_t>(side));
+	for (std::size_t i{ 0u }; i < values.size(); i++)
+		board[{ static_cast<malcolm::size_t>(i % side), static_cast<malcolm::size_t>(i / side) }] = values[i];
+
+	try
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		malcolm::SatBoardSolver_t<value_t> solver(board, preprocess);
+		auto result{ solver.getSolved(budget) };
+		double ms{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+		const std::size_t width{ std::to_string(side).size() + 1u };
+		for (std::size_t y{ 0u }; y < side; y++)
+		{
+			for (std::size_t x{ 0u }; x < side; x++)
+				std::cout << std::setw(width) << result.board[{ static_cast<malcolm::size_t>(x), static_cast<malcolm::size_t>(y) }];
+			std::cout << "\n";
+		}
+		const auto& statistics{ solver.getStatistics() };
+		std::cerr << malcolm::toString(result.status) << " in " << std::fixed << std::setprecision(1) << ms << "ms: "
+			<< statistics.decisions << " decisions, " << statistics.conflicts << " conflicts, " << statistics.propagations << " propagations, "
+			<< statistics.restarts << " restarts, " << statistics.learnt_clauses << " learnt clauses\n";
+		return result.status == malcolm::solve_status_t::SOLVED ? 0 : 2;
+	}
+	catch (const std::invalid_argument& error)
+	{
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+}
+
+/// Multi-grid mode: solves samurai and other gattai puzzles (see `MultiGridLayout_t`) with `MultiGridSolver_t`. Every input line
+/// holds 81 fields of every grid of the layout one after another (fields shared by grids are repeated in each of them), every output
+/// line the grids in the same shape followed by status.
+/// @li --multigrid [--layout samurai|twodoku|butterfly|grids:x,y;x,y;...] [--time-limit MS] [--node-limit N] [--stats]
+int runMultiGrid(int argc, char** argv)
+{
+	using value_t = int;
+
+	std::string description{ "samurai" };
+	std::chrono::milliseconds time_limit{ 0 };
+	std::size_t node_limit{ 0u };
+	bool print_statistics{ false };
+	for (auto i{ 2 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--layout")
+			description = optionValue(argc, argv, i);
+		else if (argument == "--time-limit")
+			time_limit = std::chrono::milliseconds(numericOption(argc, argv, i));
+		else if (argument == "--node-limit")
+			node_limit = numericOption(argc, argv, i);
+		else if (argument == "--stats")
+			print_statistics = true;
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	std::shared_ptr<const malcolm::MultiGridLayout_t> layout;
+	try
+	{
+		layout = std::make_shared<const malcolm::MultiGridLayout_t>(malcolm::MultiGridLayout_t::parse(description));
+	}
+	catch (const std::invalid_argument& error)
+	{
+		std::cerr << "invalid layout: " << error.what() << "\n";
+		return 1;
+	}
+
+	std::size_t puzzles{ 0u }, solved{ 0u };
+	malcolm::multigrid_statistics_t totals;
+	std::chrono::nanoseconds elapsed{ 0 };
+	std::string line;
+	for (std::size_t sequence{ 0u }; std::getline(std::cin, line); sequence++)
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		const auto grids{ malcolm::MultiGridSolver_t<value_t>::parseLine(line, *layout) };
+		if (grids.empty())
+		{
+			std::cerr << "puzzle " << sequence << ": malformed line\n";
+			continue;
+		}
+		malcolm::solve_budget_t budget{ time_limit.count() > 0 ? malcolm::solve_budget_t::withTimeout(time_limit) : malcolm::solve_budget_t{} };
+		if (node_limit > 0u)
+			budget.max_nodes = node_limit;
+		const auto start{ std::chrono::steady_clock::now() };
+		malcolm::MultiGridSolver_t<value_t> solver(layout, grids);
+		const auto result{ solver.getSolved(budget) };
+		elapsed += std::chrono::steady_clock::now() - start;
+
+		for (const auto& grid : result.grids)
+			for (std::size_t i{ 0u }; i < 81u; i++)
+			{
+				const auto value{ grid[{ static_cast<malcolm::size_t>(i % 9u), static_cast<malcolm::size_t>(i / 9u) }] };
+				std::cout << (value == 0 ? '.' : static_cast<char>('0' + value));
+			}
+		std::cout << " " << malcolm::toString(result.status) << "\n";
+		puzzles++;
+		solved += result.status == malcolm::solve_status_t::SOLVED ? 1u : 0u;
+		totals.nodes += solver.getStatistics().nodes;
+		totals.grid_propagations += solver.getStatistics().grid_propagations;
+		totals.eliminations += solver.getStatistics().eliminations;
+	}
+	if (print_statistics && puzzles > 0u)
+		std::cerr << std::fixed << std::setprecision(1) << puzzles << " puzzles (" << layout->getGridCount() << " grids, " << layout->getCellCount() << " cells), "
+			<< solved << " solved, " << std::chrono::duration<double, std::micro>(elapsed).count() / puzzles << " us per puzzle, "
+			<< static_cast<double>(totals.nodes) / puzzles << " nodes, " << static_cast<double>(totals.grid_propagations) / puzzles << " grid propagations, "
+			<< static_cast<double>(totals.eliminations) / puzzles << " eliminations per puzzle\n";
+	return 0;
+}
+
+/// Set by SIGINT/SIGTERM, stops server mode
+std::atomic<bool> g_stop_requested{ false };
+
+/// Server mode: serves requests on Unix domain socket until interrupted
+/// @li --serve path [--threads N] [--batch-size N] [--batch-window US] [--time-limit MS] [--stats-interval S] [--connection-requests N] [--write-timeout MS]
+int runServer(int argc, char** argv)
+{
+#ifdef _WIN32
+	std::cerr << "server mode is not supported on this platform\n";
+	return 1;
+#else
+	using value_t = int;
+
+	if (argc < 3)
+	{
+		std::cerr << "missing socket path\n";
+		return 1;
+	}
+	malcolm::server_config_t config;
+	for (auto i{ 3 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--threads")
+			config.threads = numericOption(argc, argv, i);
+		else if (argument == "--batch-size")
+			config.batch_size = numericOption(argc, argv, i);
+		else if (argument == "--batch-window")
+			config.batch_window = std::chrono::microseconds(numericOption(argc, argv, i));
+		else if (argument == "--time-limit")
+			config.time_limit = std::chrono::milliseconds(numericOption(argc, argv, i));
+		else if (argument == "--stats-interval")
+			config.statistics_interval = std::chrono::seconds(numericOption(argc, argv, i));
+		else if (argument == "--connection-requests")
+			config.connection_requests = numericOption(argc, argv, i);
+		else if (argument == "--write-timeout")
+			config.write_timeout = std::chrono::milliseconds(numericOption(argc, argv, i));
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(false);
+	std::signal(SIGINT, [](int) { g_stop_requested = true; });
+	std::signal(SIGTERM, [](int) { g_stop_requested = true; });
+
+	malcolm::SolverServer_t<value_t> server(argv[2], config);
+	server.run(g_stop_requested, std::cerr);
+	return 0;
+#endif
+}
+
+/// Client mode: sends puzzles read from stdin (one per line) to server and reports latency and throughput
+/// @li --client path [--connections N] [--depth N] [--repeat N] [--print]
+/// @li --print writes solution of every non-blank input line, lines which can't be parsed aren't sent and get empty board
+/// followed by `rejected_status` as in output of batch mode
+int runClient(int argc, char** argv)
+{
+#ifdef _WIN32
+	std::cerr << "client mode is not supported on this platform\n";
+	return 1;
+#else
+	using value_t = int;
+
+	if (argc < 3)
+	{
+		std::cerr << "missing socket path\n";
+		return 1;
+	}
+	malcolm::load_config_t config;
+	bool print_solutions{ false };
+	for (auto i{ 3 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--connections")
+			config.connections = numericOption(argc, argv, i);
+		else if (argument == "--depth")
+			config.depth = numericOption(argc, argv, i);
+		else if (argument == "--repeat")
+			config.repeat = numericOption(argc, argv, i);
+		else if (argument == "--print")
+			print_solutions = true;
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+
+	std::vector<malcolm::Board_t<value_t>> puzzles;
+	std::vector<bool> rejected; // one flag per non-blank input line
+	for (std::string line; std::getline(std::cin, line);)
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		malcolm::Board_t<value_t> board(9u, 9u);
+		rejected.push_back(!malcolm::SolvingPipeline_t<value_t>::parseLine(line, board));
+		if (!rejected.back())
+			puzzles.push_back(std::move(board));
+	}
+
+	malcolm::LoadGenerator_t<value_t> client(argv[2], config);
+	std::vector<malcolm::Board_t<value_t>> solutions;
+	try
+	{
+		solutions = client.run(puzzles);
+	}
+	catch (const std::exception& error) // server not running or invalid socket path
+	{
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	if (print_solutions)
+		for (std::size_t line{ 0u }, next_solution{ 0u }; line < rejected.size(); line++)
+		{
+			if (rejected[line])
+			{
+				std::cout << std::string(81u, '.') << ' ' << malcolm::rejected_status << "\n";
+				continue;
+			}
+			const auto& solution{ solutions[next_solution++] };
+			for (auto y{ 0u }; y < 9u; y++)
+				for (auto x{ 0u }; x < 9u; x++)
+				{
+					auto value{ solution[{ static_cast<malcolm::size_t>(x), static_cast<malcolm::size_t>(y) }] };
+					std::cout << (value == 0 ? '.' : static_cast<char>('0' + value));
+				}
+			std::cout << "\n";
+		}
+	if (puzzles.size() < rejected.size())
+		std::cerr << "rejected " << rejected.size() - puzzles.size() << " malformed input lines\n";
+	client.printStatistics(std::cerr);
+	return 0;
+#endif
+}
+
+/// Shard mode: solves puzzle file too large for single run with `ShardCoordinator_t`, results are written to OUTPUT in input order.
+/// Completed shards are kept in checkpoint directory (OUTPUT.shards by default), running the same command again after the run
+/// was killed solves only the rest.
+/// @li --shard INPUT OUTPUT [--workers N] [--shard-size BYTES] [--checkpoint DIR] [--attempts N] [--time-limit MS] [--node-limit N]
+int runShards(int argc, char** argv)
+{
+#ifdef _WIN32
+	std::cerr << "shard mode is not supported on this platform\n";
+	return 1;
+#else
+	using value_t = int;
+
+	if (argc < 4)
+	{
+		std::cerr << "missing input or output file\n";
+		return 1;
+	}
+	malcolm::shard_config_t config;
+	if (::access(config.executable.c_str(), X_OK) != 0)
+		config.executable = argv[0];
+	for (auto i{ 4 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--workers")
+			config.workers = numericOption(argc, argv, i);
+		else if (argument == "--shard-size")
+			config.shard_size = numericOption(argc, argv, i);
+		else if (argument == "--checkpoint")
+			config.checkpoint = optionValue(argc, argv, i);
+		else if (argument == "--attempts")
+			config.attempts = numericOption(argc, argv, i);
+		else if (argument == "--time-limit")
+			config.time_limit = std::chrono::milliseconds(numericOption(argc, argv, i));
+		else if (argument == "--node-limit")
+			config.node_limit = numericOption(argc, argv, i);
+		else
+		{
+			std::cerr << "unknown option: " << argument << "\n";
+			return 1;
+		}
+	}
+	TracingService_t::setEnabled(false);
+
+	try
+	{
+		malcolm::ShardCoordinator_t<value_t> coordinator(argv[2], argv[3], config);
+		coordinator.run(std::cerr);
+	}
+	catch (const std::runtime_error& error)
+	{
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+#endif
+}
+
+/// Worker of shard mode, started by `ShardCoordinator_t` with its socket as descriptor FD; solves shards of INPUT on single thread
+/// @li --shard-worker FD INPUT [--time-limit MS] [--node-limit N]
+int runShardWorker(int argc, char** argv)
+{
+#ifdef _WIN32
+	return 1;
+#else
+	using value_t = int;
+
+	if (argc < 4)
+		return 1;
+	malcolm::pipeline_config_t config;
+	config.solve_threads = 1u;
+	config.validate_threads = 1u;
+	for (auto i{ 4 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--time-limit")
+			config.time_limit = std::chrono::milliseconds(numericOption(argc, argv, i));
+		else if (argument == "--node-limit")
+			config.node_limit = numericOption(argc, argv, i);
+	}
+	TracingService_t::setEnabled(false);
+
+	return malcolm::ShardCoordinator_t<value_t>::serve(static_cast<int>(parseNumber("descriptor", argv[2])), argv[3], config);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+	using value_t = int;
+
+	try
+	{
+		if (argc > 1 && std::string{ argv[1] } == "--batch")
+			return runBatch(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--generate")
+			return runGenerator(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--sat")
+			return runSat(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--enumerate")
+			return runEnumerate(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--hints")
+			return runHints(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--multigrid")
+			return runMultiGrid(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--serve")
+			return runServer(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--client")
+			return runClient(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--shard")
+			return runShards(argc, argv);
+		if (argc > 1 && std::string{ argv[1] } == "--shard-worker")
+			return runShardWorker(argc, argv);
+	}
+	catch (const usage_error_t& error)
+	{
+		std::cerr << error.what() << "\n";
+		return 1;
+	}
+
 	malcolm::Board_t<value_t> board(9u, 9u);
 
 	for (auto i{ 0u }; i < 9u; i++)
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace utils
+{
+	/// @brief Lock-free bounded multi-producer/multi-consumer queue (ring buffer with per-slot sequence numbers).
+	/// @li Single producer/single consumer usage is just a special case, no separate implementation is needed.
+	/// @li `push()` waits while the queue is full, which gives natural backpressure to the producing side.
+	/// @li After `close()` consumers drain remaining elements and then `pop()` returns false.
+	/// @tparam T type of stored elements, has to be movable and default constructible
+	template<typename T>
+	class BoundedQueue_t
+	{
+	private:
+		/// @brief single place in the ring buffer
+		struct slot_t
+		{
+			std::atomic<std::size_t> sequence;
+			T value;
+		};
+
+		/// @brief size of cache line, used to keep producer and consumer indices apart
+		static constexpr std::size_t cache_line_size{ 64u };
+
+		/// @brief ring buffer, capacity is a power of two
+		std::unique_ptr<slot_t[]> m_slots;
+
+		/// @brief capacity - 1, used instead of modulo
+		std::size_t m_mask;
+
+		/// @brief position of next push
+		alignas(cache_line_size) std::atomic<std::size_t> m_tail{ 0u };
+
+		/// @brief position of next pop
+		alignas(cache_line_size) std::atomic<std::size_t> m_head{ 0u };
+
+		/// @brief set when no more elements will be pushed
+		alignas(cache_line_size) std::atomic<bool> m_closed{ false };
+
+		/// @brief Waits a bit before next attempt - spinning first, then giving up the time slice,
+		/// then sleeping so long idle waits (e.g. server without clients) don't occupy a core
+		static inline void backoff(std::size_t& attempt)
+		{
+			if (++attempt > 1024u)
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			else if (attempt > 64u)
+				std::this_thread::yield();
+		}
+
+	public:
+		/// @param capacity minimal number of elements the queue can hold, rounded up to power of two
+		explicit BoundedQueue_t(std::size_t capacity)
+		{
+			std::size_t rounded{ 2u };
+			while (rounded < capacity)
+				rounded <<= 1;
+			m_slots = std::make_unique<slot_t[]>(rounded);
+			m_mask = rounded - 1u;
+			for (std::size_t i{ 0u }; i < rounded; i++)
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		BoundedQueue_t(const BoundedQueue_t&) = delete;
+		BoundedQueue_t& operator=(const BoundedQueue_t&) = delete;
+
+		/// @brief Tries to insert element without waiting
+		/// @param value element to be inserted, moved from only on success
+		/// @returns false if queue is full
+		bool tryPush(T& value)
+		{
+			std::size_t position{ m_tail.load(std::memory_order_relaxed) };
+			for (;;)
+			{
+				slot_t& slot{ m_slots[position & m_mask] };
+				std::size_t sequence{ slot.sequence.load(std::memory_order_acquire) };
+				auto difference{ static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position) };
+				if (difference == 0)
+				{
+					if (m_tail.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+					{
+						slot.value = std::move(value);
+						slot.sequence.store(position + 1u, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0)
+					return false;
+				else
+					position = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		/// @brief Tries to take element without waiting
+		/// @param value object overwritten by taken element
+		/// @returns false if queue is empty
+		bool tryPop(T& value)
+		{
+			std::size_t position{ m_head.load(std::memory_order_relaxed) };
+			for (;;)
+			{
+				slot_t& slot{ m_slots[position & m_mask] };
+				std::size_t sequence{ slot.sequence.load(std::memory_order_acquire) };
+				auto difference{ static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1u) };
+				if (difference == 0)
+				{
+					if (m_head.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+					{
+						value = std::move(slot.value);
+						slot.sequence.store(position + m_mask + 1u, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0)
+					return false;
+				else
+					position = m_head.load(std::memory_order_relaxed);
+			}
+		}
+
+		/// @brief Inserts element, waiting as long as the queue is full
+		/// @param value element to be inserted
+		void push(T value)
+		{
+			std::size_t attempt{ 0u };
+			while (!tryPush(value))
+				backoff(attempt);
+		}
+
+		/// @brief Takes element, waiting as long as the queue is empty and not closed
+		/// @param value object overwritten by taken element
+		/// @returns false if queue is closed and there are no more elements
+		bool pop(T& value)
+		{
+			std::size_t attempt{ 0u };
+			while (!tryPop(value))
+			{
+				if (m_closed.load(std::memory_order_acquire))
+					return tryPop(value);
+				backoff(attempt);
+			}
+			return true;
+		}
+
+		/// @brief Marks that no more elements will be pushed
+		void close() { m_closed.store(true, std::memory_order_release); }
+
+		/// @returns maximal number of elements stored at once
+		std::size_t capacity() const { return m_mask + 1u; }
+	};
+}
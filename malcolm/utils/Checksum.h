@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace utils
+{
+	/// @brief Provides checksums used to protect data written to disk or sent through sockets
+	namespace checksum
+	{
+		/// @brief Builds lookup table for reflected CRC-32 (polynomial 0xEDB88320) at compile time
+		/// @returns table of 256 precomputed remainders
+		constexpr std::array<std::uint32_t, 256> makeCrc32Table()
+		{
+			std::array<std::uint32_t, 256> table{};
+			for (std::uint32_t i{ 0u }; i < 256u; i++)
+			{
+				std::uint32_t crc{ i };
+				for (auto bit{ 0 }; bit < 8; bit++)
+					crc = (crc & 1u) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+				table[i] = crc;
+			}
+			return table;
+		}
+
+		/// @brief Lookup table for crc32()
+		inline constexpr std::array<std::uint32_t, 256> crc32_table{ makeCrc32Table() };
+
+		/// @brief Computes CRC-32 of given bytes. Can be chained by passing result of previous call as `crc`.
+		/// @param data pointer to first byte
+		/// @param length number of bytes to process
+		/// @param crc result of previous call, when checksum is computed over several chunks
+		/// @returns CRC-32 of processed bytes
+		inline std::uint32_t crc32(const std::uint8_t* data, std::size_t length, std::uint32_t crc = 0u)
+		{
+			crc = ~crc;
+			for (std::size_t i{ 0u }; i < length; i++)
+				crc = crc32_table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+			return ~crc;
+		}
+
+		/// @brief Computes 64-bit hash of given bytes, reading 8 bytes per step. Weaker than CRC-32 against burst errors,
+		/// but several times faster, so it suits checks repeated on every lookup. Result depends on byte order of the machine.
+		/// @param data pointer to first byte
+		/// @param length number of bytes to process
+		/// @param seed initial value, different seeds give independent hashes
+		/// @returns hash of processed bytes
+		inline std::uint64_t hash64(const std::uint8_t* data, std::size_t length, std::uint64_t seed = 0u)
+		{
+			std::uint64_t hash{ seed ^ (length * 0x9E3779B97F4A7C15ull) };
+			std::size_t i{ 0u };
+			for (; i + 8u <= length; i += 8u)
+			{
+				std::uint64_t word;
+				std::memcpy(&word, data + i, 8u);
+				hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+				hash ^= hash >> 31;
+			}
+			std::uint64_t tail{ 0u };
+			for (std::size_t shift{ 0u }; i < length; i++, shift += 8u)
+				tail |= static_cast<std::uint64_t>(data[i]) << shift;
+			hash = (hash ^ tail) * 0x94D049BB133111EBull;
+			return hash ^ (hash >> 29);
+		}
+	}
+}
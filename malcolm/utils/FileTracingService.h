@@ -8,7 +8,7 @@ class FileTracingService_t : public TracingService_t
 {
 private:
 	/// @brief Used to distinct instances of FileTracingService_t class and for file numeration
-	static std::size_t _instance_counter;
+	inline static std::atomic<std::size_t> _instance_counter{ 0u };
 protected:
 	/// @brief handler to file where all traces will be saved
 	std::fstream m_file;
@@ -36,6 +36,4 @@ public:
 		if(m_used)
 			m_file.close();
 	}
-};
-
-std::size_t FileTracingService_t::_instance_counter{ 0u };
\ No newline at end of file
+};
\ No newline at end of file
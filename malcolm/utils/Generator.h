@@ -0,0 +1,123 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+namespace utils
+{
+	/// @brief Lazy sequence produced by C++20 coroutine with `co_yield`.
+	/// @li Coroutine starts suspended and runs only when the consumer asks for the next element, so nothing is computed
+	/// for elements which are never pulled. Destroying the generator destroys the suspended coroutine together with its state.
+	/// @li Only the last yielded element is stored.
+	/// @li Single pass: `begin()` resumes the coroutine, so it should be called once.
+	/// @tparam T type of yielded elements
+	template<typename T>
+	class Generator_t
+	{
+	public:
+		/// @brief Promise type required by the compiler
+		struct promise_type
+		{
+			/// last yielded element
+			std::optional<T> current;
+			/// exception thrown by the coroutine, rethrown to the consumer
+			std::exception_ptr exception;
+
+			Generator_t get_return_object() { return Generator_t{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() { exception = std::current_exception(); }
+
+			template<typename U>
+			std::suspend_always yield_value(U&& value)
+			{
+				current.emplace(std::forward<U>(value));
+				return {};
+			}
+		};
+
+		/// @brief Input iterator resuming the coroutine on increment
+		class iterator_t
+		{
+		private:
+			std::coroutine_handle<promise_type> m_handle;
+
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = T;
+
+			iterator_t() = default;
+			explicit iterator_t(std::coroutine_handle<promise_type> handle) : m_handle{ handle } {}
+
+			T& operator*() const { return *m_handle.promise().current; }
+			T* operator->() const { return &*m_handle.promise().current; }
+
+			iterator_t& operator++()
+			{
+				m_handle.promise().current.reset();
+				m_handle.resume();
+				if (m_handle.promise().exception)
+					std::rethrow_exception(m_handle.promise().exception);
+				return *this;
+			}
+			void operator++(int) { ++*this; }
+
+			bool operator==(std::default_sentinel_t) const { return !m_handle || m_handle.done(); }
+		};
+
+	private:
+		/// @brief handle of the suspended coroutine, empty after move
+		std::coroutine_handle<promise_type> m_handle;
+
+		explicit Generator_t(std::coroutine_handle<promise_type> handle)
+			: m_handle{ handle }
+		{
+		}
+
+	public:
+		Generator_t(const Generator_t&) = delete;
+		Generator_t& operator=(const Generator_t&) = delete;
+
+		Generator_t(Generator_t&& other) noexcept
+			: m_handle{ std::exchange(other.m_handle, {}) }
+		{
+		}
+
+		Generator_t& operator=(Generator_t&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (m_handle)
+					m_handle.destroy();
+				m_handle = std::exchange(other.m_handle, {});
+			}
+			return *this;
+		}
+
+		~Generator_t()
+		{
+			if (m_handle)
+				m_handle.destroy();
+		}
+
+		/// @brief Runs the coroutine up to the first element
+		/// @returns iterator pointing at the first element
+		iterator_t begin()
+		{
+			if (m_handle && !m_handle.done())
+			{
+				m_handle.resume();
+				if (m_handle.promise().exception)
+					std::rethrow_exception(m_handle.promise().exception);
+			}
+			return iterator_t{ m_handle };
+		}
+
+		/// @returns sentinel reached when the coroutine finishes
+		std::default_sentinel_t end() const { return {}; }
+	};
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+namespace utils
+{
+	/// @brief Histogram of non-negative integer samples (e.g. latencies in nanoseconds) with bounded relative error, in the spirit of HdrHistogram.
+	/// @li Values below 32 are counted exactly, larger values fall into buckets of relative width 1/32 (about 3%).
+	/// @li Fixed size, no allocation during recording. Counters are relaxed atomics, so single thread can record
+	/// while others read or merge without locks; the intended use is one histogram per thread merged at the end.
+	class LatencyHistogram_t
+	{
+	private:
+		/// @brief number of buckets per power of two
+		static constexpr std::size_t sub_buckets{ 32u };
+
+		/// @brief log2 of `sub_buckets`
+		static constexpr std::size_t sub_bucket_bits{ 5u };
+
+		/// @brief enough buckets for any 64-bit value
+		static constexpr std::size_t bucket_count{ (64u - sub_bucket_bits + 1u) * sub_buckets };
+
+		/// @brief number of samples in every bucket
+		std::array<std::atomic<std::uint64_t>, bucket_count> m_counts{};
+
+		/// @brief number of all samples
+		std::atomic<std::uint64_t> m_total{ 0u };
+
+		/// @brief the greatest recorded sample
+		std::atomic<std::uint64_t> m_max{ 0u };
+
+		/// @returns index of bucket containing given value
+		static constexpr std::size_t bucketOf(std::uint64_t value)
+		{
+			if (value < sub_buckets)
+				return static_cast<std::size_t>(value);
+			const std::size_t shift{ static_cast<std::size_t>(std::bit_width(value)) - sub_bucket_bits - 1u };
+			return (shift + 1u) * sub_buckets + static_cast<std::size_t>((value >> shift) - sub_buckets);
+		}
+
+		/// @returns the greatest value falling into bucket with given index
+		static constexpr std::uint64_t highestValueOf(std::size_t bucket)
+		{
+			if (bucket < sub_buckets)
+				return bucket;
+			const std::size_t shift{ bucket / sub_buckets - 1u };
+			const std::uint64_t sub_bucket{ bucket % sub_buckets + sub_buckets };
+			return (sub_bucket << shift) + ((std::uint64_t{ 1u } << shift) - 1u);
+		}
+
+	public:
+		/// @brief Adds single sample
+		void record(std::uint64_t value)
+		{
+			m_counts[bucketOf(value)].fetch_add(1u, std::memory_order_relaxed);
+			m_total.fetch_add(1u, std::memory_order_relaxed);
+			std::uint64_t max{ m_max.load(std::memory_order_relaxed) };
+			while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+		}
+
+		/// @brief Adds all samples of other histogram
+		void merge(const LatencyHistogram_t& other)
+		{
+			for (std::size_t i{ 0u }; i < bucket_count; i++)
+				if (auto count{ other.m_counts[i].load(std::memory_order_relaxed) }; count > 0u)
+					m_counts[i].fetch_add(count, std::memory_order_relaxed);
+			m_total.fetch_add(other.m_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			std::uint64_t max{ m_max.load(std::memory_order_relaxed) }, other_max{ other.m_max.load(std::memory_order_relaxed) };
+			while (other_max > max && !m_max.compare_exchange_weak(max, other_max, std::memory_order_relaxed));
+		}
+
+		/// @brief Removes all samples. Samples recorded concurrently may be lost or counted only partially.
+		void reset()
+		{
+			for (auto& count : m_counts)
+				count.store(0u, std::memory_order_relaxed);
+			m_total.store(0u, std::memory_order_relaxed);
+			m_max.store(0u, std::memory_order_relaxed);
+		}
+
+		/// @returns number of recorded samples
+		inline std::uint64_t count() const { return m_total.load(std::memory_order_relaxed); }
+
+		/// @returns the greatest recorded sample (exact)
+		inline std::uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+		/// @param quantile number from range 0-1, e.g. 0.99 for 99th percentile
+		/// @returns value not exceeded by given fraction of samples (rounded up to its bucket, never above `max()`)
+		std::uint64_t percentile(double quantile) const
+		{
+			const std::uint64_t total{ count() };
+			if (total == 0u)
+				return 0u;
+			const std::uint64_t rank{ std::max<std::uint64_t>(1u, static_cast<std::uint64_t>(quantile * total + 0.5)) };
+			std::uint64_t seen{ 0u };
+			for (std::size_t i{ 0u }; i < bucket_count; i++)
+			{
+				seen += m_counts[i].load(std::memory_order_relaxed);
+				if (seen >= rank)
+					return std::min(highestValueOf(i), max());
+			}
+			return max();
+		}
+
+		/// @brief Prints p50/p90/p99/p99.9/max
+		/// @param out destination stream
+		/// @param divisor samples are divided by it before printing (e.g. 1000 to print nanoseconds as microseconds)
+		/// @param unit name of unit printed after every value
+		void printSummary(std::ostream& out, double divisor, const char* unit) const
+		{
+			out << std::fixed << std::setprecision(1)
+				<< "p50 " << percentile(0.5) / divisor << unit
+				<< "  p90 " << percentile(0.9) / divisor << unit
+				<< "  p99 " << percentile(0.99) / divisor << unit
+				<< "  p99.9 " << percentile(0.999) / divisor << unit
+				<< "  max " << max() / divisor << unit;
+		}
+	};
+}
@@ -0,0 +1,347 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace utils
+{
+	/// @brief Hardware events counted by `PerfCounterGroup_t`
+	enum class perf_counter_t : std::uint8_t
+	{
+		CYCLES,
+		INSTRUCTIONS,
+		L1D_MISSES,
+		LLC_MISSES,
+		BRANCH_MISSES
+	};
+
+	/// @brief number of values of `perf_counter_t`
+	inline constexpr std::size_t perf_counter_count{ 5u };
+
+	/// @returns name of counter used in reports
+	inline const char* toString(perf_counter_t counter)
+	{
+		switch (counter)
+		{
+		case perf_counter_t::CYCLES: return "cycles";
+		case perf_counter_t::INSTRUCTIONS: return "instructions";
+		case perf_counter_t::L1D_MISSES: return "l1d_misses";
+		case perf_counter_t::LLC_MISSES: return "llc_misses";
+		default: return "branch_misses";
+		}
+	}
+
+	/// @brief Values of all counters and monotonic clock at single point in time, or difference of two such points
+	struct perf_sample_t
+	{
+		/// values indexed by `perf_counter_t`
+		std::array<std::uint64_t, perf_counter_count> counters{};
+		/// nanoseconds of `std::chrono::steady_clock`, measured even when hardware counters are unavailable
+		std::uint64_t ns{ 0u };
+	};
+
+	/// @brief Hardware counters of calling thread opened with `perf_event_open` as single group, so all of them
+	/// are read with one system call and count exactly the same instructions.
+	/// @li Only user space is counted. Counters the CPU or kernel doesn't provide stay 0, if even cycles can't be
+	/// counted (other systems than Linux, containers, `perf_event_paranoid` too high) the group is unavailable and reads return only time.
+	/// @li Values are scaled when kernel multiplexes counters.
+	class PerfCounterGroup_t
+	{
+	private:
+		/// @brief file descriptors of counters, -1 for counters which couldn't be opened
+		std::array<int, perf_counter_count> m_fds;
+
+		/// @brief position of every counter in group read, -1 for counters which couldn't be opened
+		std::array<int, perf_counter_count> m_slots;
+
+		/// @brief number of opened counters
+		std::size_t m_opened{ 0u };
+
+		/// @brief reason why the group is unavailable, empty if it's available
+		std::string m_error;
+
+#ifdef __linux__
+		/// @returns attributes of given counter
+		static perf_event_attr attributesOf(perf_counter_t counter, bool leader)
+		{
+			perf_event_attr attributes;
+			std::memset(&attributes, 0, sizeof(attributes));
+			attributes.size = sizeof(attributes);
+			attributes.type = PERF_TYPE_HARDWARE;
+			switch (counter)
+			{
+			case perf_counter_t::CYCLES: attributes.config = PERF_COUNT_HW_CPU_CYCLES; break;
+			case perf_counter_t::INSTRUCTIONS: attributes.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+			case perf_counter_t::L1D_MISSES:
+				attributes.type = PERF_TYPE_HW_CACHE;
+				attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+			case perf_counter_t::LLC_MISSES: attributes.config = PERF_COUNT_HW_CACHE_MISSES; break;
+			case perf_counter_t::BRANCH_MISSES: attributes.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+			}
+			attributes.disabled = leader ? 1u : 0u;
+			attributes.exclude_kernel = 1u;
+			attributes.exclude_hv = 1u;
+			attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			return attributes;
+		}
+#endif
+
+	public:
+		/// @brief Opens and starts counters of calling thread
+		PerfCounterGroup_t()
+		{
+			m_fds.fill(-1);
+			m_slots.fill(-1);
+#ifdef __linux__
+			for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+			{
+				const bool leader{ i == 0u };
+				perf_event_attr attributes{ attributesOf(static_cast<perf_counter_t>(i), leader) };
+				int fd{ static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, leader ? -1 : m_fds[0], 0)) };
+				if (fd < 0)
+				{
+					if (leader)
+					{
+						m_error = std::string{ "perf_event_open failed: " } + std::strerror(errno) + " (see /proc/sys/kernel/perf_event_paranoid)";
+						return;
+					}
+					continue;
+				}
+				m_fds[i] = fd;
+				m_slots[i] = static_cast<int>(m_opened++);
+			}
+			::ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			::ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+			m_error = "hardware counters are supported only on Linux";
+#endif
+		}
+
+		PerfCounterGroup_t(const PerfCounterGroup_t&) = delete;
+		PerfCounterGroup_t& operator=(const PerfCounterGroup_t&) = delete;
+
+		~PerfCounterGroup_t()
+		{
+#ifdef __linux__
+			for (int fd : m_fds)
+				if (fd >= 0)
+					::close(fd);
+#endif
+		}
+
+		/// @returns true if at least cycles are counted
+		inline bool isAvailable() const { return m_opened > 0u; }
+
+		/// @returns true if given counter is counted
+		inline bool isCounted(perf_counter_t counter) const { return m_slots[static_cast<std::size_t>(counter)] >= 0; }
+
+		/// @returns reason why the group is unavailable, empty if it's available
+		inline const std::string& getError() const { return m_error; }
+
+		/// @returns current values of counters (zeros if unavailable) and current time
+		perf_sample_t read() const
+		{
+			perf_sample_t result;
+#ifdef __linux__
+			if (isAvailable())
+			{
+				std::array<std::uint64_t, 3u + perf_counter_count> buffer{};
+				if (::read(m_fds[0], buffer.data(), sizeof(buffer)) > 0)
+				{
+					const std::uint64_t enabled{ buffer[1] }, running{ buffer[2] };
+					for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+						if (m_slots[i] >= 0)
+						{
+							std::uint64_t value{ buffer[3u + static_cast<std::size_t>(m_slots[i])] };
+							if (running > 0u && running < enabled)
+								value = static_cast<std::uint64_t>(static_cast<double>(value) * enabled / running);
+							result.counters[i] = value;
+						}
+				}
+			}
+#endif
+			result.ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+			return result;
+		}
+	};
+
+	/// @brief Process-wide collection of hardware counters per phase of work (e.g. per solving strategy).
+	/// @li Disabled by default, then `ScopedPerfPhase_t` costs a single atomic load.
+	/// @li Every thread counts into its own group and table, so recording takes no locks. Tables are merged by `printReport()`,
+	/// which should be called when recording threads are done.
+	/// @li Phases are identified by pair of string literals (group and name), which must outlive the profile.
+	class PerfProfile_t
+	{
+	public:
+		/// @brief Group and name of phase
+		using phase_key_t = std::pair<std::string_view, std::string_view>;
+
+		/// @brief Totals of single phase
+		struct phase_statistics_t
+		{
+			/// number of measured calls
+			std::uint64_t calls{ 0u };
+			/// sums of differences of counters
+			perf_sample_t totals;
+		};
+
+	private:
+		/// @brief Counters and totals of single thread
+		struct thread_profile_t
+		{
+			PerfCounterGroup_t counters;
+			std::map<phase_key_t, phase_statistics_t> phases;
+		};
+
+		/// @brief Process-wide switch, see setEnabled()
+		inline static std::atomic<bool> s_enabled{ false };
+
+		/// @brief guards `s_threads`
+		inline static std::mutex s_mutex;
+
+		/// @brief profiles of all threads which recorded anything, kept until the end of the process
+		inline static std::vector<std::unique_ptr<thread_profile_t>> s_threads;
+
+		/// @returns profile of calling thread, created on first use
+		static thread_profile_t& forThisThread()
+		{
+			thread_local thread_profile_t* profile{ nullptr };
+			if (profile == nullptr)
+			{
+				std::lock_guard lock{ s_mutex };
+				s_threads.push_back(std::make_unique<thread_profile_t>());
+				profile = s_threads.back().get();
+			}
+			return *profile;
+		}
+
+	public:
+		/// @brief Enables or disables recording of all phases
+		static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+		/// @returns true if phases are recorded
+		static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+		/// @returns current values of counters of calling thread
+		static perf_sample_t sample() { return forThisThread().counters.read(); }
+
+		/// @brief Adds difference of two samples of calling thread to given phase
+		static void record(std::string_view group, std::string_view name, const perf_sample_t& start, const perf_sample_t& end)
+		{
+			auto& statistics{ forThisThread().phases[{ group, name }] };
+			statistics.calls++;
+			for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+				statistics.totals.counters[i] += end.counters[i] - start.counters[i];
+			statistics.totals.ns += end.ns - start.ns;
+		}
+
+		/// @brief Writes per-call averages of every phase, merged from all threads. Nested phases are included in outer ones.
+		static void printReport(std::ostream& stream)
+		{
+			std::lock_guard lock{ s_mutex };
+			std::map<phase_key_t, phase_statistics_t> merged;
+			bool available{ false };
+			std::string error;
+			std::array<bool, perf_counter_count> counted{};
+			for (const auto& thread : s_threads)
+			{
+				available = available || thread->counters.isAvailable();
+				if (!thread->counters.isAvailable())
+					error = thread->counters.getError();
+				for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+					counted[i] = counted[i] || thread->counters.isCounted(static_cast<perf_counter_t>(i));
+				for (const auto& [key, statistics] : thread->phases)
+				{
+					auto& target{ merged[key] };
+					target.calls += statistics.calls;
+					for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+						target.totals.counters[i] += statistics.totals.counters[i];
+					target.totals.ns += statistics.totals.ns;
+				}
+			}
+			if (!available)
+				stream << "hardware counters unavailable" << (error.empty() ? "" : ": ") << error << ", reporting time only\n";
+
+			stream << std::left << std::setw(12) << "group" << std::setw(24) << "phase" << std::right << std::setw(10) << "calls" << std::setw(11) << "ns/call";
+			for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+				stream << std::setw(15) << toString(static_cast<perf_counter_t>(i));
+			stream << std::setw(7) << "ipc" << "\n";
+			for (const auto& [key, statistics] : merged)
+			{
+				const double calls{ static_cast<double>(std::max<std::uint64_t>(1u, statistics.calls)) };
+				stream << std::left << std::setw(12) << key.first << std::setw(24) << key.second << std::right
+					<< std::setw(10) << statistics.calls
+					<< std::setw(11) << std::fixed << std::setprecision(0) << statistics.totals.ns / calls;
+				for (std::size_t i{ 0u }; i < perf_counter_count; i++)
+				{
+					if (counted[i])
+						stream << std::setw(15) << std::setprecision(1) << statistics.totals.counters[i] / calls;
+					else
+						stream << std::setw(15) << "-";
+				}
+				const auto cycles{ statistics.totals.counters[static_cast<std::size_t>(perf_counter_t::CYCLES)] };
+				if (cycles > 0u)
+					stream << std::setw(7) << std::setprecision(2) << static_cast<double>(statistics.totals.counters[static_cast<std::size_t>(perf_counter_t::INSTRUCTIONS)]) / cycles;
+				else
+					stream << std::setw(7) << "-";
+				stream << "\n";
+			}
+		}
+	};
+
+	/// @brief Records counters from construction to destruction as given phase of `PerfProfile_t`, if it's enabled
+	class ScopedPerfPhase_t
+	{
+	private:
+		/// @brief group of the phase
+		std::string_view m_group;
+
+		/// @brief name of the phase
+		std::string_view m_name;
+
+		/// @brief true if the profile was enabled at construction
+		bool m_active;
+
+		/// @brief counters at construction
+		perf_sample_t m_start;
+
+	public:
+		/// @param group group of the phase, string literal
+		/// @param name name of the phase, string literal
+		ScopedPerfPhase_t(std::string_view group, std::string_view name)
+			: m_group{ group }, m_name{ name }, m_active{ PerfProfile_t::isEnabled() }
+		{
+			if (m_active)
+				m_start = PerfProfile_t::sample();
+		}
+
+		ScopedPerfPhase_t(const ScopedPerfPhase_t&) = delete;
+		ScopedPerfPhase_t& operator=(const ScopedPerfPhase_t&) = delete;
+
+		~ScopedPerfPhase_t()
+		{
+			if (m_active)
+				PerfProfile_t::record(m_group, m_name, m_start, PerfProfile_t::sample());
+		}
+	};
+}
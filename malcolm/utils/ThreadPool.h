@@ -0,0 +1,101 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+	/// @brief Fixed set of worker threads running submitted tasks in FIFO order.
+	/// @li Tasks shouldn't wait for other tasks of the same pool: when all workers wait, nobody runs what they wait for.
+	/// Callers which need results should rather take part in the work themselves and let the pool only help.
+	/// @li Destructor runs all queued tasks and joins the workers.
+	class ThreadPool_t
+	{
+	private:
+		/// @brief guards `m_tasks` and `m_stopping`
+		std::mutex m_mutex;
+
+		/// @brief signalled when a task is queued or the pool stops
+		std::condition_variable m_wakeup;
+
+		/// @brief tasks waiting for a worker
+		std::deque<std::function<void()>> m_tasks;
+
+		/// @brief set by destructor, workers exit when no task is left
+		bool m_stopping{ false };
+
+		/// @brief workers
+		std::vector<std::thread> m_threads;
+
+		/// @brief Body of every worker: runs tasks until the pool stops
+		void work()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock lock{ m_mutex };
+					m_wakeup.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+					if (m_tasks.empty())
+						return;
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+	public:
+		/// @param threads number of workers, can be 0 (then tasks are only queued until destruction)
+		/// @throws std::system_error if a thread can't be started
+		explicit ThreadPool_t(std::size_t threads)
+		{
+			try
+			{
+				for (std::size_t i{ 0u }; i < threads; i++)
+					m_threads.emplace_back([this]() { work(); });
+			}
+			catch (...)
+			{
+				stop();
+				throw;
+			}
+		}
+
+		ThreadPool_t(const ThreadPool_t&) = delete;
+		ThreadPool_t& operator=(const ThreadPool_t&) = delete;
+
+		~ThreadPool_t() { stop(); }
+
+		/// @brief Runs queued tasks and joins all workers, the pool only queues tasks afterwards
+		void stop()
+		{
+			{
+				std::lock_guard lock{ m_mutex };
+				m_stopping = true;
+			}
+			m_wakeup.notify_all();
+			for (auto& thread : m_threads)
+				thread.join();
+			m_threads.clear();
+		}
+
+		/// @brief Queues task for the first free worker
+		void submit(std::function<void()> task)
+		{
+			{
+				std::lock_guard lock{ m_mutex };
+				m_tasks.push_back(std::move(task));
+			}
+			m_wakeup.notify_one();
+		}
+
+		/// @returns number of workers
+		inline std::size_t size() const { return m_threads.size(); }
+	};
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <iostream>
 #include <fstream>
 
@@ -12,6 +13,9 @@ protected:
 	/// @brief Flag used to mark if we put anything into traces
 	bool m_used{ false };
 
+	/// @brief Process-wide switch for all tracing services, see setEnabled()
+	inline static std::atomic<bool> s_enabled{ true };
+
 	/// @brief Derived classes should provide various types of trace management (synchronization with database, logging to files, etc) and this special method is used to prepare first usage of service
 	/// @li It's not enough to provide constructors, e.g. if we work with files we probably won't let empty files to be created. We create files by this function instead of constructor, so we don't
 	///	left any empty file at the end of the program.
@@ -23,6 +27,11 @@ public:
 	{
 	}
 
+	/// @brief Enables or disables all tracing services. Disabled services don't create any files, which matters
+	/// when thousands of boards are solved in batch mode.
+	/// @param enabled true to write traces, false to drop them
+	static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
 	/// @brief overloaded output operator redirects objects to private output stream member field
 	/// @tparam T type with overloaded operator<< (i.e. std::ostream& operator<<(std::ostream&, const T&) must exist)
 	/// @param object information to be saved in traces
@@ -30,6 +39,8 @@ public:
 	template<typename T>
 	TracingService_t& operator<<(const T& object)
 	{
+		if (!s_enabled.load(std::memory_order_relaxed))
+			return *this;
 		if (!m_used)
 			prepareFirstUsage();
 		m_stream << object;
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "malcolm_capi.h"
+#include "Board.h"
+#include "BoardSolver.h"
+#include "SatBoardSolver.h"
+#include "StrategyScheduler.h"
+#include "ThreadPool.h"
+#include "TracingService.h"
+
+namespace
+{
+	/// Represents type of data stored in board
+	using value_t = int;
+
+	/// @brief Shared state of single `malcolm_solve_batch()` call. Helpers which start after all puzzles were taken
+	/// only look at `next`, so the state (not the caller's buffers) is all they need to outlive the call.
+	struct batch_t
+	{
+		const std::uint8_t* in;
+		std::uint8_t* out;
+		std::size_t n;
+		malcolm_options_t options;
+		/// index of the next puzzle to be taken
+		std::atomic<std::size_t> next{ 0u };
+		/// number of finished puzzles
+		std::atomic<std::size_t> done{ 0u };
+		/// number of solved puzzles
+		std::atomic<std::int64_t> solved{ 0 };
+		/// guards waiting of the caller for `done == n`
+		std::mutex mutex;
+		std::condition_variable finished;
+
+		batch_t(const std::uint8_t* in, std::uint8_t* out, std::size_t n, const malcolm_options_t& options)
+			: in{ in }, out{ out }, n{ n }, options{ options }
+		{
+		}
+	};
+
+	/// @brief guards `g_pool`
+	std::mutex g_pool_mutex;
+
+	/// @brief helpers of all batches, nullptr until the first batch and after `malcolm_shutdown()`
+	std::shared_ptr<utils::ThreadPool_t> g_pool;
+
+	/// @returns thread pool, started on first use with one thread less than hardware threads (the caller works too)
+	/// @throws std::system_error if threads can't be started
+	std::shared_ptr<utils::ThreadPool_t> threadPool()
+	{
+		std::lock_guard lock{ g_pool_mutex };
+		if (!g_pool)
+		{
+			TracingService_t::setEnabled(false); // embedding programs don't expect per-solver trace files
+			g_pool = std::make_shared<utils::ThreadPool_t>(std::max(1u, std::thread::hardware_concurrency()) - 1u);
+		}
+		return g_pool;
+	}
+
+	/// @brief Copies puzzle to output unchanged, unless it's solved in place
+	void copyInput(const std::uint8_t* puzzle, std::uint8_t* solution)
+	{
+		if (puzzle != solution)
+			std::memcpy(solution, puzzle, MALCOLM_BOARD_SIZE);
+	}
+
+	/// @brief Solves single puzzle of the batch, reading and writing caller's buffers directly
+	/// @returns MALCOLM_PUZZLE_* status
+	std::uint8_t solvePuzzle(const batch_t& batch, std::size_t index)
+	{
+		const std::uint8_t* puzzle{ batch.in + index * MALCOLM_BOARD_SIZE };
+		std::uint8_t* solution{ batch.out + index * MALCOLM_BOARD_SIZE };
+		const bool ascii{ (batch.options.flags & MALCOLM_FLAG_ASCII) != 0u };
+
+		malcolm::Board_t<value_t> board(9u, 9u);
+		auto& raw{ board.getRawBoardRef() };
+		for (std::size_t i{ 0u }; i < MALCOLM_BOARD_SIZE; i++)
+		{
+			int value{ puzzle[i] };
+			if (ascii)
+				value = value == '.' ? 0 : value - '0';
+			if (value < 0 || value > 9)
+			{
+				copyInput(puzzle, solution);
+				return MALCOLM_PUZZLE_INVALID;
+			}
+			raw[i % 9u][i / 9u] = value;
+		}
+
+		try
+		{
+			malcolm::solve_budget_t budget{ batch.options.time_limit_ms > 0u ? malcolm::solve_budget_t::withTimeout(std::chrono::milliseconds(batch.options.time_limit_ms)) : malcolm::solve_budget_t{} };
+			if (batch.options.node_limit > 0u)
+				budget.max_nodes = static_cast<std::size_t>(batch.options.node_limit);
+			thread_local auto scheduler{ std::make_shared<malcolm::StrategyScheduler_t>() }; // learns order of strategies over batches of this thread
+			auto result{ (batch.options.flags & MALCOLM_FLAG_SAT) != 0u ? malcolm::SatBoardSolver_t<value_t>(board).getSolved(budget) : malcolm::solve(board, budget, scheduler) };
+
+			if (result.status == malcolm::solve_status_t::UNSAT)
+			{
+				copyInput(puzzle, solution);
+				return MALCOLM_PUZZLE_UNSOLVABLE;
+			}
+			const auto& solved{ result.board.getRawBoardConstReference() };
+			for (std::size_t i{ 0u }; i < MALCOLM_BOARD_SIZE; i++)
+			{
+				const auto value{ static_cast<std::uint8_t>(solved[i % 9u][i / 9u]) };
+				solution[i] = ascii ? static_cast<std::uint8_t>(value == 0u ? '.' : '0' + value) : value;
+			}
+			switch (result.status)
+			{
+			case malcolm::solve_status_t::SOLVED: return MALCOLM_PUZZLE_SOLVED;
+			case malcolm::solve_status_t::TIMED_OUT:
+			case malcolm::solve_status_t::CANCELLED: return MALCOLM_PUZZLE_TIMED_OUT;
+			default: return MALCOLM_PUZZLE_UNSOLVED;
+			}
+		}
+		catch (const std::exception&)
+		{
+			copyInput(puzzle, solution);
+			return MALCOLM_PUZZLE_ERROR;
+		}
+	}
+
+	/// @brief Takes puzzles of the batch until none is left, run by the caller and by helpers from the pool
+	void work(batch_t& batch)
+	{
+		for (std::size_t index{ batch.next.fetch_add(1u) }; index < batch.n; index = batch.next.fetch_add(1u))
+		{
+			const std::uint8_t status{ solvePuzzle(batch, index) };
+			if (batch.options.statuses != nullptr)
+				batch.options.statuses[index] = status;
+			if (status == MALCOLM_PUZZLE_SOLVED)
+				batch.solved.fetch_add(1, std::memory_order_relaxed);
+			if (batch.done.fetch_add(1u) + 1u == batch.n)
+			{
+				std::lock_guard lock{ batch.mutex };
+				batch.finished.notify_all();
+			}
+		}
+	}
+}
+
+extern "C"
+{
+	MALCOLM_API std::uint32_t malcolm_abi_version(void)
+	{
+		return MALCOLM_ABI_VERSION;
+	}
+
+	MALCOLM_API void malcolm_options_init(malcolm_options_t* options)
+	{
+		if (options == nullptr)
+			return;
+		std::memset(options, 0, sizeof(*options));
+		options->struct_size = sizeof(*options);
+	}
+
+	MALCOLM_API std::int64_t malcolm_solve_batch(const std::uint8_t* in, std::uint8_t* out, std::size_t n, const malcolm_options_t* options)
+	{
+		malcolm_options_t settings;
+		malcolm_options_init(&settings);
+		if (options != nullptr)
+		{
+			if (options->struct_size < offsetof(malcolm_options_t, statuses) + sizeof(options->statuses))
+				return MALCOLM_ERROR_INVALID_ARGUMENT;
+			std::memcpy(&settings, options, std::min<std::size_t>(options->struct_size, sizeof(settings)));
+		}
+		if (n == 0u)
+			return 0;
+		if (in == nullptr || out == nullptr || n > SIZE_MAX / MALCOLM_BOARD_SIZE)
+			return MALCOLM_ERROR_INVALID_ARGUMENT;
+		const std::size_t bytes{ n * MALCOLM_BOARD_SIZE };
+		const auto in_address{ reinterpret_cast<std::uintptr_t>(in) }, out_address{ reinterpret_cast<std::uintptr_t>(out) };
+		if (in_address != out_address && in_address < out_address + bytes && out_address < in_address + bytes)
+			return MALCOLM_ERROR_INVALID_ARGUMENT;
+
+		try
+		{
+			auto pool{ threadPool() };
+			auto batch{ std::make_shared<batch_t>(in, out, n, settings) };
+			const std::size_t wanted{ settings.threads == 0u ? pool->size() : settings.threads - 1u };
+			for (std::size_t i{ 0u }, helpers{ std::min({ wanted, pool->size(), n - 1u }) }; i < helpers; i++)
+				pool->submit([batch]() { work(*batch); });
+			work(*batch);
+			std::unique_lock lock{ batch->mutex };
+			batch->finished.wait(lock, [&batch]() { return batch->done.load() == batch->n; });
+			return batch->solved.load();
+		}
+		catch (const std::exception&)
+		{
+			return MALCOLM_ERROR_INTERNAL;
+		}
+	}
+
+	MALCOLM_API const char* malcolm_status_string(std::int32_t status)
+	{
+		switch (status)
+		{
+		case MALCOLM_PUZZLE_SOLVED: return "solved";
+		case MALCOLM_PUZZLE_UNSOLVABLE: return "unsolvable";
+		case MALCOLM_PUZZLE_TIMED_OUT: return "timed_out";
+		case MALCOLM_PUZZLE_UNSOLVED: return "unsolved";
+		case MALCOLM_PUZZLE_INVALID: return "invalid";
+		case MALCOLM_PUZZLE_ERROR: return "error";
+		case MALCOLM_ERROR_INVALID_ARGUMENT: return "invalid_argument";
+		case MALCOLM_ERROR_INTERNAL: return "internal_error";
+		default: return "unknown";
+		}
+	}
+
+	MALCOLM_API void malcolm_shutdown(void)
+	{
+		std::shared_ptr<utils::ThreadPool_t> pool;
+		{
+			std::lock_guard lock{ g_pool_mutex };
+			pool = std::move(g_pool);
+		}
+		if (pool)
+			pool->stop(); // waits for helpers of batches still running, new batches start a new pool
+	}
+}
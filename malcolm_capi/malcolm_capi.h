@@ -0,0 +1,99 @@
+/*
+ * C interface of malcolm sudoku solver, for embedding it into programs written in other languages.
+ *
+ * The interface is stable: functions are only added, option fields are only appended (callers pass size of
+ * the structure they were compiled with), and numeric values of statuses never change.
+ * All functions can be called from many threads at once.
+ */
+#ifndef MALCOLM_CAPI_H
+#define MALCOLM_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(MALCOLM_CAPI_EXPORTS)
+#define MALCOLM_API __declspec(dllexport)
+#else
+#define MALCOLM_API __declspec(dllimport)
+#endif
+#else
+#define MALCOLM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Version of this interface, returned by malcolm_abi_version() */
+#define MALCOLM_ABI_VERSION 1u
+
+/* Number of bytes of single puzzle or solution in batch buffers: 81 fields written row by row */
+#define MALCOLM_BOARD_SIZE 81u
+
+/* Puzzles are read and solutions written as ASCII digits ('1'-'9', '0' or '.' for empty field on input, '.' on output)
+ * instead of raw values 0-9 */
+#define MALCOLM_FLAG_ASCII 0x1u
+
+/* Puzzles are solved with SAT backend instead of deduction strategies */
+#define MALCOLM_FLAG_SAT 0x2u
+
+/* Results of malcolm_solve_batch(); non-negative values are numbers of solved puzzles */
+#define MALCOLM_ERROR_INVALID_ARGUMENT (-1)
+#define MALCOLM_ERROR_INTERNAL (-2)
+
+/* Status of single puzzle, written to malcolm_options_t::statuses */
+#define MALCOLM_PUZZLE_SOLVED 0u
+/* puzzle has no solution, output holds the input */
+#define MALCOLM_PUZZLE_UNSOLVABLE 1u
+/* time or node limit was reached, output holds the most filled board reached */
+#define MALCOLM_PUZZLE_TIMED_OUT 2u
+/* solver ran out of techniques, output holds the most filled board reached */
+#define MALCOLM_PUZZLE_UNSOLVED 3u
+/* input contains value out of range, output holds the input */
+#define MALCOLM_PUZZLE_INVALID 4u
+/* solver failed unexpectedly, output holds the input */
+#define MALCOLM_PUZZLE_ERROR 5u
+
+/* Settings of malcolm_solve_batch(), initialize with malcolm_options_init() before changing any field */
+typedef struct malcolm_options_t
+{
+	/* sizeof(malcolm_options_t) the caller was compiled with */
+	uint32_t struct_size;
+	/* maximal number of threads solving the batch (calling thread included), 0 for all available */
+	uint32_t threads;
+	/* MALCOLM_FLAG_* */
+	uint32_t flags;
+	/* time limit of single puzzle in milliseconds, 0 for no limit */
+	uint32_t time_limit_ms;
+	/* node limit of single puzzle, 0 for no limit */
+	uint64_t node_limit;
+	/* buffer of n bytes receiving MALCOLM_PUZZLE_* of every puzzle, may be NULL */
+	uint8_t* statuses;
+} malcolm_options_t;
+
+/* Returns MALCOLM_ABI_VERSION the library was built with */
+MALCOLM_API uint32_t malcolm_abi_version(void);
+
+/* Fills options with defaults: all threads, raw values, deduction strategies, no limits, no statuses */
+MALCOLM_API void malcolm_options_init(malcolm_options_t* options);
+
+/* Solves n 9x9 puzzles stored one after another in `in` (MALCOLM_BOARD_SIZE bytes each) and writes their solutions
+ * at the same offsets of `out`. Buffers are owned by the caller and used in place, without staging copies; `in` and `out`
+ * may be the same buffer, but mustn't overlap otherwise. Puzzles are shared by an internal thread pool and the calling
+ * thread, which returns when all of them are done.
+ * options may be NULL for defaults.
+ * Returns number of solved puzzles, or MALCOLM_ERROR_* if arguments are invalid or threads can't be started. */
+MALCOLM_API int64_t malcolm_solve_batch(const uint8_t* in, uint8_t* out, size_t n, const malcolm_options_t* options);
+
+/* Returns name of MALCOLM_PUZZLE_* status or MALCOLM_ERROR_* result, the string is static */
+MALCOLM_API const char* malcolm_status_string(int32_t status);
+
+/* Stops the internal thread pool, e.g. before unloading the library. Next malcolm_solve_batch() starts it again. */
+MALCOLM_API void malcolm_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Testing.h"
+#include "BoardSerializer.h"
+#include "SolutionCounter.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+
+	/// @returns boards written with given settings
+	std::string writeAll(const std::vector<Board_t>& boards, malcolm::board_encoding_t encoding, std::size_t block_capacity)
+	{
+		std::ostringstream stream;
+		{
+			malcolm::BoardWriter_t<value_t> writer(stream, encoding, 9u, block_capacity);
+			for (const auto& board : boards)
+				writer.write(board);
+		}
+		return stream.str();
+	}
+
+	/// @returns all boards read from serialized stream
+	std::vector<Board_t> readAll(const std::string& data)
+	{
+		std::istringstream stream{ data };
+		malcolm::BoardReader_t<value_t> reader(stream);
+		std::vector<Board_t> boards;
+		Board_t board;
+		while (reader.read(board))
+			boards.push_back(board);
+		return boards;
+	}
+
+	/// @returns solutions of puzzles of e300 corpus
+	std::vector<Board_t> solvedCorpus()
+	{
+		std::vector<Board_t> solutions;
+		for (const auto& puzzle : malcolm::testing::loadCorpus("e300.txt"))
+		{
+			malcolm::SolutionCounter_t::cells_t solution;
+			CHECK(malcolm::SolutionCounter_t().count(malcolm::SolutionCounter_t::toCells(puzzle), 1u, &solution) == 1u);
+			solutions.push_back(malcolm::SolutionCounter_t::toBoard<value_t>(solution));
+		}
+		return solutions;
+	}
+
+	/// @returns true if both sequences contain the same boards
+	bool sameSequences(const std::vector<Board_t>& first, const std::vector<Board_t>& second)
+	{
+		if (first.size() != second.size())
+			return false;
+		for (std::size_t i{ 0u }; i < first.size(); i++)
+			if (!malcolm::testing::sameBoards(first[i], second[i]))
+				return false;
+		return true;
+	}
+}
+
+MALCOLM_TEST(serializerNibbleRoundTrip)
+{
+	const auto puzzles{ malcolm::testing::loadCorpus("e300.txt") };
+	for (std::size_t block_capacity : { 1u, 7u, 4096u })
+	{
+		const std::string data{ writeAll(puzzles, malcolm::board_encoding_t::NIBBLE_PACKED, block_capacity) };
+		CHECK(data.size() == malcolm::board_stream_header_t::serialized_size + (puzzles.size() + block_capacity - 1u) / block_capacity * 8u + puzzles.size() * 41u);
+		CHECK(sameSequences(readAll(data), puzzles));
+	}
+}
+
+MALCOLM_TEST(serializerPermutationRankedRoundTrip)
+{
+	const auto solutions{ solvedCorpus() };
+	const std::string data{ writeAll(solutions, malcolm::board_encoding_t::PERMUTATION_RANKED, 64u) };
+	std::istringstream stream{ data };
+	CHECK(malcolm::BoardReader_t<value_t>(stream).getHeader().record_size == 16u);
+	CHECK(sameSequences(readAll(data), solutions));
+}
+
+MALCOLM_TEST(serializerPermutationRankedRejectsPuzzle)
+{
+	std::ostringstream stream;
+	malcolm::BoardWriter_t<value_t> writer(stream, malcolm::board_encoding_t::PERMUTATION_RANKED);
+	CHECK_THROWS(writer.write(malcolm::testing::loadCorpus("e300.txt").front()), std::invalid_argument);
+	CHECK(writer.getWrittenCount() == 0u);
+}
+
+MALCOLM_TEST(serializerCorruptedBlock)
+{
+	const auto puzzles{ malcolm::testing::loadCorpus("e300.txt") };
+	const std::string data{ writeAll(puzzles, malcolm::board_encoding_t::NIBBLE_PACKED, 100u) };
+	const std::size_t second_block{ malcolm::board_stream_header_t::serialized_size + 8u + 100u * 41u };
+
+	std::string corrupted_payload{ data };
+	corrupted_payload[second_block + 8u + 50u] ^= 0x10;
+	CHECK_THROWS(readAll(corrupted_payload), std::runtime_error);
+
+	// the count isn't covered by the checksum, huge count has to be rejected before the payload is allocated
+	std::string corrupted_count{ data };
+	corrupted_count[second_block + 3u] = '\xFF';
+	CHECK_THROWS(readAll(corrupted_count), std::runtime_error);
+
+	std::string truncated_block{ data.substr(0u, data.size() - 1u) };
+	CHECK_THROWS(readAll(truncated_block), std::runtime_error);
+
+	std::string truncated_block_header{ data.substr(0u, second_block + 5u) };
+	CHECK_THROWS(readAll(truncated_block_header), std::runtime_error);
+}
+
+MALCOLM_TEST(serializerTruncatedHeader)
+{
+	const std::string data{ writeAll({}, malcolm::board_encoding_t::NIBBLE_PACKED, 16u) };
+	CHECK(data.size() == malcolm::board_stream_header_t::serialized_size);
+	CHECK(readAll(data).empty());
+	for (std::size_t length{ 0u }; length < data.size(); length++)
+		CHECK_THROWS(readAll(data.substr(0u, length)), std::runtime_error);
+
+	std::string corrupted{ data };
+	corrupted[5] = 10; // dimension
+	CHECK_THROWS(readAll(corrupted), std::runtime_error);
+}
+
+MALCOLM_TEST(serializerRejectsUnknownEncoding)
+{
+	// consistent header (valid checksum, record size of ranked 9x9 grid) with encoding values which don't exist
+	std::string data{ writeAll(solvedCorpus(), malcolm::board_encoding_t::PERMUTATION_RANKED, 16u) };
+	CHECK(readAll(data).size() == 300u);
+	for (std::uint8_t encoding : { 0u, 3u, 0xFFu })
+	{
+		std::string unknown{ data };
+		unknown[6] = static_cast<char>(encoding);
+		malcolm::detail::storeU32(reinterpret_cast<std::uint8_t*>(unknown.data()) + 12u, utils::checksum::crc32(reinterpret_cast<const std::uint8_t*>(unknown.data()), 12u));
+		CHECK_THROWS(readAll(unknown), std::runtime_error);
+	}
+	CHECK(!malcolm::BoardCodec_t<value_t>::supports(static_cast<malcolm::board_encoding_t>(3u), 9u));
+}
+
+MALCOLM_TEST(serializerNibblePackedRejectsLargeValues)
+{
+	Board_t board{ malcolm::testing::loadCorpus("e300.txt").front() };
+	std::uint8_t packed[41];
+	CHECK(malcolm::BoardCodec_t<value_t>::packNibbles(board, packed));
+	for (value_t value : { 15, 16, 31, -1 })
+	{
+		board[{ 4u, 4u }] = value;
+		CHECK(malcolm::BoardCodec_t<value_t>::packNibbles(board, packed) == (value == 15));
+	}
+
+	std::ostringstream stream;
+	malcolm::BoardWriter_t<value_t> writer(stream);
+	CHECK_THROWS(writer.write(board), std::invalid_argument);
+	CHECK(writer.getWrittenCount() == 0u);
+	board[{ 4u, 4u }] = 15;
+	writer.write(board);
+	writer.flush();
+	const auto boards{ readAll(stream.str()) };
+	CHECK(boards.size() == 1u && malcolm::testing::sameBoards(boards.front(), board));
+}
+
+MALCOLM_TEST(serializerZeroRecordBlock)
+{
+	const auto puzzles{ malcolm::testing::loadCorpus("e300.txt") };
+	const std::vector<Board_t> first{ puzzles.begin(), puzzles.begin() + 3 };
+	std::string data{ writeAll(first, malcolm::board_encoding_t::NIBBLE_PACKED, 16u) };
+
+	// empty block (count 0, CRC-32 of empty payload is 0) between the header and the first block and at the end of stream
+	const std::string empty_block(8u, '\0');
+	data.insert(malcolm::board_stream_header_t::serialized_size, empty_block);
+	data += empty_block;
+	CHECK(sameSequences(readAll(data), first));
+}
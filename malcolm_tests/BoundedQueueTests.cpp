@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "Testing.h"
+#include "BoundedQueue.h"
+
+MALCOLM_TEST(boundedQueueSingleThread)
+{
+	utils::BoundedQueue_t<int> queue{ 3u };
+	CHECK(queue.capacity() == 4u);
+	for (int value{ 0 }; value < 4; value++)
+		CHECK(queue.tryPush(value));
+	int rejected{ 4 };
+	CHECK(!queue.tryPush(rejected));
+	CHECK(rejected == 4);
+
+	int value{ -1 };
+	for (int expected{ 0 }; expected < 4; expected++)
+		CHECK(queue.tryPop(value) && value == expected);
+	CHECK(!queue.tryPop(value));
+
+	queue.push(7);
+	queue.close();
+	CHECK(queue.pop(value) && value == 7);
+	CHECK(!queue.pop(value));
+}
+
+MALCOLM_TEST(boundedQueueContention)
+{
+	constexpr std::size_t producers{ 4u }, consumers{ 4u }, per_producer{ 50000u };
+	utils::BoundedQueue_t<std::size_t> queue{ 8u };
+	std::vector<std::vector<std::size_t>> received(consumers);
+	std::atomic<std::size_t> finished_producers{ 0u };
+
+	std::vector<std::thread> threads;
+	for (std::size_t producer{ 0u }; producer < producers; producer++)
+		threads.emplace_back([&, producer]()
+			{
+				for (std::size_t i{ 0u }; i < per_producer; i++)
+					queue.push(producer * per_producer + i);
+				if (finished_producers.fetch_add(1u) + 1u == producers)
+					queue.close();
+			});
+	for (std::size_t consumer{ 0u }; consumer < consumers; consumer++)
+		threads.emplace_back([&, consumer]()
+			{
+				std::size_t value;
+				while (queue.pop(value))
+					received[consumer].push_back(value);
+			});
+	for (auto& thread : threads)
+		thread.join();
+
+	// every value arrives exactly once, and values of single producer arrive in order of their pushes
+	std::vector<std::size_t> all;
+	for (const auto& values : received)
+	{
+		std::vector<std::size_t> last(producers, 0u);
+		std::vector<bool> seen(producers, false);
+		for (auto value : values)
+		{
+			const std::size_t producer{ value / per_producer };
+			CHECK(!seen[producer] || value > last[producer]);
+			seen[producer] = true;
+			last[producer] = value;
+		}
+		all.insert(all.end(), values.begin(), values.end());
+	}
+	CHECK(all.size() == producers * per_producer);
+	std::sort(all.begin(), all.end());
+	for (std::size_t i{ 0u }; i < all.size(); i++)
+		CHECK(all[i] == i);
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Testing.h"
+#include "Canonicalizer.h"
+#include "SolutionCache.h"
+
+namespace
+{
+	using value_t = int;
+	using cells_t = malcolm::Canonicalizer_t::cells_t;
+
+	/// @returns random symmetry of classic sudoku
+	malcolm::Canonicalizer_t::transform_t randomTransform(std::mt19937& random)
+	{
+		malcolm::Canonicalizer_t::transform_t transform;
+		transform.transpose = random() % 2u == 1u;
+		for (auto* lines : { &transform.rows, &transform.columns })
+		{
+			std::array<std::uint8_t, 3> groups{ 0, 1, 2 };
+			std::shuffle(groups.begin(), groups.end(), random);
+			for (std::size_t group{ 0u }; group < 3u; group++)
+			{
+				std::array<std::uint8_t, 3> inside{ 0, 1, 2 };
+				std::shuffle(inside.begin(), inside.end(), random);
+				for (std::size_t i{ 0u }; i < 3u; i++)
+					(*lines)[group * 3u + i] = static_cast<std::uint8_t>(groups[group] * 3u + inside[i]);
+			}
+		}
+		std::shuffle(transform.values.begin() + 1, transform.values.end(), random);
+		return transform;
+	}
+}
+
+MALCOLM_TEST(canonicalizerInverseTransform)
+{
+	std::mt19937 random{ 29u };
+	malcolm::Canonicalizer_t canonicalizer;
+	const auto corpus{ malcolm::testing::loadCorpus("e300.txt") };
+	for (std::size_t i{ 0u }; i < 40u; i++)
+	{
+		const cells_t puzzle{ malcolm::SolutionCounter_t::toCells(corpus[i]) };
+		const auto symmetry{ randomTransform(random) };
+		CHECK(symmetry.invert(symmetry.apply(puzzle)) == puzzle);
+
+		malcolm::Canonicalizer_t::transform_t transform, symmetric_transform;
+		const cells_t canonical{ canonicalizer.canonicalize(puzzle, transform) };
+		const cells_t symmetric{ symmetry.apply(puzzle) };
+		CHECK(canonicalizer.canonicalize(symmetric, symmetric_transform) == canonical);
+		CHECK(transform.apply(puzzle) == canonical);
+		CHECK(transform.invert(canonical) == puzzle);
+		CHECK(symmetric_transform.invert(canonical) == symmetric);
+
+		// relabelling stays a bijection even for values which don't occur on the board
+		std::array<std::uint8_t, 10> values{ transform.values };
+		std::sort(values.begin(), values.end());
+		std::array<std::uint8_t, 10> expected;
+		std::iota(expected.begin(), expected.end(), std::uint8_t{ 0u });
+		CHECK(values == expected);
+	}
+}
+
+MALCOLM_TEST(solutionCacheMapsSymmetricPuzzles)
+{
+	std::mt19937 random{ 30u };
+	malcolm::SolutionCache_t<value_t> cache{ 1000u, 4u };
+	std::size_t solved{ 0u };
+	auto solve = [&solved](const malcolm::Board_t<value_t>& puzzle)
+		{
+			solved++;
+			malcolm::SolutionCounter_t::cells_t solution;
+			malcolm::SolutionCounter_t().count(malcolm::SolutionCounter_t::toCells(puzzle), 1u, &solution);
+			return malcolm::SolutionCounter_t::toBoard<value_t>(solution);
+		};
+
+	// distinct puzzles never need canonicalization
+	const auto corpus{ malcolm::testing::loadCorpus("e300.txt") };
+	for (const auto& puzzle : corpus)
+		cache.getSolved(puzzle, solve);
+	CHECK(cache.getMisses() == corpus.size());
+	CHECK(cache.getCanonicalized() == 0u);
+
+	// exact repeats are found by comparison, symmetric copies by canonical form
+	std::size_t requests{ 0u };
+	for (const auto& board : corpus)
+	{
+		const cells_t puzzle{ malcolm::SolutionCounter_t::toCells(board) };
+		cells_t expected;
+		if (malcolm::SolutionCounter_t().count(puzzle, 2u, &expected) != 1u)
+			continue;
+		const auto symmetry{ randomTransform(random) };
+		for (const auto& [request, request_solution] : { std::pair{ puzzle, expected }, std::pair{ symmetry.apply(puzzle), symmetry.apply(expected) } })
+			CHECK(malcolm::SolutionCounter_t::toCells(cache.getSolved(malcolm::SolutionCounter_t::toBoard<value_t>(request), solve)) == request_solution);
+		if ((requests += 2u) == 60u)
+			break;
+	}
+	CHECK(requests == 60u);
+	CHECK(solved == corpus.size());
+	CHECK(cache.getHits() == 60u);
+	CHECK(cache.getCanonicalized() <= 60u);
+}
@@ -0,0 +1,77 @@
+#include <random>
+#include <stdexcept>
+
+#include "Testing.h"
+#include "BoardValidator.h"
+#include "IncrementalValidator.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+
+	/// @returns true if value doesn't occur in row, column nor subboard of given position
+	bool isFree(const Board_t& board, const malcolm::pos_t& pos, value_t value)
+	{
+		for (std::size_t i{ 0u }; i < 9u; i++)
+			if (board[{ i, pos.second }] == value || board[{ pos.first, i }] == value
+				|| board[{ pos.first / 3u * 3u + i % 3u, pos.second / 3u * 3u + i / 3u }] == value)
+				return false;
+		return true;
+	}
+}
+
+MALCOLM_TEST(incrementalValidatorSetUndo)
+{
+	std::mt19937 random{ 33u };
+	const auto corpus{ malcolm::testing::loadCorpus("guess.txt") };
+	for (std::size_t i{ 0u }; i < 50u; i++)
+	{
+		Board_t board{ corpus[i] };
+		const Board_t initial{ board };
+		malcolm::IncrementalValidator_t<value_t> validator{ board };
+		CHECK(validator.isConsistent());
+
+		// random edits, every state is compared with validation of the whole board
+		for (std::size_t step{ 0u }; step < 200u; step++)
+		{
+			const malcolm::pos_t pos{ random() % 9u, random() % 9u };
+			const value_t value{ static_cast<value_t>(random() % 10u) };
+			const bool legal{ validator.isLegal(pos, value) };
+			CHECK(legal == (board[pos] == 0 && value != 0 && isFree(board, pos, value)));
+			validator.set(pos, value);
+			board[pos] = value;
+			CHECK(validator[pos] == value);
+			CHECK(validator.isConsistent() == malcolm::BoardValidator_t<value_t>::getInstance().validateBoard(board));
+		}
+		CHECK(validator.getHistorySize() == 200u);
+
+		while (validator.undo())
+			;
+		CHECK(validator.getHistorySize() == 0u);
+		CHECK(validator.isConsistent());
+		for (std::size_t x{ 0u }; x < 9u; x++)
+			for (std::size_t y{ 0u }; y < 9u; y++)
+				CHECK(validator[{ x, y }] == initial[{ x, y }]);
+	}
+}
+
+MALCOLM_TEST(incrementalValidatorRejectsOutOfRangeValues)
+{
+	Board_t board(9u, 9u);
+	board[{ 0u, 0u }] = 12;
+	CHECK_THROWS(malcolm::IncrementalValidator_t<value_t>{ board }, std::invalid_argument);
+	board[{ 0u, 0u }] = -1;
+	CHECK_THROWS(malcolm::IncrementalValidator_t<value_t>{ board }, std::invalid_argument);
+	CHECK_THROWS(malcolm::IncrementalValidator_t<value_t>{ Board_t(4u, 4u) }, std::invalid_argument);
+
+	board[{ 0u, 0u }] = 5;
+	malcolm::IncrementalValidator_t<value_t> validator{ board };
+	CHECK_THROWS(validator.set({ 1u, 0u }, 10), std::invalid_argument);
+	CHECK(validator.getHistorySize() == 0u);
+	CHECK(validator[{ 1u, 0u }] == 0);
+	CHECK(!validator.isLegal({ 1u, 0u }, 0));
+	CHECK(!validator.isLegal({ 1u, 0u }, 16));
+	CHECK(validator.isLegal({ 1u, 0u }, 9));
+	CHECK(validator.isConsistent());
+}
@@ -0,0 +1,80 @@
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "Testing.h"
+#include "BoardSolver.h"
+#include "BoardValidator.h"
+#include "KillerCages.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+
+	/// @brief Killer puzzle in the line format of `SolvingPipeline_t`
+	struct killer_puzzle_t
+	{
+		Board_t givens;
+		std::shared_ptr<const malcolm::KillerCages_t> cages;
+	};
+
+	/// @returns puzzles of killer.txt, which are all solvable by strategies
+	std::vector<killer_puzzle_t> loadKillerCorpus()
+	{
+		std::ifstream file{ malcolm::testing::dataDirectory() + "/killer.txt" };
+		std::vector<killer_puzzle_t> puzzles;
+		for (std::string line; std::getline(file, line);)
+		{
+			const std::size_t separator{ line.find('|') };
+			killer_puzzle_t puzzle{ Board_t(9u, 9u), nullptr };
+			CHECK(separator != std::string::npos && malcolm::SolvingPipeline_t<value_t>::parseLine(line.substr(0u, separator), puzzle.givens));
+			puzzle.cages = std::make_shared<const malcolm::KillerCages_t>(malcolm::KillerCages_t::parse(line.substr(separator + 1u)));
+			puzzles.push_back(std::move(puzzle));
+		}
+		CHECK(puzzles.size() == 20u);
+		return puzzles;
+	}
+}
+
+MALCOLM_TEST(killerSolutionsSatisfyCages)
+{
+	for (const auto& puzzle : loadKillerCorpus())
+	{
+		const auto result{ malcolm::solve(puzzle.givens, {}, nullptr, puzzle.cages) };
+		CHECK(result.status == malcolm::solve_status_t::SOLVED);
+		CHECK(malcolm::BoardValidator_t<value_t>::getInstance().validateBoard(result.board));
+
+		// cages are checked here independently of `KillerCages_t::isSatisfiedBy()`, and have to cover the board
+		std::set<std::size_t> covered;
+		for (const auto& cage : puzzle.cages->getCages())
+		{
+			std::set<value_t> digits;
+			std::uint32_t sum{ 0u };
+			for (auto field : cage.fields)
+			{
+				const value_t value{ result.board[{ field % 9u, field / 9u }] };
+				CHECK(value >= 1 && value <= 9);
+				CHECK(digits.insert(value).second);
+				sum += static_cast<std::uint32_t>(value);
+				covered.insert(field);
+			}
+			CHECK(sum == cage.sum);
+		}
+		CHECK(covered.size() == 81u);
+		CHECK(puzzle.cages->isSatisfiedBy(result.board));
+	}
+}
+
+MALCOLM_TEST(killerRejectsImpossibleCage)
+{
+	// two fields can't sum to 2 with distinct digits
+	const auto cages{ std::make_shared<const malcolm::KillerCages_t>(malcolm::KillerCages_t::parse("2:0,1")) };
+	const auto result{ malcolm::solve(Board_t(9u, 9u), {}, nullptr, cages) };
+	CHECK(result.status == malcolm::solve_status_t::UNSAT);
+
+	CHECK_THROWS(malcolm::KillerCages_t::parse("10:0,0"), std::invalid_argument);
+	CHECK_THROWS(malcolm::KillerCages_t::parse("10:80,81"), std::invalid_argument);
+	CHECK_THROWS(malcolm::KillerCages_t::parse("10 0,1"), std::invalid_argument);
+}
@@ -0,0 +1,97 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Testing.h"
+#include "BoardValidator.h"
+#include "MultiGridLayout.h"
+#include "MultiGridSolver.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+
+	/// @returns value at given canvas position of grid, which has to cover it
+	value_t atCanvas(const malcolm::MultiGridLayout_t& layout, const std::vector<Board_t>& grids, std::size_t grid, std::size_t x, std::size_t y)
+	{
+		const auto& [origin_x, origin_y] { layout.getOrigin(grid) };
+		return grids[grid][{ x - origin_x, y - origin_y }];
+	}
+
+	/// @returns true if grid covers given canvas position
+	bool covers(const malcolm::MultiGridLayout_t& layout, std::size_t grid, std::size_t x, std::size_t y)
+	{
+		const auto& [origin_x, origin_y] { layout.getOrigin(grid) };
+		return x >= origin_x && x < origin_x + 9u && y >= origin_y && y < origin_y + 9u;
+	}
+}
+
+MALCOLM_TEST(samuraiSharedBoxesAgree)
+{
+	const auto layout{ std::make_shared<const malcolm::MultiGridLayout_t>(malcolm::MultiGridLayout_t::parse("samurai")) };
+	CHECK(layout->getGridCount() == 5u);
+
+	// full solution found by search from empty grids, then puzzle keeping about half of its cells
+	const auto full{ malcolm::MultiGridSolver_t<value_t>(layout, std::vector<Board_t>(5u, Board_t(9u, 9u))).getSolved() };
+	CHECK(full.status == malcolm::solve_status_t::SOLVED);
+	std::mt19937 random{ 50u };
+	std::vector<Board_t> puzzle(5u, Board_t(9u, 9u));
+	for (std::size_t cell{ 0u }; cell < layout->getCellCount(); cell++)
+		if (random() % 2u == 0u)
+			for (auto occurrence : layout->getOccurrences(cell))
+			{
+				const auto position{ malcolm::bitboard_t::positionOf(occurrence % 81u) };
+				puzzle[occurrence / 81u][position] = full.grids[occurrence / 81u][position];
+			}
+	std::string line;
+	for (const auto& grid : puzzle)
+		for (std::size_t field{ 0u }; field < 81u; field++)
+			line += static_cast<char>('0' + grid[malcolm::bitboard_t::positionOf(field)]);
+	const auto parsed{ malcolm::MultiGridSolver_t<value_t>::parseLine(line, *layout) };
+	CHECK(parsed.size() == 5u);
+	for (std::size_t grid{ 0u }; grid < parsed.size(); grid++)
+		CHECK(malcolm::testing::sameBoards(parsed[grid], puzzle[grid]));
+
+	const auto result{ malcolm::MultiGridSolver_t<value_t>(layout, parsed).getSolved() };
+	CHECK(result.status == malcolm::solve_status_t::SOLVED);
+	CHECK(result.grids.size() == 5u);
+	for (std::size_t grid{ 0u }; grid < result.grids.size(); grid++)
+	{
+		CHECK(malcolm::BoardValidator_t<value_t>::getInstance().validateBoard(result.grids[grid]));
+		for (std::size_t x{ 0u }; x < 9u; x++)
+			for (std::size_t y{ 0u }; y < 9u; y++)
+				CHECK(result.grids[grid][{ x, y }] != 0 && (puzzle[grid][{ x, y }] == 0 || puzzle[grid][{ x, y }] == result.grids[grid][{ x, y }]));
+	}
+
+	// grids overlap only in corner boxes of the middle grid, where both see the same values
+	std::size_t shared{ 0u };
+	for (std::size_t y{ 0u }; y < layout->getHeight(); y++)
+		for (std::size_t x{ 0u }; x < layout->getWidth(); x++)
+			for (std::size_t first{ 0u }; first < 5u; first++)
+				for (std::size_t second{ first + 1u }; second < 5u; second++)
+					if (covers(*layout, first, x, y) && covers(*layout, second, x, y))
+					{
+						CHECK(second == 2u || first == 2u);
+						CHECK(atCanvas(*layout, result.grids, first, x, y) == atCanvas(*layout, result.grids, second, x, y));
+						shared++;
+					}
+	CHECK(shared == 4u * 9u);
+}
+
+MALCOLM_TEST(samuraiConflictingSharedGivens)
+{
+	const auto layout{ std::make_shared<const malcolm::MultiGridLayout_t>(malcolm::MultiGridLayout_t::parse("samurai")) };
+	// bottom right field of the top left grid is at (2, 2) in the middle grid, which starts 6 fields further
+	std::vector<Board_t> grids(5u, Board_t(9u, 9u));
+	grids[0][{ 8u, 8u }] = 1;
+	grids[2][{ 2u, 2u }] = 2;
+	CHECK(malcolm::MultiGridSolver_t<value_t>(layout, grids).getSolved().status == malcolm::solve_status_t::UNSAT);
+
+	grids[2][{ 2u, 2u }] = 1;
+	const auto result{ malcolm::MultiGridSolver_t<value_t>(layout, grids).getSolved() };
+	CHECK(result.status == malcolm::solve_status_t::SOLVED);
+	CHECK(result.grids[0][{ 8u, 8u }] == 1 && result.grids[2][{ 2u, 2u }] == 1);
+	CHECK_THROWS(malcolm::MultiGridSolver_t<value_t>(layout, std::vector<Board_t>(4u, Board_t(9u, 9u))), std::invalid_argument);
+}
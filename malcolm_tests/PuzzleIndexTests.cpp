@@ -0,0 +1,99 @@
+#ifndef _WIN32
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+#include "Testing.h"
+#include "PuzzleIndex.h"
+#include "SolutionCounter.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+
+	/// @brief Unique index file in temporary directory, removed (with temporary file of growing) at the end of the test
+	struct temporary_index_t
+	{
+		std::string path;
+
+		temporary_index_t()
+		{
+			std::string pattern{ (std::filesystem::temp_directory_path() / "malcolm_index_XXXXXX").string() };
+			const int fd{ ::mkstemp(pattern.data()) };
+			if (fd < 0)
+				throw malcolm::testing::failure_t("can't create temporary index file");
+			::close(fd);
+			path = pattern;
+		}
+
+		~temporary_index_t()
+		{
+			::unlink(path.c_str());
+			::unlink((path + ".tmp").c_str());
+		}
+	};
+
+	/// @returns index status of the puzzle together with its (first) solution
+	std::pair<malcolm::index_status_t, Board_t> statusOf(const Board_t& puzzle)
+	{
+		malcolm::SolutionCounter_t::cells_t solution;
+		switch (malcolm::SolutionCounter_t().count(malcolm::SolutionCounter_t::toCells(puzzle), 2u, &solution))
+		{
+		case 0u:
+			return { malcolm::index_status_t::UNSOLVABLE, puzzle };
+		case 1u:
+			return { malcolm::index_status_t::SOLVED, malcolm::SolutionCounter_t::toBoard<value_t>(solution) };
+		default:
+			return { malcolm::index_status_t::NOT_UNIQUE, malcolm::SolutionCounter_t::toBoard<value_t>(solution) };
+		}
+	}
+}
+
+MALCOLM_TEST(puzzleIndexInsertGrowLookup)
+{
+	const temporary_index_t file;
+	auto corpus{ malcolm::testing::loadCorpus("e300.txt") };
+	Board_t unsolvable(9u, 9u);
+	unsolvable[{ 0u, 0u }] = 4;
+	unsolvable[{ 0u, 1u }] = 4;
+	corpus.push_back(unsolvable);
+
+	malcolm::PuzzleIndex_t<value_t> writer{ file.path, true, 16u };
+	malcolm::PuzzleIndex_t<value_t> reader{ file.path, false };
+	Board_t found(9u, 9u);
+	CHECK(!writer.lookup(corpus.front(), found));
+
+	// 16 slots grow several times while inserting, records inserted so far stay visible after every rebuild
+	for (std::size_t i{ 0u }; i < corpus.size(); i++)
+	{
+		const auto [status, solution] { statusOf(corpus[i]) };
+		CHECK(writer.insert(corpus[i], status, solution));
+		CHECK(!writer.insert(corpus[i], status, solution));
+		CHECK(writer.lookup(corpus[i / 2u], found).has_value());
+	}
+	CHECK(writer.commit());
+	CHECK(writer.size() == corpus.size());
+	CHECK(writer.getInserted() == corpus.size());
+	CHECK(std::filesystem::file_size(file.path) >= 4096u + 128u * 4u / 3u * corpus.size());
+
+	// reader keeps its old mapping until refresh, then finds everything; so does a fresh instance
+	reader.refresh();
+	malcolm::PuzzleIndex_t<value_t> reopened{ file.path, false };
+	for (auto* index : { &writer, &reader, &reopened })
+		for (const auto& puzzle : corpus)
+		{
+			const auto [status, solution] { statusOf(puzzle) };
+			CHECK(index->lookup(puzzle, found) == status);
+			CHECK(malcolm::testing::sameBoards(found, solution));
+		}
+	CHECK(reopened.getHits() == corpus.size());
+
+	Board_t missing{ corpus.front() };
+	missing[{ 0u, 0u }] = missing[{ 0u, 0u }] == 0 ? 1 : 0;
+	CHECK(!reopened.lookup(missing, found));
+	CHECK(reopened.getMisses() == 1u);
+	CHECK(!reopened.insert(missing, malcolm::index_status_t::UNSOLVABLE, missing));
+}
+#endif
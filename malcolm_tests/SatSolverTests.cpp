@@ -0,0 +1,62 @@
+#include "Testing.h"
+#include "BoardSolver.h"
+#include "BoardValidator.h"
+#include "SatBoardSolver.h"
+#include "SolutionCounter.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+
+	/// @returns true if solution is complete, valid and keeps all givens of puzzle
+	bool solves(const Board_t& puzzle, const Board_t& solution)
+	{
+		for (std::size_t x{ 0u }; x < 9u; x++)
+			for (std::size_t y{ 0u }; y < 9u; y++)
+				if (solution[{ x, y }] == 0 || (puzzle[{ x, y }] != 0 && puzzle[{ x, y }] != solution[{ x, y }]))
+					return false;
+		return malcolm::BoardValidator_t<value_t>::getInstance().validateBoard(solution);
+	}
+}
+
+MALCOLM_TEST(satAgreesWithStrategySolver)
+{
+	for (const char* name : { "e300.txt", "guess.txt" })
+		for (const auto& puzzle : malcolm::testing::loadCorpus(name))
+		{
+			const auto strategies{ malcolm::solve(puzzle, {}) };
+			const std::size_t solutions{ malcolm::SolutionCounter_t().count(malcolm::SolutionCounter_t::toCells(puzzle), 2u) };
+			for (bool preprocess : { true, false })
+			{
+				const auto sat{ malcolm::SatBoardSolver_t<value_t>(puzzle, preprocess).getSolved() };
+				CHECK(sat.status == (solutions == 0u ? malcolm::solve_status_t::UNSAT : malcolm::solve_status_t::SOLVED));
+				if (sat.status == malcolm::solve_status_t::SOLVED)
+					CHECK(solves(puzzle, sat.board));
+				// strategies leave puzzles with more solutions unsolved, unique one leaves no room for disagreement
+				if (solutions == 1u)
+				{
+					CHECK(strategies.status == malcolm::solve_status_t::SOLVED);
+					CHECK(malcolm::testing::sameBoards(sat.board, strategies.board));
+				}
+				else if (solutions == 0u)
+					CHECK(strategies.status == malcolm::solve_status_t::UNSAT);
+			}
+		}
+}
+
+MALCOLM_TEST(satRejectsOutOfRangeGivens)
+{
+	for (value_t given : { 12, 10, -1 })
+	{
+		Board_t puzzle(9u, 9u);
+		puzzle[{ 0u, 0u }] = given;
+		for (bool preprocess : { true, false })
+			CHECK(malcolm::SatBoardSolver_t<value_t>(puzzle, preprocess).getSolved().status == malcolm::solve_status_t::UNSAT);
+	}
+
+	Board_t contradiction(9u, 9u);
+	contradiction[{ 0u, 0u }] = 5;
+	contradiction[{ 8u, 0u }] = 5;
+	CHECK(malcolm::SatBoardSolver_t<value_t>(contradiction).getSolved().status == malcolm::solve_status_t::UNSAT);
+}
@@ -0,0 +1,163 @@
+#ifndef _WIN32
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Testing.h"
+#include "ShardCoordinator.h"
+
+namespace
+{
+	using value_t = int;
+
+	/// @brief Unique directory in temporary directory, removed with its content at the end of the test
+	struct temporary_directory_t
+	{
+		std::string path;
+
+		temporary_directory_t()
+		{
+			std::string pattern{ (std::filesystem::temp_directory_path() / "malcolm_shards_XXXXXX").string() };
+			if (::mkdtemp(pattern.data()) == nullptr)
+				throw malcolm::testing::failure_t("can't create temporary directory");
+			path = pattern;
+		}
+
+		~temporary_directory_t()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(path, error);
+		}
+	};
+
+	/// @returns first `count` lines of corpus file, newlines included
+	std::string corpusLines(const std::string& name, std::size_t count)
+	{
+		std::ifstream file{ malcolm::testing::dataDirectory() + "/" + name };
+		std::string lines;
+		for (std::string line; count > 0u && std::getline(file, line); count--)
+			lines += line + "\n";
+		return lines;
+	}
+
+	void writeFile(const std::string& path, const std::string& content)
+	{
+		std::ofstream{ path, std::ios::binary } << content;
+	}
+
+	std::string readFile(const std::string& path)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+	}
+
+	/// @returns output of single `SolvingPipeline_t` run, which sharded run has to reproduce
+	std::string runPipeline(const std::string& input)
+	{
+		std::istringstream in{ input };
+		std::ostringstream out;
+		malcolm::SolvingPipeline_t<value_t>(malcolm::pipeline_config_t{}).run(in, out);
+		return out.str();
+	}
+}
+
+MALCOLM_TEST(shardCoordinatorKeepsShardsOfMalformedLines)
+{
+	const temporary_directory_t directory;
+	// every line of the middle shards gives 84 bytes of rejected result out of 2 bytes of input
+	std::string input{ corpusLines("e300.txt", 3u) };
+	for (std::size_t i{ 0u }; i < 40u; i++)
+		input += "x\n";
+	input += corpusLines("guess.txt", 2u);
+	writeFile(directory.path + "/input.txt", input);
+
+	malcolm::shard_config_t config;
+	config.workers = 2u;
+	config.shard_size = 60u;
+	config.attempts = 1u;
+	std::ostringstream report;
+	malcolm::ShardCoordinator_t<value_t>(directory.path + "/input.txt", directory.path + "/output.txt", config).run(report);
+	CHECK(readFile(directory.path + "/output.txt") == runPipeline(input));
+	CHECK(report.str().find(" 0 workers restarted") != std::string::npos);
+	CHECK(!std::filesystem::exists(directory.path + "/output.txt.shards"));
+}
+
+MALCOLM_TEST(shardWorkerStopsAtInvalidRange)
+{
+	const temporary_directory_t directory;
+	const std::string input{ corpusLines("e300.txt", 2u) };
+	writeFile(directory.path + "/input.txt", input);
+
+	for (const auto& [begin, end] : { std::pair<std::uint64_t, std::uint64_t>{ 82u, 1u }, { 0u, input.size() + 1u }, { 0u, ~std::uint64_t{ 0u } } })
+	{
+		int sockets[2];
+		CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+		int exit_code{ -1 };
+		std::thread worker{ [&]() { exit_code = malcolm::ShardCoordinator_t<value_t>::serve(sockets[1], directory.path + "/input.txt", malcolm::pipeline_config_t{}); } };
+
+		// valid range is answered, the invalid one ends the worker without reading or answering anything
+		std::array<std::uint8_t, malcolm::shard_protocol_t::assignment_size> assignment;
+		std::array<std::uint8_t, malcolm::shard_protocol_t::result_header_size> header;
+		for (const auto& [shard, range_begin, range_end] : { std::tuple<std::uint32_t, std::uint64_t, std::uint64_t>{ 7u, 0u, input.size() }, { 8u, begin, end } })
+		{
+			malcolm::detail::storeU32(assignment.data(), shard);
+			malcolm::detail::storeU64(assignment.data() + 4u, range_begin);
+			malcolm::detail::storeU64(assignment.data() + 12u, range_end);
+			CHECK(malcolm::detail::writeFully(sockets[0], assignment.data(), assignment.size()));
+		}
+		CHECK(malcolm::detail::readFully(sockets[0], header.data(), header.size()));
+		CHECK(malcolm::detail::loadU32(header.data()) == 7u);
+		CHECK(malcolm::detail::loadU32(header.data() + 4u) == 2u);
+		CHECK(malcolm::detail::loadU64(header.data() + 8u) == 2u * malcolm::text_result_size);
+		std::string results(2u * malcolm::text_result_size, '\0');
+		CHECK(malcolm::detail::readFully(sockets[0], reinterpret_cast<std::uint8_t*>(results.data()), results.size()));
+		CHECK(results == runPipeline(input));
+
+		worker.join();
+		CHECK(exit_code == 0);
+		::close(sockets[1]);
+		CHECK(!malcolm::detail::readFully(sockets[0], header.data(), header.size()));
+		::close(sockets[0]);
+	}
+}
+
+MALCOLM_TEST(shardCoordinatorResumesFromCheckpoint)
+{
+	const temporary_directory_t directory;
+	const std::string input{ corpusLines("e300.txt", 35u) };
+	writeFile(directory.path + "/input.txt", input);
+	const std::string output{ directory.path + "/output.txt" };
+
+	// first run creates the checkpoint, but its workers can't even start
+	malcolm::shard_config_t config;
+	config.workers = 2u;
+	config.shard_size = 10u * 82u; // 10 lines of 81 characters
+	config.attempts = 1u;
+	config.executable = directory.path + "/missing-executable";
+	std::ostringstream report;
+	CHECK_THROWS(malcolm::ShardCoordinator_t<value_t>(directory.path + "/input.txt", output, config).run(report), std::runtime_error);
+	CHECK(std::filesystem::exists(output + ".shards/manifest"));
+	CHECK(!std::filesystem::exists(output));
+
+	// result of the first shard is found in the checkpoint (distinguishable from real one), the rest is solved by the second run
+	const std::string completed{ [] { std::string lines; for (std::size_t i{ 0u }; i < 10u; i++) lines += std::string(81u, '9') + " 0\n"; return lines; }() };
+	writeFile(output + ".shards/shard-00000000", completed);
+	config.executable = "/proc/self/exe";
+	malcolm::ShardCoordinator_t<value_t>(directory.path + "/input.txt", output, config).run(report);
+	CHECK(readFile(output) == completed + runPipeline(input.substr(10u * 82u)));
+	CHECK(report.str().find("shards: 4 total, 1 from checkpoint, 3 solved (25 puzzles)") != std::string::npos);
+	CHECK(!std::filesystem::exists(output + ".shards"));
+
+	// checkpoint of different input is refused
+	std::filesystem::create_directory(output + ".shards");
+	writeFile(output + ".shards/manifest", "malcolm shards 1\n0 0 0 0\n");
+	CHECK_THROWS(malcolm::ShardCoordinator_t<value_t>(directory.path + "/input.txt", output, config).run(report), std::runtime_error);
+}
+#endif
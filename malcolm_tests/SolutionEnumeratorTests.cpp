@@ -0,0 +1,59 @@
+#include <random>
+#include <set>
+
+#include "Testing.h"
+#include "BoardValidator.h"
+#include "SolutionCounter.h"
+#include "SolutionEnumerator.h"
+
+namespace
+{
+	using value_t = int;
+	using Board_t = malcolm::Board_t<value_t>;
+	using cells_t = malcolm::SolutionCounter_t::cells_t;
+
+	/// @brief Pulls at most limit solutions, checks every one is valid, keeps givens and differs from the previous ones
+	/// @returns number of pulled solutions
+	std::size_t enumerate(const Board_t& puzzle, std::size_t limit)
+	{
+		std::set<cells_t> seen;
+		for (const auto& solution : malcolm::enumerateSolutions(puzzle))
+		{
+			const cells_t cells{ malcolm::SolutionCounter_t::toCells(solution) };
+			const cells_t givens{ malcolm::SolutionCounter_t::toCells(puzzle) };
+			for (std::size_t i{ 0u }; i < cells.size(); i++)
+				CHECK(cells[i] != 0u && (givens[i] == 0u || givens[i] == cells[i]));
+			CHECK(malcolm::BoardValidator_t<value_t>::getInstance().validateBoard(solution));
+			CHECK(seen.insert(cells).second);
+			if (seen.size() == limit)
+				break;
+		}
+		return seen.size();
+	}
+}
+
+MALCOLM_TEST(enumeratorMatchesSolutionCounter)
+{
+	constexpr std::size_t limit{ 40u };
+	std::mt19937 random{ 44u };
+	for (const auto& puzzle : malcolm::testing::loadCorpus("e300.txt"))
+	{
+		const cells_t cells{ malcolm::SolutionCounter_t::toCells(puzzle) };
+		CHECK(enumerate(puzzle, limit) == malcolm::SolutionCounter_t().count(cells, limit));
+
+		// fewer givens, so that counts reach the limit too
+		Board_t sparse{ puzzle };
+		for (std::size_t removed{ 0u }; removed < 20u; removed++)
+			sparse[{ random() % 9u, random() % 9u }] = 0;
+		CHECK(enumerate(sparse, limit) == malcolm::SolutionCounter_t().count(malcolm::SolutionCounter_t::toCells(sparse), limit));
+	}
+}
+
+MALCOLM_TEST(enumeratorYieldsNothingForConflictingGivens)
+{
+	Board_t puzzle(9u, 9u);
+	puzzle[{ 0u, 0u }] = 3;
+	puzzle[{ 1u, 1u }] = 3;
+	CHECK(enumerate(puzzle, 10u) == 0u);
+	CHECK(malcolm::SolutionCounter_t().count(malcolm::SolutionCounter_t::toCells(puzzle), 10u) == 0u);
+}
@@ -0,0 +1,77 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Testing.h"
+#include "SolvingPipeline.h"
+
+namespace
+{
+	using value_t = int;
+
+	/// @returns lines written by pipeline for given input
+	std::vector<std::string> runPipeline(const std::string& input, const malcolm::pipeline_config_t& config)
+	{
+		std::istringstream in{ input };
+		std::ostringstream out;
+		malcolm::SolvingPipeline_t<value_t> pipeline(config);
+		pipeline.run(in, out);
+		std::vector<std::string> lines;
+		std::istringstream results{ out.str() };
+		for (std::string line; std::getline(results, line);)
+			lines.push_back(line);
+		return lines;
+	}
+}
+
+MALCOLM_TEST(pipelineKeepsLinesOfRejectedInput)
+{
+	std::ifstream file{ malcolm::testing::dataDirectory() + "/e300.txt" };
+	std::vector<std::string> puzzles(3u);
+	for (auto& puzzle : puzzles)
+		std::getline(file, puzzle);
+	const std::string input{ puzzles[0] + "\n" + "garbage\n" + puzzles[1] + "\n\n" + puzzles[2] + "|not cages\n" + puzzles[2] + "\n" };
+
+	malcolm::pipeline_config_t config;
+	config.solve_threads = 3u;
+	config.queue_capacity = 2u;
+	const auto lines{ runPipeline(input, config) };
+	CHECK(lines.size() == 5u);
+	const std::string rejected{ std::string(81u, '.') + ' ' + malcolm::rejected_status };
+	CHECK(lines[1] == rejected);
+	CHECK(lines[3] == rejected);
+	for (auto index : { 0u, 2u, 4u })
+		CHECK(lines[index].size() == 83u && lines[index].back() == '1' && lines[index].find('.') == std::string::npos);
+}
+
+MALCOLM_TEST(pipelineBoundsResultsWaitingForSlowPuzzle)
+{
+	// the slowest puzzle of hard.txt goes first, many quick ones overtake it
+	std::ifstream hard{ malcolm::testing::dataDirectory() + "/hard.txt" };
+	std::string slow;
+	for (std::size_t i{ 0u }; i < 204u; i++)
+		std::getline(hard, slow);
+	std::string input{ slow + "\n" };
+	std::ifstream easy{ malcolm::testing::dataDirectory() + "/e300.txt" };
+	for (std::string line; std::getline(easy, line);)
+		input += line + "\n";
+
+	malcolm::pipeline_config_t config;
+	config.solve_threads = 4u;
+	config.queue_capacity = 4u;
+	std::istringstream in{ input };
+	std::ostringstream out;
+	malcolm::SolvingPipeline_t<value_t> pipeline(config);
+	pipeline.run(in, out);
+	CHECK(pipeline.getReorderPeak() <= 3u * config.queue_capacity + config.solve_threads + config.validate_threads + 1u);
+
+	// order of results is the same as with single solving thread, where nothing can overtake
+	malcolm::pipeline_config_t single;
+	single.solve_threads = 1u;
+	std::string expected;
+	for (const auto& line : runPipeline(input, single))
+		expected += line + "\n";
+	CHECK(out.str().size() == 301u * malcolm::text_result_size);
+	CHECK(out.str() == expected);
+}
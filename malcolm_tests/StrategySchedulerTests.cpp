@@ -0,0 +1,56 @@
+#include <cstddef>
+#include <vector>
+
+#include "Testing.h"
+#include "StrategyScheduler.h"
+
+namespace
+{
+	/// @brief Asks strategies as `BoardSolver_t` does: in returned order until the first productive one
+	/// @param productive yield of every strategy
+	/// @param costs cost of every strategy
+	/// @returns index of the productive strategy
+	std::size_t runRound(malcolm::StrategyScheduler_t& scheduler, const std::vector<std::size_t>& productive, const std::vector<std::uint64_t>& costs)
+	{
+		for (auto index : scheduler.order(malcolm::strategy_phase_t::ELIMINATING))
+		{
+			scheduler.record(malcolm::strategy_phase_t::ELIMINATING, index, costs[index], productive[index]);
+			if (productive[index] > 0u)
+				return index;
+		}
+		return productive.size();
+	}
+}
+
+MALCOLM_TEST(schedulerDemotesExpensiveStrategy)
+{
+	malcolm::StrategyScheduler_t scheduler{ { .exploration_interval = 0u } };
+	scheduler.registerStrategies(malcolm::strategy_phase_t::ELIMINATING, { "cheap", "expensive" });
+	// the first rounds measure both strategies, then the cheap one keeps winning and the expensive one is never asked again
+	for (std::size_t round{ 0u }; round < 200u; round++)
+		runRound(scheduler, { 1u, 1u }, { 100u, 100000u });
+	CHECK(scheduler.order(malcolm::strategy_phase_t::ELIMINATING) == std::vector<std::size_t>{ 0u, 1u });
+
+	malcolm::StrategyScheduler_t fixed{ { .policy = malcolm::scheduling_policy_t::FIXED } };
+	fixed.registerStrategies(malcolm::strategy_phase_t::ELIMINATING, { "expensive", "cheap" });
+	for (std::size_t round{ 0u }; round < 200u; round++)
+		CHECK(runRound(fixed, { 1u, 1u }, { 100000u, 100u }) == 0u);
+}
+
+MALCOLM_TEST(schedulerExploresDemotedStrategy)
+{
+	for (std::size_t interval : { 0u, 16u })
+	{
+		malcolm::StrategyScheduler_t scheduler{ { .exploration_interval = interval } };
+		scheduler.registerStrategies(malcolm::strategy_phase_t::ELIMINATING, { "cheap", "slow_at_first" });
+		// the second strategy is demoted while it's slow and unproductive
+		for (std::size_t round{ 0u }; round < 100u; round++)
+			runRound(scheduler, { 1u, 0u }, { 1000u, 1000000u });
+		CHECK(scheduler.order(malcolm::strategy_phase_t::ELIMINATING).front() == 0u);
+
+		// later it becomes cheap and productive, only periodic exploration measures it again and promotes it
+		for (std::size_t round{ 0u }; round < 2000u; round++)
+			runRound(scheduler, { 1u, 5u }, { 1000u, 100u });
+		CHECK(scheduler.order(malcolm::strategy_phase_t::ELIMINATING).front() == (interval == 0u ? 0u : 1u));
+	}
+}
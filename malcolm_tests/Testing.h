@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "SolvingPipeline.h"
+
+namespace malcolm::testing
+{
+	/// @brief Single test registered with `MALCOLM_TEST`
+	struct test_case_t
+	{
+		/// name used in report and for filtering
+		const char* name;
+		/// body of the test, reports failure by throwing
+		void (*body)();
+	};
+
+	/// @brief Failed check, thrown out of test body
+	class failure_t : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	/// @returns all registered tests, in order of registration within every translation unit
+	inline std::vector<test_case_t>& registry()
+	{
+		static std::vector<test_case_t> s_tests;
+		return s_tests;
+	}
+
+	/// @brief Adds test to `registry()` during static initialization
+	struct registrar_t
+	{
+		registrar_t(const char* name, void (*body)()) { registry().push_back({ name, body }); }
+	};
+
+	/// @brief Throws `failure_t` describing the check if condition doesn't hold
+	inline void check(bool condition, const char* expression, const char* file, int line)
+	{
+		if (!condition)
+			throw failure_t(std::string(file) + ":" + std::to_string(line) + ": check failed: " + expression);
+	}
+
+	/// @returns directory with puzzle corpora (guess.txt, e300.txt, hard.txt, killer.txt), set from command line by main
+	inline std::string& dataDirectory()
+	{
+		static std::string s_directory{ "data" };
+		return s_directory;
+	}
+
+	/// @brief Reads corpus in the line format of `SolvingPipeline_t`
+	/// @param name file name within `dataDirectory()`
+	/// @throws failure_t if file can't be opened or contains malformed line
+	inline std::vector<Board_t<int>> loadCorpus(const std::string& name)
+	{
+		std::ifstream file{ dataDirectory() + "/" + name };
+		if (!file)
+			throw failure_t("can't open corpus " + dataDirectory() + "/" + name);
+		std::vector<Board_t<int>> puzzles;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			Board_t<int> puzzle(9u, 9u);
+			if (!SolvingPipeline_t<int>::parseLine(line, puzzle))
+				throw failure_t("malformed line in corpus " + name + ": " + line);
+			puzzles.push_back(std::move(puzzle));
+		}
+		return puzzles;
+	}
+
+	/// @returns true if both boards have the same size and values
+	template<typename T>
+	bool sameBoards(const Board_t<T>& first, const Board_t<T>& second)
+	{
+		if (first.getSize() != second.getSize())
+			return false;
+		for (std::size_t x{ 0u }; x < first.getSize().first; x++)
+			for (std::size_t y{ 0u }; y < first.getSize().second; y++)
+				if (first[{ x, y }] != second[{ x, y }])
+					return false;
+		return true;
+	}
+}
+
+/// Defines and registers test with given name
+#define MALCOLM_TEST(name) \
+	static void name(); \
+	static const malcolm::testing::registrar_t name##_registrar{ #name, name }; \
+	static void name()
+
+/// Fails current test if expression is false (variadic, so braced initializers with commas can be used inside)
+#define CHECK(...) malcolm::testing::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+/// Fails current test unless expression throws exception of given type
+#define CHECK_THROWS(expression, exception_t) \
+	do \
+	{ \
+		bool thrown{ false }; \
+		try { (void)(expression); } \
+		catch (const exception_t&) { thrown = true; } \
+		malcolm::testing::check(thrown, #expression " throws " #exception_t, __FILE__, __LINE__); \
+	} while (false)
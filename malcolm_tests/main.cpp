@@ -0,0 +1,75 @@
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Testing.h"
+#include "ShardCoordinator.h"
+#include "TracingService.h"
+
+/// Runs tests registered with `MALCOLM_TEST`
+/// @li malcolm_tests [--data DIR] [FILTER...] - runs tests whose name contains any FILTER (all if none is given),
+/// corpora are read from DIR (default `data`, i.e. run it from malcolm_tests directory)
+/// @li Besides malcolm_tests.vcxproj, it builds with any C++20 compiler from this directory:
+/// `g++ -std=c++20 -O2 -I../malcolm -I../malcolm/utils -pthread *.cpp -o malcolm_tests`
+/// @li malcolm_tests --shard-worker FD INPUT - worker process started by shard tests, as `malcolm --shard-worker`
+/// @returns 0 if all selected tests passed, 1 otherwise
+int main(int argc, char** argv)
+{
+#ifndef _WIN32
+	if (argc > 3 && std::string{ argv[1] } == "--shard-worker")
+	{
+		malcolm::pipeline_config_t config;
+		config.solve_threads = 1u;
+		config.validate_threads = 1u;
+		TracingService_t::setEnabled(false);
+		return malcolm::ShardCoordinator_t<int>::serve(std::stoi(argv[2]), argv[3], config);
+	}
+#endif
+
+	std::vector<std::string> filters;
+	for (auto i{ 1 }; i < argc; i++)
+	{
+		std::string argument{ argv[i] };
+		if (argument == "--data" && i + 1 < argc)
+			malcolm::testing::dataDirectory() = argv[++i];
+		else
+			filters.push_back(argument);
+	}
+
+	TracingService_t::setEnabled(false);
+
+	std::size_t passed{ 0u }, failed{ 0u };
+	for (const auto& test : malcolm::testing::registry())
+	{
+		bool selected{ filters.empty() };
+		for (const auto& filter : filters)
+			selected |= std::string(test.name).find(filter) != std::string::npos;
+		if (!selected)
+			continue;
+
+		auto start{ std::chrono::steady_clock::now() };
+		std::string error;
+		try
+		{
+			test.body();
+		}
+		catch (const std::exception& exception)
+		{
+			error = exception.what();
+		}
+		catch (...)
+		{
+			error = "unknown exception";
+		}
+		const double milliseconds{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+		std::cout << (error.empty() ? "[ OK ] " : "[FAIL] ") << test.name << " (" << std::fixed << std::setprecision(1) << milliseconds << " ms)\n";
+		if (!error.empty())
+			std::cout << "       " << error << "\n";
+		(error.empty() ? passed : failed)++;
+	}
+	std::cout << passed << " passed, " << failed << " failed\n";
+	return failed == 0u ? 0 : 1;
+}